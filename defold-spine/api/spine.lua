@@ -76,6 +76,17 @@ function spine.cancel(url, options) end
 ---@return hash id Id of the game object
 function spine.get_go(url, bone_id) end
 
+---@class spine.get_memory_stats.stats
+---@field data_size number Bytes used by the loaded skeleton data (the resource size of the spine scene)
+---@field instance_size number Bytes used by the skeletons, animation states and skins of the models and gui nodes
+---@field instance_allocations number Number of instance allocations
+
+---Returns the memory used by the spine scene of a Spine model. The instance memory is shared by all the
+---Spine models and gui nodes using the same spine scene.
+---@param url string|hash|url The Spine model to query
+---@return spine.get_memory_stats.stats stats The memory of the spine scene
+function spine.get_memory_stats(url) end
+
 ---Sets the spine skin on a spine model.
 ---@param url string|hash|url The Spine model to query
 ---@param skin string|hash Id of the corresponding skin
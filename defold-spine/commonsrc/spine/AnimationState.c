@@ -51,7 +51,7 @@ void spAnimationState_disposeStatics(void) {
 
 /* Forward declaration of some "private" functions so we can keep
  the same function order in C as we have method order in Java. */
-void _spAnimationState_disposeTrackEntry(spTrackEntry *entry);
+void _spAnimationState_disposeTrackEntry(spAnimationState *state, spTrackEntry *entry);
 
 void _spAnimationState_disposeTrackEntries(spAnimationState *state, spTrackEntry *entry);
 
@@ -91,7 +91,7 @@ _spEventQueue *_spEventQueue_create(_spAnimationState *state) {
 	_spEventQueue *self = CALLOC(_spEventQueue, 1);
 	self->state = state;
 	self->objectsCount = 0;
-	self->objectsCapacity = 16;
+	self->objectsCapacity = 64; /* Defold: was 16, which a few tracks switching animations in one frame outgrow */
 	self->objects = CALLOC(_spEventQueueItem, self->objectsCapacity);
 	self->drainDisabled = 0;
 	return self;
@@ -104,12 +104,8 @@ void _spEventQueue_free(_spEventQueue *self) {
 
 void _spEventQueue_ensureCapacity(_spEventQueue *self, int newElements) {
 	if (self->objectsCount + newElements > self->objectsCapacity) {
-		_spEventQueueItem *newObjects;
 		self->objectsCapacity <<= 1;
-		newObjects = CALLOC(_spEventQueueItem, self->objectsCapacity);
-		memcpy(newObjects, self->objects, sizeof(_spEventQueueItem) * self->objectsCount);
-		FREE(self->objects);
-		self->objects = newObjects;
+		self->objects = REALLOC(self->objects, _spEventQueueItem, self->objectsCapacity); /* Defold */
 	}
 }
 
@@ -188,7 +184,7 @@ void _spEventQueue_drain(_spEventQueue *self) {
 				if (entry->listener) entry->listener(SUPER(self->state), SP_ANIMATION_DISPOSE, entry, 0);
 				if (self->state->super.listener)
 					self->state->super.listener(SUPER(self->state), SP_ANIMATION_DISPOSE, entry, 0);
-				_spAnimationState_disposeTrackEntry(entry);
+				_spAnimationState_disposeTrackEntry(SUPER(self->state), entry);
 				break;
 			case SP_ANIMATION_EVENT:
 				event = self->objects[i + 2].event;
@@ -214,13 +210,21 @@ void _spAnimationState_disableQueue(spAnimationState *self) {
 	internal->queue->drainDisabled = 1;
 }
 
-void _spAnimationState_disposeTrackEntry(spTrackEntry *entry) {
+static void _spAnimationState_freeTrackEntry(spTrackEntry *entry) {
 	spIntArray_dispose(entry->timelineMode);
 	spTrackEntryArray_dispose(entry->timelineHoldMix);
 	FREE(entry->timelinesRotation);
 	FREE(entry);
 }
 
+/* Defold: The entry is kept, with its arrays, in the pool of the state, and reused by _spAnimationState_trackEntry.
+ * The pool is freed with the state. */
+void _spAnimationState_disposeTrackEntry(spAnimationState *state, spTrackEntry *entry) {
+	_spAnimationState *internal = SUB_CAST(_spAnimationState, state);
+	entry->next = internal->trackEntryPool;
+	internal->trackEntryPool = entry;
+}
+
 void _spAnimationState_disposeTrackEntries(spAnimationState *state, spTrackEntry *entry) {
 	while (entry) {
 		spTrackEntry *next = entry->next;
@@ -229,12 +233,12 @@ void _spAnimationState_disposeTrackEntries(spAnimationState *state, spTrackEntry
 			spTrackEntry *nextFrom = from->mixingFrom;
 			if (entry->listener) entry->listener(state, SP_ANIMATION_DISPOSE, from, 0);
 			if (state->listener) state->listener(state, SP_ANIMATION_DISPOSE, from, 0);
-			_spAnimationState_disposeTrackEntry(from);
+			_spAnimationState_disposeTrackEntry(state, from);
 			from = nextFrom;
 		}
 		if (entry->listener) entry->listener(state, SP_ANIMATION_DISPOSE, entry, 0);
 		if (state->listener) state->listener(state, SP_ANIMATION_DISPOSE, entry, 0);
-		_spAnimationState_disposeTrackEntry(entry);
+		_spAnimationState_disposeTrackEntry(state, entry);
 		entry = next;
 	}
 }
@@ -268,6 +272,11 @@ void spAnimationState_dispose(spAnimationState *self) {
 	_spAnimationState *internal = SUB_CAST(_spAnimationState, self);
 	for (i = 0; i < self->tracksCount; i++)
 		_spAnimationState_disposeTrackEntries(self, self->tracks[i]);
+	while (internal->trackEntryPool) {
+		spTrackEntry *next = internal->trackEntryPool->next;
+		_spAnimationState_freeTrackEntry(internal->trackEntryPool);
+		internal->trackEntryPool = next;
+	}
 	FREE(self->tracks);
 	_spEventQueue_free(internal->queue);
 	FREE(internal->events);
@@ -467,6 +476,126 @@ int spAnimationState_apply(spAnimationState *self, spSkeleton *skeleton) {
 	return applied;
 }
 
+int spAnimationState_applyEvents(spAnimationState *self) {
+	_spAnimationState *internal = SUB_CAST(_spAnimationState, self);
+	spTrackEntry *current;
+	int i, ii, n;
+	float animationTime;
+	int timelineCount;
+	spTimeline **timelines;
+
+	for (i = 0, n = self->tracksCount; i < n; i++) {
+		current = self->tracks[i];
+		if (current && current->mixingFrom) return 0;
+	}
+
+	if (internal->animationsChanged) _spAnimationState_animationsChanged(self);
+
+	for (i = 0, n = self->tracksCount; i < n; i++) {
+		current = self->tracks[i];
+		if (!current || current->delay > 0) continue;
+
+		animationTime = spTrackEntry_getAnimationTime(current);
+		if (!current->reverse) {
+			timelineCount = current->animation->timelines->size;
+			timelines = current->animation->timelines->items;
+			for (ii = 0; ii < timelineCount; ii++) {
+				if (timelines[ii]->type != SP_TIMELINE_EVENT) continue;
+				spTimeline_apply(timelines[ii], NULL, current->animationLast, animationTime, internal->events,
+								 &internal->eventsCount, 1, SP_MIX_BLEND_REPLACE, SP_MIX_DIRECTION_IN);
+			}
+		}
+		_spAnimationState_queueEvents(self, current, animationTime);
+		internal->eventsCount = 0;
+		current->nextAnimationLast = animationTime;
+		current->nextTrackLast = current->trackTime;
+	}
+
+	_spEventQueue_drain(internal->queue);
+	return 1;
+}
+
+static int /*boolean*/ _spAnimationState_isBoneTransformTimeline(spTimelineType type) {
+	switch (type) {
+		case SP_TIMELINE_ROTATE:
+		case SP_TIMELINE_TRANSLATE:
+		case SP_TIMELINE_TRANSLATEX:
+		case SP_TIMELINE_TRANSLATEY:
+		case SP_TIMELINE_SCALE:
+		case SP_TIMELINE_SCALEX:
+		case SP_TIMELINE_SCALEY:
+		case SP_TIMELINE_SHEAR:
+		case SP_TIMELINE_SHEARX:
+		case SP_TIMELINE_SHEARY:
+			return 1;
+		default:
+			return 0;
+	}
+}
+
+int spAnimationState_applyWithoutBoneTransforms(spAnimationState *self, spSkeleton *skeleton) {
+	_spAnimationState *internal = SUB_CAST(_spAnimationState, self);
+	spTrackEntry *current;
+	int i, ii, n;
+	float animationTime, applyTime;
+	int timelineCount;
+	spTimeline **timelines;
+	spTimeline *timeline;
+	spEvent **applyEvents;
+	int /*boolean*/ attachments;
+	spSlot **slots;
+	spSlot *slot;
+	int setupState;
+	const char *attachmentName;
+
+	current = self->tracksCount > 0 ? self->tracks[0] : NULL;
+	if (!current || current->delay > 0 || current->mixingFrom || current->alpha != 1) return 0;
+	if (current->trackTime >= current->trackEnd && current->next == 0) return 0;
+	for (i = 1, n = self->tracksCount; i < n; i++)
+		if (self->tracks[i]) return 0;
+
+	if (internal->animationsChanged) _spAnimationState_animationsChanged(self);
+
+	/* Same as the single track, full alpha path in spAnimationState_apply. */
+	attachments = current->alpha >= current->alphaAttachmentThreshold;
+	animationTime = spTrackEntry_getAnimationTime(current);
+	applyEvents = internal->events;
+	applyTime = animationTime;
+	if (current->reverse) {
+		applyTime = current->animation->duration - applyTime;
+		applyEvents = NULL;
+	}
+	timelineCount = current->animation->timelines->size;
+	timelines = current->animation->timelines->items;
+	for (ii = 0; ii < timelineCount; ii++) {
+		timeline = timelines[ii];
+		if (_spAnimationState_isBoneTransformTimeline(timeline->type)) continue;
+		if (timeline->type == SP_TIMELINE_ATTACHMENT)
+			_spAnimationState_applyAttachmentTimeline(self, timeline, skeleton, applyTime, SP_MIX_BLEND_FIRST, attachments);
+		else
+			spTimeline_apply(timeline, skeleton, current->animationLast, applyTime, applyEvents, &internal->eventsCount, 1,
+							 SP_MIX_BLEND_FIRST, SP_MIX_DIRECTION_IN);
+	}
+	_spAnimationState_queueEvents(self, current, animationTime);
+	internal->eventsCount = 0;
+	current->nextAnimationLast = animationTime;
+	current->nextTrackLast = current->trackTime;
+
+	setupState = self->unkeyedState + SETUP;
+	slots = skeleton->slots;
+	for (i = 0, n = skeleton->slotsCount; i < n; i++) {
+		slot = slots[i];
+		if (slot->attachmentState == setupState) {
+			attachmentName = slot->data->attachmentName;
+			spSlot_setAttachment(slot, attachmentName == NULL ? NULL : spSkeleton_getAttachmentForSlotIndex(skeleton, slot->data->index, attachmentName));
+		}
+	}
+	self->unkeyedState += 2;
+
+	_spEventQueue_drain(internal->queue);
+	return 1;
+}
+
 float _spAnimationState_applyMixingFrom(spAnimationState *self, spTrackEntry *to, spSkeleton *skeleton, spMixBlend blend) {
 	_spAnimationState *internal = SUB_CAST(_spAnimationState, self);
 	float mix;
@@ -906,7 +1035,27 @@ spTrackEntry *_spAnimationState_expandToIndex(spAnimationState *self, int index)
 spTrackEntry *
 _spAnimationState_trackEntry(spAnimationState *self, int trackIndex, spAnimation *animation, int /*boolean*/ loop,
 							 spTrackEntry *last) {
-	spTrackEntry *entry = NEW(spTrackEntry);
+	_spAnimationState *internal = SUB_CAST(_spAnimationState, self);
+	spTrackEntry *entry = internal->trackEntryPool;
+	if (entry) {
+		/* Defold: Reuse a disposed entry. It's cleared like NEW would, but keeps its arrays */
+		spIntArray *timelineMode = entry->timelineMode;
+		spTrackEntryArray *timelineHoldMix = entry->timelineHoldMix;
+		float *timelinesRotation = entry->timelinesRotation;
+		int timelinesRotationCapacity = entry->timelinesRotationCapacity;
+		internal->trackEntryPool = entry->next;
+		memset(entry, 0, sizeof(spTrackEntry));
+		spIntArray_clear(timelineMode);
+		spTrackEntryArray_clear(timelineHoldMix);
+		entry->timelineMode = timelineMode;
+		entry->timelineHoldMix = timelineHoldMix;
+		entry->timelinesRotation = timelinesRotation;
+		entry->timelinesRotationCapacity = timelinesRotationCapacity;
+	} else {
+		entry = NEW(spTrackEntry);
+		entry->timelineMode = spIntArray_create(16);
+		entry->timelineHoldMix = spTrackEntryArray_create(16);
+	}
 	entry->trackIndex = trackIndex;
 	entry->animation = animation;
 	entry->loop = loop;
@@ -940,9 +1089,6 @@ _spAnimationState_trackEntry(spAnimationState *self, int trackIndex, spAnimation
 	entry->totalAlpha = 0;
 	entry->mixBlend = SP_MIX_BLEND_REPLACE;
 
-	entry->timelineMode = spIntArray_create(16);
-	entry->timelineHoldMix = spTrackEntryArray_create(16);
-
 	return entry;
 }
 
@@ -980,9 +1126,15 @@ void _spAnimationState_animationsChanged(spAnimationState *self) {
 
 float *_spAnimationState_resizeTimelinesRotation(spTrackEntry *entry, int newSize) {
 	if (entry->timelinesRotationCount != newSize) {
-		float *newTimelinesRotation = CALLOC(float, newSize);
-		FREE(entry->timelinesRotation);
-		entry->timelinesRotation = newTimelinesRotation;
+		/* Defold: Only reallocated when it grows */
+		if (entry->timelinesRotationCapacity < newSize) {
+			float *newTimelinesRotation = CALLOC(float, newSize);
+			FREE(entry->timelinesRotation);
+			entry->timelinesRotation = newTimelinesRotation;
+			entry->timelinesRotationCapacity = newSize;
+		} else {
+			memset(entry->timelinesRotation, 0, sizeof(float) * newSize);
+		}
 		entry->timelinesRotationCount = newSize;
 	}
 	return entry->timelinesRotation;
@@ -1048,6 +1200,7 @@ void spTrackEntry_resetRotationDirections(spTrackEntry *entry) {
 	FREE(entry->timelinesRotation);
 	entry->timelinesRotation = NULL;
 	entry->timelinesRotationCount = 0;
+	entry->timelinesRotationCapacity = 0;
 }
 
 float spTrackEntry_getTrackComplete(spTrackEntry *entry) {
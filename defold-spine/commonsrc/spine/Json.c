@@ -46,7 +46,12 @@ THE SOFTWARE.
 #define SPINE_JSON_DEBUG 0
 #endif
 
-static const char *ep;
+/* Defold: The documents are parsed on the resource load thread as well as on the main thread */
+#if defined(_MSC_VER)
+static __declspec(thread) const char *ep;
+#else
+static __thread const char *ep;
+#endif
 
 const char *Json_getError(void) {
 	return ep;
@@ -89,28 +94,32 @@ void Json_dispose(Json *c) {
 	}
 }
 
+/* Defold: The parser takes the end of the input, and never reads at or past it. The input doesn't have to be
+   null terminated, so it can be parsed straight out of a loaded file buffer. PEEK() reads a 0 at the end. */
+#define PEEK(p) ((p) < end ? *(p) : 0)
+
 /* Parse the input text to generate a number, and populate the result into item. */
-static const char *parse_number(Json *item, const char *num) {
+static const char *parse_number(Json *item, const char *num, const char *end) {
 	double result = 0.0;
 	int negative = 0;
 	char *ptr = (char *) num;
 
-	if (*ptr == '-') {
+	if (PEEK(ptr) == '-') {
 		negative = -1;
 		++ptr;
 	}
 
-	while (*ptr >= '0' && *ptr <= '9') {
+	while (PEEK(ptr) >= '0' && PEEK(ptr) <= '9') {
 		result = result * 10.0 + (*ptr - '0');
 		++ptr;
 	}
 
-	if (*ptr == '.') {
+	if (PEEK(ptr) == '.') {
 		double fraction = 0.0;
 		int n = 0;
 		++ptr;
 
-		while (*ptr >= '0' && *ptr <= '9') {
+		while (PEEK(ptr) >= '0' && PEEK(ptr) <= '9') {
 			fraction = (fraction * 10.0) + (*ptr - '0');
 			++ptr;
 			++n;
@@ -119,19 +128,19 @@ static const char *parse_number(Json *item, const char *num) {
 	}
 	if (negative) result = -result;
 
-	if (*ptr == 'e' || *ptr == 'E') {
+	if (PEEK(ptr) == 'e' || PEEK(ptr) == 'E') {
 		double exponent = 0;
 		int expNegative = 0;
 		++ptr;
 
-		if (*ptr == '-') {
+		if (PEEK(ptr) == '-') {
 			expNegative = -1;
 			++ptr;
-		} else if (*ptr == '+') {
+		} else if (PEEK(ptr) == '+') {
 			++ptr;
 		}
 
-		while (*ptr >= '0' && *ptr <= '9') {
+		while (PEEK(ptr) >= '0' && PEEK(ptr) <= '9') {
 			exponent = (exponent * 10.0) + (*ptr - '0');
 			++ptr;
 		}
@@ -155,21 +164,40 @@ static const char *parse_number(Json *item, const char *num) {
 	}
 }
 
+/* Defold: Reads the 4 hex digits of an \u escape (sscanf would need a terminated string) */
+static unsigned parse_hex4(const char *str, const char *end) {
+	unsigned h = 0;
+	int i;
+	for (i = 0; i < 4; ++i) {
+		char c = PEEK(str + i);
+		h <<= 4;
+		if (c >= '0' && c <= '9')
+			h += c - '0';
+		else if (c >= 'A' && c <= 'F')
+			h += 10 + c - 'A';
+		else if (c >= 'a' && c <= 'f')
+			h += 10 + c - 'a';
+		else
+			return 0;
+	}
+	return h;
+}
+
 /* Parse the input text into an unescaped cstring, and populate item. */
 static const unsigned char firstByteMark[7] = {0x00, 0x00, 0xC0, 0xE0, 0xF0, 0xF8, 0xFC};
 
-static const char *parse_string(Json *item, const char *str) {
+static const char *parse_string(Json *item, const char *str, const char *end) {
 	const char *ptr = str + 1;
 	char *ptr2;
 	char *out;
 	int len = 0;
 	unsigned uc, uc2;
-	if (*str != '\"') { /* TODO: don't need this check when called from parse_value, but do need from parse_object */
+	if (PEEK(str) != '\"') { /* TODO: don't need this check when called from parse_value, but do need from parse_object */
 		ep = str;
 		return 0;
 	} /* not a string! */
 
-	while (*ptr != '\"' && *ptr && ++len)
+	while (PEEK(ptr) != '\"' && PEEK(ptr) && ++len)
 		if (*ptr++ == '\\') ptr++; /* Skip escaped quotes. */
 
 	out = MALLOC(char, len + 1); /* The length needed for the string, roughly. */
@@ -177,12 +205,15 @@ static const char *parse_string(Json *item, const char *str) {
 
 	ptr = str + 1;
 	ptr2 = out;
-	while (*ptr != '\"' && *ptr) {
+	while (PEEK(ptr) != '\"' && PEEK(ptr)) {
 		if (*ptr != '\\')
 			*ptr2++ = *ptr++;
 		else {
 			ptr++;
-			switch (*ptr) {
+			switch (PEEK(ptr)) {
+				case 0: /* Defold: a trailing backslash at the end of the input */
+					ptr--;
+					break;
 				case 'b':
 					*ptr2++ = '\b';
 					break;
@@ -199,7 +230,11 @@ static const char *parse_string(Json *item, const char *str) {
 					*ptr2++ = '\t';
 					break;
 				case 'u': /* transcode utf16 to utf8. */
-					sscanf(ptr + 1, "%4x", &uc);
+					if (end - ptr < 5) { /* Defold: truncated escape */
+						ptr = end - 1;
+						break;
+					}
+					uc = parse_hex4(ptr + 1, end);
 					ptr += 4; /* get the unicode char. */
 
 					if ((uc >= 0xDC00 && uc <= 0xDFFF) || uc == 0) break; /* check for invalid.	*/
@@ -207,8 +242,8 @@ static const char *parse_string(Json *item, const char *str) {
 					/* TODO provide an option to ignore surrogates, use unicode replacement character? */
 					if (uc >= 0xD800 && uc <= 0xDBFF) /* UTF16 surrogate pairs.	*/
 					{
-						if (ptr[1] != '\\' || ptr[2] != 'u') break; /* missing second-half of surrogate.	*/
-						sscanf(ptr + 3, "%4x", &uc2);
+						if (PEEK(ptr + 1) != '\\' || PEEK(ptr + 2) != 'u' || end - ptr < 7) break; /* missing second-half of surrogate.	*/
+						uc2 = parse_hex4(ptr + 3, end);
 						ptr += 6;
 						if (uc2 < 0xDC00 || uc2 > 0xDFFF) break; /* invalid second-half of surrogate.	*/
 						uc = 0x10000 + (((uc & 0x3FF) << 10) | (uc2 & 0x3FF));
@@ -249,36 +284,47 @@ static const char *parse_string(Json *item, const char *str) {
 		}
 	}
 	*ptr2 = 0;
-	if (*ptr == '\"') ptr++; /* TODO error handling if not \" or \0 ? */
+	if (PEEK(ptr) == '\"') ptr++; /* TODO error handling if not \" or \0 ? */
 	item->valueString = out;
 	item->type = Json_String;
 	return ptr;
 }
 
 /* Predeclare these prototypes. */
-static const char *parse_value(Json *item, const char *value);
+static const char *parse_value(Json *item, const char *value, const char *end);
 
-static const char *parse_array(Json *item, const char *value);
+static const char *parse_array(Json *item, const char *value, const char *end);
 
-static const char *parse_object(Json *item, const char *value);
+static const char *parse_object(Json *item, const char *value, const char *end);
 
 /* Utility to jump whitespace and cr/lf */
-static const char *skip(const char *in) {
+static const char *skip(const char *in, const char *end) {
 	if (!in) return 0; /* must propagate NULL since it's often called in skip(f(...)) form */
-	while (*in && (unsigned char) *in <= 32)
+	while (PEEK(in) && (unsigned char) *in <= 32)
 		in++;
 	return in;
 }
 
 /* Parse an object - create a new root, and populate. */
 Json *Json_create(const char *value) {
+	if (!value) {
+		ep = 0;
+		return 0;
+	}
+	return Json_createWithLength(value, (int) strlen(value));
+}
+
+/* Defold */
+Json *Json_createWithLength(const char *value, int length) {
 	Json *c;
+	const char *end;
 	ep = 0;
 	if (!value) return 0; /* only place we check for NULL other than skip() */
+	end = value + length;
 	c = Json_new();
 	if (!c) return 0; /* memory fail */
 
-	value = parse_value(c, skip(value));
+	value = parse_value(c, skip(value, end), end);
 	if (!value) {
 		Json_dispose(c);
 		return 0;
@@ -288,23 +334,23 @@ Json *Json_create(const char *value) {
 }
 
 /* Parser core - when encountering text, process appropriately. */
-static const char *parse_value(Json *item, const char *value) {
+static const char *parse_value(Json *item, const char *value, const char *end) {
 	/* Referenced by Json_create(), parse_array(), and parse_object(). */
 	/* Always called with the result of skip(). */
 #if SPINE_JSON_DEBUG      /* Checked at entry to graph, Json_create, and after every parse_ call. */
 	if (!value) return 0; /* Fail on null. */
 #endif
 
-	switch (*value) {
+	switch (PEEK(value)) {
 		case 'n': {
-			if (!strncmp(value + 1, "ull", 3)) {
+			if (end - value >= 4 && !strncmp(value + 1, "ull", 3)) {
 				item->type = Json_NULL;
 				return value + 4;
 			}
 			break;
 		}
 		case 'f': {
-			if (!strncmp(value + 1, "alse", 4)) {
+			if (end - value >= 5 && !strncmp(value + 1, "alse", 4)) {
 				item->type = Json_False;
 				/* calloc prevents us needing item->type = Json_False or valueInt = 0 here */
 				return value + 5;
@@ -312,7 +358,7 @@ static const char *parse_value(Json *item, const char *value) {
 			break;
 		}
 		case 't': {
-			if (!strncmp(value + 1, "rue", 3)) {
+			if (end - value >= 4 && !strncmp(value + 1, "rue", 3)) {
 				item->type = Json_True;
 				item->valueInt = 1;
 				return value + 4;
@@ -320,11 +366,11 @@ static const char *parse_value(Json *item, const char *value) {
 			break;
 		}
 		case '\"':
-			return parse_string(item, value);
+			return parse_string(item, value, end);
 		case '[':
-			return parse_array(item, value);
+			return parse_array(item, value, end);
 		case '{':
-			return parse_object(item, value);
+			return parse_object(item, value, end);
 		case '-': /* fallthrough */
 		case '0': /* fallthrough */
 		case '1': /* fallthrough */
@@ -336,7 +382,7 @@ static const char *parse_value(Json *item, const char *value) {
 		case '7': /* fallthrough */
 		case '8': /* fallthrough */
 		case '9':
-			return parse_number(item, value);
+			return parse_number(item, value, end);
 		default:
 			break;
 	}
@@ -346,27 +392,27 @@ static const char *parse_value(Json *item, const char *value) {
 }
 
 /* Build an array from input text. */
-static const char *parse_array(Json *item, const char *value) {
+static const char *parse_array(Json *item, const char *value, const char *end) {
 	Json *child;
 
 #if SPINE_JSON_DEBUG /* unnecessary, only callsite (parse_value) verifies this */
-	if (*value != '[') {
+	if (PEEK(value) != '[') {
 		ep = value;
 		return 0;
 	} /* not an array! */
 #endif
 
 	item->type = Json_Array;
-	value = skip(value + 1);
-	if (*value == ']') return value + 1; /* empty array. */
+	value = skip(value + 1, end);
+	if (PEEK(value) == ']') return value + 1; /* empty array. */
 
 	item->child = child = Json_new();
-	if (!item->child) return 0;                    /* memory fail */
-	value = skip(parse_value(child, skip(value))); /* skip any spacing, get the value. */
+	if (!item->child) return 0;                                   /* memory fail */
+	value = skip(parse_value(child, skip(value, end), end), end); /* skip any spacing, get the value. */
 	if (!value) return 0;
 	item->size = 1;
 
-	while (*value == ',') {
+	while (PEEK(value) == ',') {
 		Json *new_item = Json_new();
 		if (!new_item) return 0; /* memory fail */
 		child->next = new_item;
@@ -374,46 +420,46 @@ static const char *parse_array(Json *item, const char *value) {
 		new_item->prev = child;
 #endif
 		child = new_item;
-		value = skip(parse_value(child, skip(value + 1)));
+		value = skip(parse_value(child, skip(value + 1, end), end), end);
 		if (!value) return 0; /* parse fail */
 		item->size++;
 	}
 
-	if (*value == ']') return value + 1; /* end of array */
+	if (PEEK(value) == ']') return value + 1; /* end of array */
 	ep = value;
 	return 0; /* malformed. */
 }
 
 /* Build an object from the text. */
-static const char *parse_object(Json *item, const char *value) {
+static const char *parse_object(Json *item, const char *value, const char *end) {
 	Json *child;
 
 #if SPINE_JSON_DEBUG /* unnecessary, only callsite (parse_value) verifies this */
-	if (*value != '{') {
+	if (PEEK(value) != '{') {
 		ep = value;
 		return 0;
 	} /* not an object! */
 #endif
 
 	item->type = Json_Object;
-	value = skip(value + 1);
-	if (*value == '}') return value + 1; /* empty array. */
+	value = skip(value + 1, end);
+	if (PEEK(value) == '}') return value + 1; /* empty array. */
 
 	item->child = child = Json_new();
 	if (!item->child) return 0;
-	value = skip(parse_string(child, skip(value)));
+	value = skip(parse_string(child, skip(value, end), end), end);
 	if (!value) return 0;
 	child->name = child->valueString;
 	child->valueString = 0;
-	if (*value != ':') {
+	if (PEEK(value) != ':') {
 		ep = value;
 		return 0;
-	}                                                  /* fail! */
-	value = skip(parse_value(child, skip(value + 1))); /* skip any spacing, get the value. */
+	}                                                                 /* fail! */
+	value = skip(parse_value(child, skip(value + 1, end), end), end); /* skip any spacing, get the value. */
 	if (!value) return 0;
 	item->size = 1;
 
-	while (*value == ',') {
+	while (PEEK(value) == ',') {
 		Json *new_item = Json_new();
 		if (!new_item) return 0; /* memory fail */
 		child->next = new_item;
@@ -421,24 +467,26 @@ static const char *parse_object(Json *item, const char *value) {
 		new_item->prev = child;
 #endif
 		child = new_item;
-		value = skip(parse_string(child, skip(value + 1)));
+		value = skip(parse_string(child, skip(value + 1, end), end), end);
 		if (!value) return 0;
 		child->name = child->valueString;
 		child->valueString = 0;
-		if (*value != ':') {
+		if (PEEK(value) != ':') {
 			ep = value;
 			return 0;
-		}                                                  /* fail! */
-		value = skip(parse_value(child, skip(value + 1))); /* skip any spacing, get the value. */
+		}                                                                 /* fail! */
+		value = skip(parse_value(child, skip(value + 1, end), end), end); /* skip any spacing, get the value. */
 		if (!value) return 0;
 		item->size++;
 	}
 
-	if (*value == '}') return value + 1; /* end of array */
+	if (PEEK(value) == '}') return value + 1; /* end of array */
 	ep = value;
 	return 0; /* malformed. */
 }
 
+#undef PEEK
+
 Json *Json_getItem(Json *object, const char *string) {
 	Json *c = object->child;
 	while (c && Json_strcasecmp(c->name, string))
@@ -64,6 +64,9 @@ typedef struct Json {
 /* Supply a block of JSON, and this returns a Json object you can interrogate. Call Json_dispose when finished. */
 Json *Json_create(const char *value);
 
+/* Defold: Same as Json_create(), but the value doesn't have to be null terminated. Nothing at or past value + length is read. */
+Json *Json_createWithLength(const char *value, int length);
+
 /* Delete a Json entity and all subentities. */
 void Json_dispose(Json *json);
 
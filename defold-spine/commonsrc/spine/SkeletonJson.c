@@ -1042,21 +1042,20 @@ static int string_starts_with(const char *str, const char *needle) {
 }
 
 spSkeletonData *spSkeletonJson_readSkeletonData(spSkeletonJson *self, const char *json) {
+	return spSkeletonJson_readSkeletonDataWithLength(self, json, json ? (int) strlen(json) : 0);
+}
+
+/* Defold: Reads the skeleton from a parsed document. The document is disposed only if it's the ownedRoot. */
+static spSkeletonData *_spSkeletonJson_readSkeletonDataJson(spSkeletonJson *self, Json *root, Json *ownedRoot) {
 	int i, ii;
 	spSkeletonData *skeletonData;
-	Json *root, *skeleton, *bones, *boneMap, *ik, *transform, *pathJson, *physics, *slots, *skins, *animations, *events;
+	Json *skeleton, *bones, *boneMap, *ik, *transform, *pathJson, *physics, *slots, *skins, *animations, *events;
 	_spSkeletonJson *internal = SUB_CAST(_spSkeletonJson, self);
 
 	FREE(self->error);
 	self->error = 0;
 	internal->linkedMeshCount = 0;
 
-	root = Json_create(json);
-	if (!root) {
-		_spSkeletonJson_setError(self, 0, "Invalid skeleton JSON: ", Json_getError());
-		return NULL;
-	}
-
 	skeletonData = spSkeletonData_create();
 
 	skeleton = Json_getItem(root, "skeleton");
@@ -1103,7 +1102,7 @@ spSkeletonData *spSkeletonJson_readSkeletonData(spSkeletonJson *self, const char
 			parent = spSkeletonData_findBone(skeletonData, parentName);
 			if (!parent) {
 				spSkeletonData_dispose(skeletonData);
-				_spSkeletonJson_setError(self, root, "Parent bone not found: ", parentName);
+				_spSkeletonJson_setError(self, ownedRoot, "Parent bone not found: ", parentName);
 				return NULL;
 			}
 		}
@@ -1160,7 +1159,7 @@ spSkeletonData *spSkeletonJson_readSkeletonData(spSkeletonJson *self, const char
 			spBoneData *boneData = spSkeletonData_findBone(skeletonData, boneName);
 			if (!boneData) {
 				spSkeletonData_dispose(skeletonData);
-				_spSkeletonJson_setError(self, root, "Slot bone not found: ", boneName);
+				_spSkeletonJson_setError(self, ownedRoot, "Slot bone not found: ", boneName);
 				return NULL;
 			}
 
@@ -1225,7 +1224,7 @@ spSkeletonData *spSkeletonJson_readSkeletonData(spSkeletonJson *self, const char
 				if (!data->bones[ii]) {
 					spIkConstraintData_dispose(data);
 					spSkeletonData_dispose(skeletonData);
-					_spSkeletonJson_setError(self, root, "IK bone not found: ", boneMap->valueString);
+					_spSkeletonJson_setError(self, ownedRoot, "IK bone not found: ", boneMap->valueString);
 					return NULL;
 				}
 			}
@@ -1235,7 +1234,7 @@ spSkeletonData *spSkeletonJson_readSkeletonData(spSkeletonJson *self, const char
 			if (!data->target) {
 				spIkConstraintData_dispose(data);
 				spSkeletonData_dispose(skeletonData);
-				_spSkeletonJson_setError(self, root, "Target bone not found: ", targetName);
+				_spSkeletonJson_setError(self, ownedRoot, "Target bone not found: ", targetName);
 				return NULL;
 			}
 
@@ -1272,7 +1271,7 @@ spSkeletonData *spSkeletonJson_readSkeletonData(spSkeletonJson *self, const char
 				if (!data->bones[ii]) {
 					spTransformConstraintData_dispose(data);
 					spSkeletonData_dispose(skeletonData);
-					_spSkeletonJson_setError(self, root, "Transform bone not found: ", boneMap->valueString);
+					_spSkeletonJson_setError(self, ownedRoot, "Transform bone not found: ", boneMap->valueString);
 					return NULL;
 				}
 			}
@@ -1282,7 +1281,7 @@ spSkeletonData *spSkeletonJson_readSkeletonData(spSkeletonJson *self, const char
 			if (!data->target) {
 				spTransformConstraintData_dispose(data);
 				spSkeletonData_dispose(skeletonData);
-				_spSkeletonJson_setError(self, root, "Target bone not found: ", name);
+				_spSkeletonJson_setError(self, ownedRoot, "Target bone not found: ", name);
 				return NULL;
 			}
 
@@ -1328,7 +1327,7 @@ spSkeletonData *spSkeletonJson_readSkeletonData(spSkeletonJson *self, const char
 				if (!data->bones[ii]) {
 					spPathConstraintData_dispose(data);
 					spSkeletonData_dispose(skeletonData);
-					_spSkeletonJson_setError(self, root, "Path bone not found: ", boneMap->valueString);
+					_spSkeletonJson_setError(self, ownedRoot, "Path bone not found: ", boneMap->valueString);
 					return NULL;
 				}
 			}
@@ -1338,7 +1337,7 @@ spSkeletonData *spSkeletonJson_readSkeletonData(spSkeletonJson *self, const char
 			if (!data->target) {
 				spPathConstraintData_dispose(data);
 				spSkeletonData_dispose(skeletonData);
-				_spSkeletonJson_setError(self, root, "Target slot not found: ", name);
+				_spSkeletonJson_setError(self, ownedRoot, "Target slot not found: ", name);
 				return NULL;
 			}
 
@@ -1396,7 +1395,7 @@ spSkeletonData *spSkeletonJson_readSkeletonData(spSkeletonJson *self, const char
 			data->bone = spSkeletonData_findBone(skeletonData, name);
 			if (!data->bone) {
 				spSkeletonData_dispose(skeletonData);
-				_spSkeletonJson_setError(self, root, "Physics bone not found: ", name);
+				_spSkeletonJson_setError(self, ownedRoot, "Physics bone not found: ", name);
 				return NULL;
 			}
 
@@ -1444,7 +1443,7 @@ spSkeletonData *spSkeletonJson_readSkeletonData(spSkeletonJson *self, const char
 					if (!bone) {
 						spSkin_dispose(skin);
 						spSkeletonData_dispose(skeletonData);
-						_spSkeletonJson_setError(self, root, "Skin bone constraint not found: ", skinPart->valueString);
+						_spSkeletonJson_setError(self, ownedRoot, "Skin bone constraint not found: ", skinPart->valueString);
 						return NULL;
 					}
 					spBoneDataArray_add(skin->bones, bone);
@@ -1459,7 +1458,7 @@ spSkeletonData *spSkeletonJson_readSkeletonData(spSkeletonJson *self, const char
 					if (!constraint) {
 						spSkin_dispose(skin);
 						spSkeletonData_dispose(skeletonData);
-						_spSkeletonJson_setError(self, root, "Skin IK constraint not found: ", skinPart->valueString);
+						_spSkeletonJson_setError(self, ownedRoot, "Skin IK constraint not found: ", skinPart->valueString);
 						return NULL;
 					}
 					spIkConstraintDataArray_add(skin->ikConstraints, constraint);
@@ -1474,7 +1473,7 @@ spSkeletonData *spSkeletonJson_readSkeletonData(spSkeletonJson *self, const char
 					if (!constraint) {
 						spSkin_dispose(skin);
 						spSkeletonData_dispose(skeletonData);
-						_spSkeletonJson_setError(self, root, "Skin path constraint not found: ", skinPart->valueString);
+						_spSkeletonJson_setError(self, ownedRoot, "Skin path constraint not found: ", skinPart->valueString);
 						return NULL;
 					}
 					spPathConstraintDataArray_add(skin->pathConstraints, constraint);
@@ -1489,7 +1488,7 @@ spSkeletonData *spSkeletonJson_readSkeletonData(spSkeletonJson *self, const char
 					if (!constraint) {
 						spSkin_dispose(skin);
 						spSkeletonData_dispose(skeletonData);
-						_spSkeletonJson_setError(self, root, "Skin transform constraint not found: ",
+						_spSkeletonJson_setError(self, ownedRoot, "Skin transform constraint not found: ",
 												 skinPart->valueString);
 						return NULL;
 					}
@@ -1504,7 +1503,7 @@ spSkeletonData *spSkeletonJson_readSkeletonData(spSkeletonJson *self, const char
 																							   skinPart->valueString);
 					if (!constraint) {
 						spSkeletonData_dispose(skeletonData);
-						_spSkeletonJson_setError(self, root, "Skin physics constraint not found: ", skinPart->valueString);
+						_spSkeletonJson_setError(self, ownedRoot, "Skin physics constraint not found: ", skinPart->valueString);
 						return NULL;
 					}
 					spPhysicsConstraintDataArray_add(skin->physicsConstraints, constraint);
@@ -1546,7 +1545,7 @@ spSkeletonData *spSkeletonJson_readSkeletonData(spSkeletonJson *self, const char
 							type = SP_ATTACHMENT_POINT;
 						else {
 							spSkeletonData_dispose(skeletonData);
-							_spSkeletonJson_setError(self, root, "Unknown attachment type: ", typeString);
+							_spSkeletonJson_setError(self, ownedRoot, "Unknown attachment type: ", typeString);
 							return NULL;
 						}
 
@@ -1557,7 +1556,7 @@ spSkeletonData *spSkeletonJson_readSkeletonData(spSkeletonJson *self, const char
 						if (!attachment) {
 							if (self->attachmentLoader->error1) {
 								spSkeletonData_dispose(skeletonData);
-								_spSkeletonJson_setError(self, root, self->attachmentLoader->error1,
+								_spSkeletonJson_setError(self, ownedRoot, self->attachmentLoader->error1,
 														 self->attachmentLoader->error2);
 								return NULL;
 							}
@@ -1741,13 +1740,13 @@ spSkeletonData *spSkeletonJson_readSkeletonData(spSkeletonJson *self, const char
 		spSkin *skin = !linkedMesh->skin ? skeletonData->defaultSkin : spSkeletonData_findSkin(skeletonData, linkedMesh->skin);
 		if (!skin) {
 			spSkeletonData_dispose(skeletonData);
-			_spSkeletonJson_setError(self, root, "Skin not found: ", linkedMesh->skin);
+			_spSkeletonJson_setError(self, ownedRoot, "Skin not found: ", linkedMesh->skin);
 			return NULL;
 		}
 		parent = spSkin_getAttachment(skin, linkedMesh->slotIndex, linkedMesh->parent);
 		if (!parent) {
 			spSkeletonData_dispose(skeletonData);
-			_spSkeletonJson_setError(self, root, "Parent mesh not found: ", linkedMesh->parent);
+			_spSkeletonJson_setError(self, ownedRoot, "Parent mesh not found: ", linkedMesh->parent);
 			return NULL;
 		}
 		linkedMesh->mesh->super.timelineAttachment = linkedMesh->inheritTimeline ? parent
@@ -1790,13 +1789,28 @@ spSkeletonData *spSkeletonJson_readSkeletonData(spSkeletonJson *self, const char
 			spAnimation *animation = _spSkeletonJson_readAnimation(self, animationMap, skeletonData);
 			if (!animation) {
 				spSkeletonData_dispose(skeletonData);
-				_spSkeletonJson_setError(self, root, "Animation broken: ", animationMap->name);
+				_spSkeletonJson_setError(self, ownedRoot, "Animation broken: ", animationMap->name);
 				return NULL;
 			}
 			skeletonData->animations[skeletonData->animationsCount++] = animation;
 		}
 	}
 
-	Json_dispose(root);
+	if (ownedRoot) Json_dispose(ownedRoot);
 	return skeletonData;
 }
+
+/* Defold */
+spSkeletonData *spSkeletonJson_readSkeletonDataWithLength(spSkeletonJson *self, const char *json, int length) {
+	Json *root = Json_createWithLength(json, length);
+	if (!root) {
+		_spSkeletonJson_setError(self, 0, "Invalid skeleton JSON: ", Json_getError());
+		return NULL;
+	}
+	return _spSkeletonJson_readSkeletonDataJson(self, root, root);
+}
+
+/* Defold */
+spSkeletonData *spSkeletonJson_readSkeletonDataJson(spSkeletonJson *self, struct Json *root) {
+	return _spSkeletonJson_readSkeletonDataJson(self, root, 0);
+}
@@ -0,0 +1,347 @@
+
+extern "C" {
+#include <spine/Animation.h>
+#include <spine/Bone.h>
+#include <spine/Skeleton.h>
+#include <spine/SkeletonData.h>
+}
+
+#include <math.h>   // ceilf
+#include <string.h> // memset, strcmp
+
+#include <dmsdk/dlib/hash.h>
+#include <dmsdk/dlib/log.h>
+#include <dmsdk/dlib/math.h>
+
+#include <common/spine_baked.h>
+
+namespace dmSpine
+{
+    // The channels written by a bone timeline, or 0 if it's not a (bakeable) bone timeline
+    static uint8_t GetTimelineChannels(spTimelineType type)
+    {
+        switch(type)
+        {
+        case SP_TIMELINE_ROTATE:        return BAKED_CHANNEL_ROTATION;
+        case SP_TIMELINE_TRANSLATE:     return BAKED_CHANNEL_X | BAKED_CHANNEL_Y;
+        case SP_TIMELINE_TRANSLATEX:    return BAKED_CHANNEL_X;
+        case SP_TIMELINE_TRANSLATEY:    return BAKED_CHANNEL_Y;
+        case SP_TIMELINE_SCALE:         return BAKED_CHANNEL_SCALE_X | BAKED_CHANNEL_SCALE_Y;
+        case SP_TIMELINE_SCALEX:        return BAKED_CHANNEL_SCALE_X;
+        case SP_TIMELINE_SCALEY:        return BAKED_CHANNEL_SCALE_Y;
+        case SP_TIMELINE_SHEAR:         return BAKED_CHANNEL_SHEAR_X | BAKED_CHANNEL_SHEAR_Y;
+        case SP_TIMELINE_SHEARX:        return BAKED_CHANNEL_SHEAR_X;
+        case SP_TIMELINE_SHEARY:        return BAKED_CHANNEL_SHEAR_Y;
+        default:                        return 0;
+        }
+    }
+
+    static uint32_t CountChannels(uint8_t channels)
+    {
+        uint32_t count = 0;
+        for (; channels; channels >>= 1)
+            count += channels & 1;
+        return count;
+    }
+
+    static void PushBytes(dmArray<uint8_t>& data, const void* bytes, uint32_t size)
+    {
+        if (data.Remaining() < size)
+        {
+            data.OffsetCapacity(dmMath::Max(size, data.Capacity() / 2));
+        }
+        data.PushArray((const uint8_t*)bytes, size);
+    }
+
+    static spAnimation* FindAnimation(spSkeletonData* skeleton_data, const char* name)
+    {
+        for (int i = 0; i < skeleton_data->animationsCount; ++i)
+        {
+            if (strcmp(skeleton_data->animations[i]->name, name) == 0)
+                return skeleton_data->animations[i];
+        }
+        return 0;
+    }
+
+    // Returns the number of floats written
+    static uint32_t WriteBoneChannels(const spBone* bone, uint8_t channels, float* out)
+    {
+        float* start = out;
+        if (channels & BAKED_CHANNEL_X)         *out++ = bone->x;
+        if (channels & BAKED_CHANNEL_Y)         *out++ = bone->y;
+        if (channels & BAKED_CHANNEL_ROTATION)  *out++ = bone->rotation;
+        if (channels & BAKED_CHANNEL_SCALE_X)   *out++ = bone->scaleX;
+        if (channels & BAKED_CHANNEL_SCALE_Y)   *out++ = bone->scaleY;
+        if (channels & BAKED_CHANNEL_SHEAR_X)   *out++ = bone->shearX;
+        if (channels & BAKED_CHANNEL_SHEAR_Y)   *out++ = bone->shearY;
+        return (uint32_t)(out - start);
+    }
+
+    struct BakeScratch
+    {
+        dmArray<uint8_t>    m_Channels; // Per bone in the skeleton
+        dmArray<BakedBone>  m_Bones;
+        dmArray<float>      m_Frames;
+    };
+
+    // Stores the animated bones and frames in the scratch, and returns the number of channels per frame
+    static uint32_t SampleAnimation(spSkeleton* skeleton, spAnimation* animation, float sample_rate, BakeScratch& scratch, BakedAnimation& out, BakedAnimationInfo& info)
+    {
+        uint32_t bone_count = (uint32_t)skeleton->bonesCount;
+        scratch.m_Channels.SetCapacity(bone_count);
+        scratch.m_Channels.SetSize(bone_count);
+        memset(scratch.m_Channels.Begin(), 0, bone_count);
+
+        info.m_Name = animation->name;
+        info.m_TotalTimelines = (uint32_t)animation->timelines->size;
+        info.m_BakedTimelines = 0;
+        info.m_BakedKeys = 0;
+
+        for (int i = 0; i < animation->timelines->size; ++i)
+        {
+            spTimeline* timeline = animation->timelines->items[i];
+            uint8_t channels = GetTimelineChannels(timeline->type);
+            if (!channels)
+                continue;
+
+            // All bone timelines share the same layout
+            int bone_index = ((spRotateTimeline*)timeline)->boneIndex;
+            scratch.m_Channels[bone_index] |= channels;
+            info.m_BakedTimelines++;
+            info.m_BakedKeys += (uint32_t)timeline->frameCount;
+        }
+
+        scratch.m_Bones.SetSize(0);
+        scratch.m_Bones.SetCapacity(bone_count);
+        uint32_t channel_count = 0;
+        for (uint32_t i = 0; i < bone_count; ++i)
+        {
+            if (!scratch.m_Channels[i])
+                continue;
+            BakedBone bone;
+            bone.m_BoneIndex = (uint16_t)i;
+            bone.m_Channels = scratch.m_Channels[i];
+            bone.m_Padding = 0;
+            scratch.m_Bones.Push(bone);
+            channel_count += CountChannels(bone.m_Channels);
+        }
+
+        float duration = animation->duration;
+        uint32_t frame_count = 1;
+        if (duration > 0.0f)
+        {
+            frame_count = dmMath::Max(2U, (uint32_t)ceilf(duration * sample_rate) + 1);
+        }
+
+        scratch.m_Frames.SetSize(0);
+        scratch.m_Frames.SetCapacity(frame_count * channel_count);
+        scratch.m_Frames.SetSize(frame_count * channel_count);
+
+        if (channel_count)
+        {
+            float* out_frame = scratch.m_Frames.Begin();
+            for (uint32_t f = 0; f < frame_count; ++f)
+            {
+                float time = frame_count > 1 ? (duration * f) / (frame_count - 1) : 0.0f;
+                spSkeleton_setBonesToSetupPose(skeleton);
+                spAnimation_apply(animation, skeleton, -1.0f, time, 0, 0, 0, 1.0f, SP_MIX_BLEND_SETUP, SP_MIX_DIRECTION_IN);
+
+                for (uint32_t i = 0; i < scratch.m_Bones.Size(); ++i)
+                {
+                    const BakedBone& bone = scratch.m_Bones[i];
+                    out_frame += WriteBoneChannels(skeleton->bones[bone.m_BoneIndex], bone.m_Channels, out_frame);
+                }
+            }
+        }
+
+        out.m_NameHash = dmHashString64(animation->name);
+        out.m_SampleRate = frame_count > 1 ? (frame_count - 1) / duration : 0.0f;
+        out.m_Duration = duration;
+        out.m_FrameCount = frame_count;
+        out.m_BoneCount = scratch.m_Bones.Size();
+        out.m_ChannelCount = channel_count;
+        out.m_BonesOffset = 0;
+        out.m_FramesOffset = 0;
+        out.m_Padding = 0;
+
+        info.m_FrameCount = frame_count;
+        info.m_BoneCount = scratch.m_Bones.Size();
+        info.m_ChannelCount = channel_count;
+        info.m_DataSize = channel_count ? sizeof(BakedAnimation) + scratch.m_Bones.Size() * sizeof(BakedBone) + scratch.m_Frames.Size() * sizeof(float) : 0;
+        return channel_count;
+    }
+
+    bool BakeAnimations(spSkeletonData* skeleton_data, const char** names, uint32_t names_count, float sample_rate,
+                        dmArray<uint8_t>& out_data, dmArray<BakedAnimationInfo>& out_info)
+    {
+        out_data.SetSize(0);
+        out_info.SetSize(0);
+
+        if (sample_rate <= 0.0f)
+        {
+            dmLogError("Invalid bake sample rate: %f", sample_rate);
+            return false;
+        }
+
+        // "*" bakes all animations
+        bool all = names_count == 1 && strcmp(names[0], "*") == 0;
+
+        dmArray<spAnimation*> animations;
+        animations.SetCapacity(all ? skeleton_data->animationsCount : names_count);
+        if (all)
+        {
+            for (int i = 0; i < skeleton_data->animationsCount; ++i)
+                animations.Push(skeleton_data->animations[i]);
+        }
+        else
+        {
+            for (uint32_t i = 0; i < names_count; ++i)
+            {
+                spAnimation* animation = FindAnimation(skeleton_data, names[i]);
+                if (!animation)
+                {
+                    dmLogError("Cannot bake animation '%s': No such animation", names[i]);
+                    return false;
+                }
+                animations.Push(animation);
+            }
+        }
+
+        spSkeleton* skeleton = spSkeleton_create(skeleton_data);
+
+        // Only animations with bone timelines are written, so we sample them before writing the records
+        dmArray<BakedAnimation> records;
+        dmArray<uint8_t> payload;
+        records.SetCapacity(animations.Size());
+        out_info.SetCapacity(animations.Size());
+
+        BakeScratch scratch;
+        for (uint32_t i = 0; i < animations.Size(); ++i)
+        {
+            BakedAnimation record;
+            BakedAnimationInfo info;
+            uint32_t channel_count = SampleAnimation(skeleton, animations[i], sample_rate, scratch, record, info);
+            out_info.Push(info);
+            if (!channel_count)
+                continue;
+
+            // Relative to the payload for now
+            record.m_BonesOffset = payload.Size();
+            PushBytes(payload, scratch.m_Bones.Begin(), scratch.m_Bones.Size() * sizeof(BakedBone));
+            record.m_FramesOffset = payload.Size();
+            PushBytes(payload, scratch.m_Frames.Begin(), scratch.m_Frames.Size() * sizeof(float));
+            records.Push(record);
+        }
+
+        spSkeleton_dispose(skeleton);
+
+        if (records.Empty())
+            return true;
+
+        BakedAnimationsHeader header;
+        header.m_Magic = BAKED_ANIMATIONS_MAGIC;
+        header.m_Version = BAKED_ANIMATIONS_VERSION;
+        header.m_BoneCount = (uint32_t)skeleton_data->bonesCount;
+        header.m_AnimationCount = records.Size();
+
+        uint32_t payload_offset = sizeof(BakedAnimationsHeader) + records.Size() * sizeof(BakedAnimation);
+        for (uint32_t i = 0; i < records.Size(); ++i)
+        {
+            records[i].m_BonesOffset += payload_offset;
+            records[i].m_FramesOffset += payload_offset;
+        }
+
+        out_data.SetCapacity(payload_offset + payload.Size());
+        PushBytes(out_data, &header, sizeof(header));
+        PushBytes(out_data, records.Begin(), records.Size() * sizeof(BakedAnimation));
+        PushBytes(out_data, payload.Begin(), payload.Size());
+        return true;
+    }
+
+    const BakedAnimationsHeader* GetBakedAnimations(const void* data, uint32_t data_size, const spSkeletonData* skeleton_data)
+    {
+        if (!data || data_size < sizeof(BakedAnimationsHeader))
+            return 0;
+
+        const BakedAnimationsHeader* header = (const BakedAnimationsHeader*)data;
+        if (header->m_Magic != BAKED_ANIMATIONS_MAGIC || header->m_Version != BAKED_ANIMATIONS_VERSION)
+        {
+            dmLogError("Unsupported baked animation data (version %u)", header->m_Version);
+            return 0;
+        }
+        if (header->m_BoneCount != (uint32_t)skeleton_data->bonesCount)
+        {
+            dmLogError("The baked animations don't match the skeleton (%u bones, expected %d)", header->m_BoneCount, skeleton_data->bonesCount);
+            return 0;
+        }
+
+        uint32_t records_end = sizeof(BakedAnimationsHeader) + header->m_AnimationCount * sizeof(BakedAnimation);
+        if (records_end > data_size)
+            return 0;
+
+        for (uint32_t i = 0; i < header->m_AnimationCount; ++i)
+        {
+            const BakedAnimation* animation = GetBakedAnimation(header, i);
+            uint32_t bones_end = animation->m_BonesOffset + animation->m_BoneCount * sizeof(BakedBone);
+            uint32_t frames_end = animation->m_FramesOffset + animation->m_FrameCount * animation->m_ChannelCount * sizeof(float);
+            if (animation->m_FrameCount == 0 || bones_end > data_size || frames_end > data_size)
+                return 0;
+
+            const BakedBone* bones = (const BakedBone*)((const uint8_t*)header + animation->m_BonesOffset);
+            for (uint32_t b = 0; b < animation->m_BoneCount; ++b)
+            {
+                if (bones[b].m_BoneIndex >= header->m_BoneCount)
+                    return 0;
+            }
+        }
+        return header;
+    }
+
+    const BakedAnimation* GetBakedAnimation(const BakedAnimationsHeader* header, uint32_t index)
+    {
+        return &((const BakedAnimation*)(header + 1))[index];
+    }
+
+    void ApplyBakedAnimation(const BakedAnimationsHeader* header, const BakedAnimation* animation, spSkeleton* skeleton, float time)
+    {
+        const uint8_t* base = (const uint8_t*)header;
+        const BakedBone* bones = (const BakedBone*)(base + animation->m_BonesOffset);
+        const float* frames = (const float*)(base + animation->m_FramesOffset);
+
+        uint32_t last_frame = animation->m_FrameCount - 1;
+        float position = time * animation->m_SampleRate;
+        uint32_t frame = 0;
+        float t = 0.0f;
+        if (position >= (float)last_frame)
+        {
+            frame = last_frame;
+        }
+        else if (position > 0.0f)
+        {
+            frame = (uint32_t)position;
+            t = position - (float)frame;
+        }
+
+        const float* a = frames + frame * animation->m_ChannelCount;
+        const float* b = frames + dmMath::Min(frame + 1, last_frame) * animation->m_ChannelCount;
+
+#define BAKED_LERP(_CHANNEL, _FIELD) \
+        if (channels & (_CHANNEL)) { bone->_FIELD = *a + (*b - *a) * t; ++a; ++b; }
+
+        for (uint32_t i = 0; i < animation->m_BoneCount; ++i)
+        {
+            spBone* bone = skeleton->bones[bones[i].m_BoneIndex];
+            uint8_t channels = bones[i].m_Channels;
+            BAKED_LERP(BAKED_CHANNEL_X, x);
+            BAKED_LERP(BAKED_CHANNEL_Y, y);
+            BAKED_LERP(BAKED_CHANNEL_ROTATION, rotation);
+            BAKED_LERP(BAKED_CHANNEL_SCALE_X, scaleX);
+            BAKED_LERP(BAKED_CHANNEL_SCALE_Y, scaleY);
+            BAKED_LERP(BAKED_CHANNEL_SHEAR_X, shearX);
+            BAKED_LERP(BAKED_CHANNEL_SHEAR_Y, shearY);
+        }
+
+#undef BAKED_LERP
+    }
+
+} // namespace
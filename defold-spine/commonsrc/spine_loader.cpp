@@ -3,9 +3,13 @@ extern "C" {
 #include <spine/extension.h>
 #include <spine/AttachmentLoader.h>
 #include <spine/Attachment.h>
+#include <spine/SkeletonBinary.h>
 #include <spine/SkeletonJson.h>
+#include "spine/Json.h"
 }
 
+#include <string.h>
+
 #include <dmsdk/dlib/hash.h>
 #include <dmsdk/dlib/log.h>
 #include <dmsdk/gamesys/resources/res_textureset.h>
@@ -188,6 +192,12 @@ namespace dmSpine
                 region->offsetY = 0;
                 region->width = region->originalWidth = animation_ddf->m_Width;
                 region->height = region->originalHeight = animation_ddf->m_Height;
+
+                // Paged atlases are texture arrays, and the page is the layer to sample
+                if (frame_index < texture_set_ddf->m_PageIndices.m_Count)
+                    atlasRegion->pageIndex = (int)texture_set_ddf->m_PageIndices[frame_index];
+
+                DEBUGLOG("  page: %d", atlasRegion->pageIndex);
         }
 
         return regions;
@@ -359,7 +369,23 @@ namespace dmSpine
         spAttachmentLoader_dispose((spAttachmentLoader*)loader);
     }
 
-    spSkeletonData* ReadSkeletonJsonData(spAttachmentLoader* loader, const char* path, void* json_data)
+    struct Json* ParseSkeletonJson(const char* path, const void* json_data, uint32_t json_size)
+    {
+        Json* json = Json_createWithLength((const char*)json_data, (int)json_size);
+        if (!json)
+        {
+            const char* error = Json_getError();
+            dmLogError("Failed to parse spine json %s at offset %d", path, error ? (int)(error - (const char*)json_data) : -1);
+        }
+        return json;
+    }
+
+    void DisposeSkeletonJson(struct Json* json)
+    {
+        Json_dispose(json);
+    }
+
+    static spSkeletonData* ReadSkeletonJsonData(spAttachmentLoader* loader, const char* path, const void* json_data, uint32_t json_size, struct Json* json)
     {
         spSkeletonJson* skeleton_json = spSkeletonJson_createWithLoader(loader);
         if (!skeleton_json) {
@@ -369,10 +395,11 @@ namespace dmSpine
 
         //DEBUGLOG("%s: %p   json: %p", __FUNCTION__, skeleton_json, json_data);
 
-        spSkeletonData* skeletonData = spSkeletonJson_readSkeletonData(skeleton_json, (const char *)json_data);
+        spSkeletonData* skeletonData = json ? spSkeletonJson_readSkeletonDataJson(skeleton_json, json)
+                                            : spSkeletonJson_readSkeletonDataWithLength(skeleton_json, (const char *)json_data, (int)json_size);
         if (!skeletonData)
         {
-            loader->error1 = strdup(skeleton_json->error ? skeleton_json->error : "unknown error");
+            MALLOC_STR(loader->error1, skeleton_json->error ? skeleton_json->error : "unknown error"); // Freed by the spine runtime
             spSkeletonJson_dispose(skeleton_json);
             dmLogError("Failed to read spine skeleton for %s: %s", path, loader->error1);
             return 0;
@@ -381,4 +408,53 @@ namespace dmSpine
         return skeletonData;
     }
 
+    spSkeletonData* ReadSkeletonJsonData(spAttachmentLoader* loader, const char* path, const void* json_data, uint32_t json_size)
+    {
+        return ReadSkeletonJsonData(loader, path, json_data, json_size, 0);
+    }
+
+    spSkeletonData* ReadSkeletonJsonData(spAttachmentLoader* loader, const char* path, struct Json* json)
+    {
+        return ReadSkeletonJsonData(loader, path, 0, 0, json);
+    }
+
+    spSkeletonData* ReadSkeletonBinaryData(spAttachmentLoader* loader, const char* path, const void* data, uint32_t data_size)
+    {
+        spSkeletonBinary* skeleton_binary = spSkeletonBinary_createWithLoader(loader);
+        if (!skeleton_binary) {
+            dmLogError("Failed to create spine skeleton for %s", path);
+            return 0;
+        }
+
+        spSkeletonData* skeletonData = spSkeletonBinary_readSkeletonData(skeleton_binary, (const unsigned char*)data, (int)data_size);
+        if (!skeletonData)
+        {
+            MALLOC_STR(loader->error1, skeleton_binary->error ? skeleton_binary->error : "unknown error");
+            spSkeletonBinary_dispose(skeleton_binary);
+            dmLogError("Failed to read spine skeleton for %s: %s", path, loader->error1);
+            return 0;
+        }
+        spSkeletonBinary_dispose(skeleton_binary);
+        return skeletonData;
+    }
+
+    static bool EndsWith(const char* str, const char* suffix)
+    {
+        size_t str_len = strlen(str);
+        size_t suffix_len = strlen(suffix);
+        return str_len >= suffix_len && strcmp(str + str_len - suffix_len, suffix) == 0;
+    }
+
+    bool IsSkeletonBinaryPath(const char* path)
+    {
+        return path && (EndsWith(path, ".spineskel") || EndsWith(path, ".spineskelc"));
+    }
+
+    spSkeletonData* ReadSkeletonData(spAttachmentLoader* loader, const char* path, void* data, uint32_t data_size)
+    {
+        if (IsSkeletonBinaryPath(path))
+            return ReadSkeletonBinaryData(loader, path, data, data_size);
+        return ReadSkeletonJsonData(loader, path, data, data_size);
+    }
+
 } // namespace
@@ -1,16 +1,33 @@
 #include <common/vertices.h>
 
 #include <spine/extension.h>
+#include <spine/Animation.h>
+#include <spine/Atlas.h>
 #include <spine/Skeleton.h>
+#include <spine/SkeletonData.h>
+#include <spine/Skin.h>
 #include <spine/SkeletonClipping.h>
 #include <spine/Slot.h>
 #include <spine/Attachment.h>
 #include <spine/MeshAttachment.h>
 #include <spine/RegionAttachment.h>
+#include <spine/Sequence.h>
 
+#include <assert.h>
 #include <float.h>                      // using FLT_MAX
+#include <math.h>                       // using ceilf
+#include <string.h>                     // using memset
+#include <dmsdk/dlib/hash.h>
 #include <dmsdk/dlib/math.h>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define SPINE_VERTICES_SSE2
+    #include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+    #define SPINE_VERTICES_NEON
+    #include <arm_neon.h>
+#endif
+
 namespace dmSpine
 {
     static const uint32_t ATTACHMENT_REGION_VERTEX_COUNT = 4; // Region attachments render as quads.
@@ -87,13 +104,29 @@ static void EnsureArraySize(dmArray<T>& array, uint32_t size)
     array.SetSize(size);
 }
 
-void GetSkeletonBounds(const spSkeleton* skeleton, SpineModelBounds& bounds, dmArray<float>& scratch)
+// The atlas page of the region that the attachment shows (see CreateRegions)
+static inline float GetPageIndex(const void* renderer_object)
+{
+    // Not set if the skeleton was loaded without its atlas
+    const spAtlasRegion* region = (const spAtlasRegion*)renderer_object;
+    return region ? (float)region->pageIndex : 0.0f;
+}
+
+static inline uint32_t GetAttachmentWorldVerticesLength(const spAttachment* attachment)
+{
+    if (attachment->type == SP_ATTACHMENT_REGION)
+        return ATTACHMENT_REGION_NUM_FLOATS;
+    if (attachment->type == SP_ATTACHMENT_MESH)
+        return ((const spMeshAttachment*)attachment)->super.worldVerticesLength;
+    return 0;
+}
+
+uint32_t GetSkeletonWorldVertices(const spSkeleton* skeleton, SpineModelBounds& bounds, dmArray<float>& out_world_vertices)
 {
     // Clipping attachments are intentionally ignored here. The unclipped region/mesh
     // bounds conservatively contain the clipped output and are cheaper to compute.
-    // Invisible attachments are included because the editor uses this function as a
+    // Invisible attachments are included because the editor uses the bounds as a
     // fallback when the first frame does not generate any render vertices.
-    EnsureArraySize(scratch, ATTACHMENT_REGION_NUM_FLOATS);
 
     // a "negative" bounding rectangle for starters
     bounds.minX = FLT_MAX;
@@ -101,6 +134,17 @@ void GetSkeletonBounds(const spSkeleton* skeleton, SpineModelBounds& bounds, dmA
     bounds.maxX = -FLT_MAX;
     bounds.maxY = -FLT_MAX;
 
+    uint32_t num_floats = 0;
+    for (int s = 0; s < skeleton->slotsCount; ++s)
+    {
+        spAttachment* attachment = skeleton->drawOrder[s]->attachment;
+        if (attachment)
+            num_floats += GetAttachmentWorldVerticesLength(attachment);
+    }
+
+    uint32_t offset = EnsureArrayFitsNumberGeometric(out_world_vertices, num_floats);
+    float* coords = out_world_vertices.Begin() + offset;
+
     // For each slot in the draw order array of the skeleton
     for (int s = 0; s < skeleton->slotsCount; ++s)
     {
@@ -115,49 +159,103 @@ void GetSkeletonBounds(const spSkeleton* skeleton, SpineModelBounds& bounds, dmA
             continue;
         }
 
-        int num_world_vertices = 0;
-        spAttachmentType type = attachment->type;
-
-        // Fill the vertices array depending on the type of attachment
-        if (type == SP_ATTACHMENT_REGION)
+        // Fill the vertices array depending on the type of attachment.
+        // This assumes the world transform of the bone to which the slot (and hence attachment)
+        // is attached has been calculated before rendering via spSkeleton_updateWorldTransform
+        uint32_t length = GetAttachmentWorldVerticesLength(attachment);
+        if (attachment->type == SP_ATTACHMENT_REGION)
         {
-            // Cast to an spRegionAttachment so we can get the rendererObject
-            // and compute the world vertices
-            spRegionAttachment* regionAttachment = (spRegionAttachment*)attachment;
-            // Computed the world vertices positions for the 4 vertices that make up
-            // the rectangular region attachment. This assumes the world transform of the
-            // bone to which the slot (and hence attachment) is attached has been calculated
-            // before rendering via spSkeleton_updateWorldTransform
-            spRegionAttachment_computeWorldVertices(regionAttachment, slot, scratch.Begin(), 0, 2);
-            num_world_vertices = 4;
+            spRegionAttachment_computeWorldVertices((spRegionAttachment*)attachment, slot, coords, 0, 2);
         }
-        else if (type == SP_ATTACHMENT_MESH)
+        else if (attachment->type == SP_ATTACHMENT_MESH)
         {
-            // Cast to an spMeshAttachment so we can get the rendererObject
-            // and compute the world vertices
             spMeshAttachment* mesh = (spMeshAttachment*)attachment;
-            num_world_vertices = mesh->super.worldVerticesLength / 2;
+            spVertexAttachment_computeWorldVertices(SUPER(mesh), slot, 0, length, coords, 0, 2);
+        }
 
-            EnsureArraySize(scratch, num_world_vertices*2);
+        // go through vertex coords and update max/min for X and Y
+        for (uint32_t i = 0; i < length; i += 2)
+        {
+            float x = *coords++;
+            float y = *coords++;
+            bounds.minX = dmMath::Min(x, bounds.minX);
+            bounds.minY = dmMath::Min(y, bounds.minY);
+            bounds.maxX = dmMath::Max(x, bounds.maxX);
+            bounds.maxY = dmMath::Max(y, bounds.maxY);
+        }
+    }
+    return num_floats;
+}
 
-            // Computed the world vertices positions for the vertices that make up
-            // the mesh attachment. This assumes the world transform of the
-            // bone to which the slot (and hence attachment) is attached has been calculated
-            // before rendering via spSkeleton_updateWorldTransform
+void GetSkeletonBounds(const spSkeleton* skeleton, SpineModelBounds& bounds, dmArray<float>& scratch)
+{
+    scratch.SetSize(0);
+    GetSkeletonWorldVertices(skeleton, bounds, scratch);
+}
 
-            spVertexAttachment_computeWorldVertices(SUPER(mesh), slot, 0, num_world_vertices*2, scratch.Begin(), 0, 2);
-        }
+static void AddAttachmentBounds(spSlot* slot, spAttachment* attachment, SpineModelBounds& bounds, dmArray<float>& scratch)
+{
+    uint32_t length = GetAttachmentWorldVerticesLength(attachment);
+    if (!length)
+        return;
+
+    // The deformed vertices of a slot only apply to its current attachment
+    spSlot unattached_slot;
+    if (attachment != slot->attachment)
+    {
+        unattached_slot = *slot;
+        unattached_slot.attachment = attachment;
+        unattached_slot.deformCount = 0;
+        slot = &unattached_slot;
+    }
+
+    EnsureArraySize(scratch, length);
+    float* coords = scratch.Begin();
+    if (attachment->type == SP_ATTACHMENT_REGION)
+    {
+        spRegionAttachment_computeWorldVertices((spRegionAttachment*)attachment, slot, coords, 0, 2);
+    }
+    else
+    {
+        spMeshAttachment* mesh = (spMeshAttachment*)attachment;
+        spVertexAttachment_computeWorldVertices(SUPER(mesh), slot, 0, length, coords, 0, 2);
+    }
+
+    for (uint32_t i = 0; i < length; i += 2)
+    {
+        bounds.minX = dmMath::Min(coords[i], bounds.minX);
+        bounds.minY = dmMath::Min(coords[i+1], bounds.minY);
+        bounds.maxX = dmMath::Max(coords[i], bounds.maxX);
+        bounds.maxY = dmMath::Max(coords[i+1], bounds.maxY);
+    }
+}
 
-        if (type == SP_ATTACHMENT_REGION || type == SP_ATTACHMENT_MESH) {
-            // go through vertex coords and update max/min for X and Y
-            float* coords = scratch.Begin();
-            for (int i=0; i<num_world_vertices; i++) {
-                float x = *coords++;
-                float y = *coords++;
-                bounds.minX = dmMath::Min(x, bounds.minX);
-                bounds.minY = dmMath::Min(y, bounds.minY);
-                bounds.maxX = dmMath::Max(x, bounds.maxX);
-                bounds.maxY = dmMath::Max(y, bounds.maxY);
+void GetAnimationBounds(spSkeleton* skeleton, const spAnimation* animation, float sample_rate, SpineModelBounds& bounds, dmArray<float>& scratch)
+{
+    bounds.minX = FLT_MAX;
+    bounds.minY = FLT_MAX;
+    bounds.maxX = -FLT_MAX;
+    bounds.maxY = -FLT_MAX;
+
+    const spSkeletonData* data = skeleton->data;
+    float duration = animation ? animation->duration : 0.0f;
+    uint32_t sample_count = (uint32_t)ceilf(duration * sample_rate) + 1;
+    for (uint32_t i = 0; i < sample_count; ++i)
+    {
+        // The last sample is at the end of the animation
+        float time = dmMath::Min(i / sample_rate, duration);
+
+        spSkeleton_setToSetupPose(skeleton);
+        if (animation)
+            spAnimation_apply(animation, skeleton, time, time, 0, 0, 0, 1.0f, SP_MIX_BLEND_SETUP, SP_MIX_DIRECTION_IN);
+        spSkeleton_updateWorldTransform(skeleton, SP_PHYSICS_POSE);
+
+        // Any attachment may be shown by a later animation or at runtime, so all skins are included
+        for (int s = 0; s < data->skinsCount; ++s)
+        {
+            for (const spSkinEntry* entry = spSkin_getAttachments(data->skins[s]); entry; entry = entry->next)
+            {
+                AddAttachmentBounds(skeleton->slots[entry->slotIndex], entry->attachment, bounds, scratch);
             }
         }
     }
@@ -319,16 +417,73 @@ uint32_t CalcDrawDescCount(const spSkeleton* skeleton)
     return count;
 }
 
-uint32_t GenerateVertexData(dmArray<SpineVertex>& vertex_buffer, const spSkeleton* skeleton, spSkeletonClipping* skeleton_clipper, const dmVMath::Matrix4& world, const dmVMath::Vector4& color_tint, dmArray<SpineDrawDesc>* draw_descs_out)
+uint64_t CalcGeometrySignature(const spSkeleton* skeleton, bool* out_clipped)
+{
+    // Follows the visibility tests of the vertex generation, since they decide which attachments add vertices
+    HashState64 state;
+    dmHashInit64(&state, false);
+    bool clipped = false;
+    for (int s = 0; s < skeleton->slotsCount; ++s)
+    {
+        spSlot* slot = skeleton->drawOrder[s];
+        spAttachment* attachment = slot->attachment;
+        if (!attachment || !HasRenderableAlpha(slot->color.a) || !slot->bone->active)
+        {
+            continue;
+        }
+
+        spAttachmentType type = attachment->type;
+        if (type == SP_ATTACHMENT_REGION && !HasRenderableAlpha(((spRegionAttachment*)attachment)->color.a))
+        {
+            continue;
+        }
+        if (type == SP_ATTACHMENT_MESH && !HasRenderableAlpha(((spMeshAttachment*)attachment)->color.a))
+        {
+            continue;
+        }
+        if (type == SP_ATTACHMENT_CLIPPING)
+        {
+            clipped = true;
+        }
+        else if (type != SP_ATTACHMENT_REGION && type != SP_ATTACHMENT_MESH)
+        {
+            continue;
+        }
+        dmHashUpdateBuffer64(&state, &attachment, sizeof(attachment));
+    }
+    if (out_clipped)
+    {
+        *out_clipped = clipped;
+    }
+    return dmHashFinal64(&state);
+}
+
+bool CheckGeometrySizeCache(SpineGeometrySizeCache& cache, const spSkeleton* skeleton)
+{
+    bool clipped = false;
+    uint64_t signature = CalcGeometrySignature(skeleton, &clipped);
+    if (cache.m_Signature == signature && cache.m_VertexCount)
+    {
+        return true;
+    }
+    cache.m_Signature = signature;
+    cache.m_VertexCount = 0;
+    cache.m_IndexCount = 0;
+    cache.m_Clipped = clipped;
+    return false;
+}
+
+uint32_t GenerateVertexData(dmArray<SpineVertex>& vertex_buffer, const spSkeleton* skeleton, spSkeletonClipping* skeleton_clipper, const dmVMath::Matrix4& world, const dmVMath::Vector4& color_tint, dmArray<SpineDrawDesc>* draw_descs_out, SpineGeometrySizeCache* size_cache)
 {
     dmArray<float> scratch_vertex_floats;
-    int vindex                  = vertex_buffer.Size();
-    int vindex_start            = vindex;
-    uint32_t max_triangle_count = 0;
-    uint32_t estimated_vcount   = CalcVertexBufferSize(skeleton, skeleton_clipper, &max_triangle_count);
+    int vindex_start            = vertex_buffer.Size();
 
-    EnsureArrayFitsNumber(scratch_vertex_floats, max_triangle_count);
-    EnsureArrayFitsNumber(vertex_buffer, estimated_vcount);
+    // The size of the previous frame is reserved up front, so the loop below only grows the buffer when the
+    // attachments change (or the clipped output does). No extra pass over the attachments is needed to count it
+    if (size_cache && CheckGeometrySizeCache(*size_cache, skeleton) && vertex_buffer.Remaining() < size_cache->m_VertexCount)
+    {
+        vertex_buffer.OffsetCapacity(size_cache->m_VertexCount - vertex_buffer.Remaining());
+    }
 
     // For each slot in the draw order array of the skeleton
     for (int s = 0; s < skeleton->slotsCount; ++s)
@@ -352,7 +507,7 @@ uint32_t GenerateVertexData(dmArray<SpineVertex>& vertex_buffer, const spSkeleto
             continue;
         }
 
-        uint32_t batch_vindex_start = vindex;
+        uint32_t batch_vindex_start = vertex_buffer.Size();
         const spColor* skeleton_color = &skeleton->color;
         // Calculate the tinting color based on the skeleton's color
         // and the slot's color. Each color channel is given in the
@@ -388,10 +543,12 @@ uint32_t GenerateVertexData(dmArray<SpineVertex>& vertex_buffer, const spSkeleto
             // the rectangular region attachment. This assumes the world transform of the
             // bone to which the slot (and hence attachment) is attached has been calculated
             // before rendering via spSkeleton_updateWorldTransform
+            EnsureArraySize(scratch_vertex_floats, ATTACHMENT_REGION_NUM_FLOATS);
             spRegionAttachment_computeWorldVertices(regionAttachment, slot, scratch_vertex_floats.Begin(), 0, 2);
 
             vertex_count  = ATTACHMENT_REGION_VERTEX_COUNT;
             uvs           = regionAttachment->uvs;
+            page_index    = GetPageIndex(regionAttachment->rendererObject);
             indices       = (uint16_t*) QUAD_INDICES;
             indices_count = ATTACHMENT_REGION_INDEX_COUNT;
             color         = attachment_color;
@@ -408,11 +565,13 @@ uint32_t GenerateVertexData(dmArray<SpineVertex>& vertex_buffer, const spSkeleto
             {
                 continue;
             }
-            
+
+            EnsureArraySize(scratch_vertex_floats, mesh->super.worldVerticesLength);
             spVertexAttachment_computeWorldVertices(SUPER(mesh), slot, 0, mesh->super.worldVerticesLength, scratch_vertex_floats.Begin(), 0, 2);
 
             vertex_count  = SUPER(mesh)->worldVerticesLength / 2;
             uvs           = mesh->uvs;
+            page_index    = GetPageIndex(mesh->rendererObject);
             indices       = mesh->triangles;
             indices_count = mesh->trianglesCount;
             color         = attachment_color;
@@ -447,6 +606,7 @@ uint32_t GenerateVertexData(dmArray<SpineVertex>& vertex_buffer, const spSkeleto
         const float colorB = tintB * color->b * color_tint.getZ();
         const float colorA = tintA * color->a * color_tint.getW();
 
+        uint32_t vindex = EnsureArrayFitsNumberGeometric(vertex_buffer, indices_count);
         for (int i = 0; i < indices_count; ++i)
         {
             int index = indices[i] << 1;
@@ -459,7 +619,7 @@ uint32_t GenerateVertexData(dmArray<SpineVertex>& vertex_buffer, const spSkeleto
             SpineDrawDesc desc = {};
             desc.m_VertexStart = batch_vindex_start;
             desc.m_BlendMode   = (uint32_t) slot->data->blendMode;
-            desc.m_VertexCount = vindex - batch_vindex_start;
+            desc.m_VertexCount = vertex_buffer.Size() - batch_vindex_start;
             draw_descs_out->Push(desc);
         }
         spSkeletonClipping_clipEnd(skeleton_clipper, slot);
@@ -468,17 +628,18 @@ uint32_t GenerateVertexData(dmArray<SpineVertex>& vertex_buffer, const spSkeleto
     spSkeletonClipping_clipEnd2(skeleton_clipper);
 
     uint32_t vcount = vertex_buffer.Size() - vindex_start;
-    if (vcount)
+    if (size_cache)
     {
-        assert(vcount == estimated_vcount);
+        size_cache->m_VertexCount = vcount;
     }
-
     return vcount;
 }
 
-uint32_t GenerateIndexedVertexData(dmArray<SpineVertex>& vertex_buffer, dmArray<uint32_t>& index_buffer, const spSkeleton* skeleton, spSkeletonClipping* skeleton_clipper, const dmVMath::Matrix4& world, const dmVMath::Vector4& color_tint, dmArray<SpineIndexedDrawDesc>* draw_descs_out, dmArray<float>& scratch_vertex_floats)
+template <typename TVertex, typename TIndex>
+static uint32_t GenerateIndexedVertexDataT(dmArray<TVertex>& vertex_buffer, dmArray<TIndex>& index_buffer, const spSkeleton* skeleton, spSkeletonClipping* skeleton_clipper, const dmVMath::Matrix4& world, const dmVMath::Vector4& color_tint, dmArray<SpineIndexedDrawDesc>* draw_descs_out, dmArray<float>& scratch_vertex_floats, const float* world_vertices, dmArray<SpineIndexSegment>* segments_out)
 {
     uint32_t vindex_start = vertex_buffer.Size();
+    assert(!segments_out || (vindex_start & (VERTEX_SEGMENT_SIZE - 1)) == 0);
 
     for (int s = 0; s < skeleton->slotsCount; ++s)
     {
@@ -490,6 +651,13 @@ uint32_t GenerateIndexedVertexData(dmArray<SpineVertex>& vertex_buffer, dmArray<
             continue;
         }
 
+        // The precomputed vertices of this attachment (same layout as GetSkeletonWorldVertices)
+        const float* attachment_world_vertices = world_vertices;
+        if (world_vertices)
+        {
+            world_vertices += GetAttachmentWorldVerticesLength(attachment);
+        }
+
         spColor* slot_color = &slot->color;
         if (!HasRenderableAlpha(slot_color->a) || !slot->bone->active)
         {
@@ -510,6 +678,7 @@ uint32_t GenerateIndexedVertexData(dmArray<SpineVertex>& vertex_buffer, dmArray<
         uint32_t indices_count = 0;
         float* uvs = 0;
         float* vertices = 0;
+        spRegionAttachment* region = 0; // Set if the region is written directly from its bone (see TransformRegionVertices)
         spAttachmentType type = attachment->type;
 
         if (type == SP_ATTACHMENT_REGION)
@@ -521,15 +690,29 @@ uint32_t GenerateIndexedVertexData(dmArray<SpineVertex>& vertex_buffer, dmArray<
                 continue;
             }
 
-            EnsureArraySize(scratch_vertex_floats, ATTACHMENT_REGION_NUM_FLOATS);
-            spRegionAttachment_computeWorldVertices(regionAttachment, slot, scratch_vertex_floats.Begin(), 0, 2);
+            if (attachment_world_vertices)
+            {
+                // Already transformed by the bone, and the sequence applied (see GetSkeletonWorldVertices)
+                vertices = (float*)attachment_world_vertices;
+            }
+            else if (!spSkeletonClipping_isClipping(skeleton_clipper) && !regionAttachment->sequence)
+            {
+                // A sequence is applied by spRegionAttachment_computeWorldVertices, so those take the generic path
+                region = regionAttachment;
+            }
+            else
+            {
+                EnsureArraySize(scratch_vertex_floats, ATTACHMENT_REGION_NUM_FLOATS);
+                spRegionAttachment_computeWorldVertices(regionAttachment, slot, scratch_vertex_floats.Begin(), 0, 2);
+                vertices = scratch_vertex_floats.Begin();
+            }
 
             vertex_count = ATTACHMENT_REGION_VERTEX_COUNT;
             uvs = regionAttachment->uvs;
+            page_index = GetPageIndex(regionAttachment->rendererObject);
             indices = (uint16_t*)QUAD_INDICES;
             indices_count = ATTACHMENT_REGION_INDEX_COUNT;
             color = attachment_color;
-            vertices = scratch_vertex_floats.Begin();
         }
         else if (type == SP_ATTACHMENT_MESH)
         {
@@ -540,15 +723,23 @@ uint32_t GenerateIndexedVertexData(dmArray<SpineVertex>& vertex_buffer, dmArray<
                 continue;
             }
 
-            EnsureArraySize(scratch_vertex_floats, mesh->super.worldVerticesLength);
-            spVertexAttachment_computeWorldVertices(SUPER(mesh), slot, 0, mesh->super.worldVerticesLength, scratch_vertex_floats.Begin(), 0, 2);
+            if (attachment_world_vertices)
+            {
+                vertices = (float*)attachment_world_vertices;
+            }
+            else
+            {
+                EnsureArraySize(scratch_vertex_floats, mesh->super.worldVerticesLength);
+                spVertexAttachment_computeWorldVertices(SUPER(mesh), slot, 0, mesh->super.worldVerticesLength, scratch_vertex_floats.Begin(), 0, 2);
+                vertices = scratch_vertex_floats.Begin();
+            }
 
             vertex_count = SUPER(mesh)->worldVerticesLength / 2;
             uvs = mesh->uvs;
+            page_index = GetPageIndex(mesh->rendererObject);
             indices = mesh->triangles;
             indices_count = mesh->trianglesCount;
             color = attachment_color;
-            vertices = scratch_vertex_floats.Begin();
         }
         else if (type == SP_ATTACHMENT_CLIPPING)
         {
@@ -577,18 +768,51 @@ uint32_t GenerateIndexedVertexData(dmArray<SpineVertex>& vertex_buffer, dmArray<
         const float colorB = tintB * color->b * color_tint.getZ();
         const float colorA = tintA * color->a * color_tint.getW();
 
+        const float vertex_color[4] = { colorR, colorG, colorB, colorA };
+
+        if (segments_out)
+        {
+            uint32_t segment_offset = vertex_buffer.Size() & (VERTEX_SEGMENT_SIZE - 1);
+            if (segment_offset && segment_offset + vertex_count > VERTEX_SEGMENT_SIZE)
+            {
+                EnsureArrayFitsNumberGeometric(vertex_buffer, VERTEX_SEGMENT_SIZE - segment_offset);
+            }
+        }
+
         uint32_t vertex_base = EnsureArrayFitsNumberGeometric(vertex_buffer, vertex_count);
         uint32_t batch_index_start = EnsureArrayFitsNumberGeometric(index_buffer, indices_count);
-        for (uint32_t i = 0; i < vertex_count; ++i)
+        if (segments_out)
         {
-            uint32_t index = i << 1;
-            const dmVMath::Vector4 p = world * dmVMath::Point3(vertices[index], vertices[index + 1], 0.0f);
-            addVertex(&vertex_buffer[vertex_base + i], p.getX(), p.getY(), p.getZ(), uvs[index], uvs[index + 1], colorR, colorG, colorB, colorA, page_index);
+            uint32_t segment = (vertex_base - vindex_start) >> VERTEX_SEGMENT_SHIFT;
+            if (segments_out->Empty() || segments_out->Back().m_Segment != segment)
+            {
+                SpineIndexSegment index_segment = { batch_index_start, 0, segment };
+                EnsureArrayFitsNumberGeometric(*segments_out, 1);
+                segments_out->Back() = index_segment;
+            }
+            segments_out->Back().m_IndexCount += indices_count;
         }
 
-        for (uint32_t i = 0; i < indices_count; ++i)
+        if (region)
         {
-            index_buffer[batch_index_start + i] = vertex_base + indices[i];
+            TransformRegionVertices(vertex_buffer.Begin() + vertex_base, region, slot->bone, world, vertex_color, page_index);
+
+            TIndex* quad = index_buffer.Begin() + batch_index_start;
+            quad[0] = (TIndex)(vertex_base + QUAD_INDICES[0]);
+            quad[1] = (TIndex)(vertex_base + QUAD_INDICES[1]);
+            quad[2] = (TIndex)(vertex_base + QUAD_INDICES[2]);
+            quad[3] = (TIndex)(vertex_base + QUAD_INDICES[3]);
+            quad[4] = (TIndex)(vertex_base + QUAD_INDICES[4]);
+            quad[5] = (TIndex)(vertex_base + QUAD_INDICES[5]);
+        }
+        else
+        {
+            TransformVertices(vertex_buffer.Begin() + vertex_base, vertices, uvs, vertex_count, world, vertex_color, page_index);
+
+            for (uint32_t i = 0; i < indices_count; ++i)
+            {
+                index_buffer[batch_index_start + i] = (TIndex)(vertex_base + indices[i]);
+            }
         }
 
         if (draw_descs_out)
@@ -608,6 +832,260 @@ uint32_t GenerateIndexedVertexData(dmArray<SpineVertex>& vertex_buffer, dmArray<
     return vertex_buffer.Size() - vindex_start;
 }
 
+uint32_t GenerateIndexedVertexData(dmArray<SpineVertex>& vertex_buffer, dmArray<uint32_t>& index_buffer, const spSkeleton* skeleton, spSkeletonClipping* skeleton_clipper, const dmVMath::Matrix4& world, const dmVMath::Vector4& color_tint, dmArray<SpineIndexedDrawDesc>* draw_descs_out, dmArray<float>& scratch_vertex_floats, const float* world_vertices)
+{
+    return GenerateIndexedVertexDataT(vertex_buffer, index_buffer, skeleton, skeleton_clipper, world, color_tint, draw_descs_out, scratch_vertex_floats, world_vertices, 0);
+}
+
+uint32_t GenerateIndexedVertexData(dmArray<SpineVertex>& vertex_buffer, dmArray<uint16_t>& index_buffer, const spSkeleton* skeleton, spSkeletonClipping* skeleton_clipper, const dmVMath::Matrix4& world, const dmVMath::Vector4& color_tint, dmArray<SpineIndexedDrawDesc>* draw_descs_out, dmArray<float>& scratch_vertex_floats, const float* world_vertices)
+{
+    return GenerateIndexedVertexDataT(vertex_buffer, index_buffer, skeleton, skeleton_clipper, world, color_tint, draw_descs_out, scratch_vertex_floats, world_vertices, 0);
+}
+
+uint32_t GenerateIndexedVertexData(dmArray<SpineSkinnedVertex>& vertex_buffer, dmArray<uint16_t>& index_buffer, const spSkeleton* skeleton, spSkeletonClipping* skeleton_clipper, const dmVMath::Matrix4& world, const dmVMath::Vector4& color_tint, dmArray<SpineIndexedDrawDesc>* draw_descs_out, dmArray<float>& scratch_vertex_floats, const float* world_vertices)
+{
+    return GenerateIndexedVertexDataT(vertex_buffer, index_buffer, skeleton, skeleton_clipper, world, color_tint, draw_descs_out, scratch_vertex_floats, world_vertices, 0);
+}
+
+uint32_t GenerateIndexedVertexData(dmArray<SpineCompactVertex>& vertex_buffer, dmArray<uint16_t>& index_buffer, const spSkeleton* skeleton, spSkeletonClipping* skeleton_clipper, const dmVMath::Matrix4& world, const dmVMath::Vector4& color_tint, dmArray<SpineIndexedDrawDesc>* draw_descs_out, dmArray<float>& scratch_vertex_floats, const float* world_vertices)
+{
+    return GenerateIndexedVertexDataT(vertex_buffer, index_buffer, skeleton, skeleton_clipper, world, color_tint, draw_descs_out, scratch_vertex_floats, world_vertices, 0);
+}
+
+uint32_t GenerateSegmentedVertexData(dmArray<SpineVertex>& vertex_buffer, dmArray<uint16_t>& index_buffer, const spSkeleton* skeleton, spSkeletonClipping* skeleton_clipper, const dmVMath::Matrix4& world, const dmVMath::Vector4& color_tint, dmArray<SpineIndexedDrawDesc>* draw_descs_out, dmArray<float>& scratch_vertex_floats, const float* world_vertices, dmArray<SpineIndexSegment>& out_segments)
+{
+    return GenerateIndexedVertexDataT(vertex_buffer, index_buffer, skeleton, skeleton_clipper, world, color_tint, draw_descs_out, scratch_vertex_floats, world_vertices, &out_segments);
+}
+
+uint32_t GenerateSegmentedVertexData(dmArray<SpineCompactVertex>& vertex_buffer, dmArray<uint16_t>& index_buffer, const spSkeleton* skeleton, spSkeletonClipping* skeleton_clipper, const dmVMath::Matrix4& world, const dmVMath::Vector4& color_tint, dmArray<SpineIndexedDrawDesc>* draw_descs_out, dmArray<float>& scratch_vertex_floats, const float* world_vertices, dmArray<SpineIndexSegment>& out_segments)
+{
+    return GenerateIndexedVertexDataT(vertex_buffer, index_buffer, skeleton, skeleton_clipper, world, color_tint, draw_descs_out, scratch_vertex_floats, world_vertices, &out_segments);
+}
+
+void TransformVerticesScalar(SpineVertex* out, const float* positions, const float* uvs, uint32_t count, const dmVMath::Matrix4& world, const float color[4], float page_index)
+{
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        uint32_t index = i << 1;
+        const dmVMath::Vector4 p = world * dmVMath::Point3(positions[index], positions[index + 1], 0.0f);
+        addVertex(&out[i], p.getX(), p.getY(), p.getZ(), uvs[index], uvs[index + 1], color[0], color[1], color[2], color[3], page_index);
+    }
+}
+
+#if defined(SPINE_VERTICES_SSE2) || defined(SPINE_VERTICES_NEON)
+
+void TransformVertices(SpineVertex* out, const float* positions, const float* uvs, uint32_t count, const dmVMath::Matrix4& world, const float color[4], float page_index)
+{
+    // The block stores below depend on the exact layout
+    static_assert(sizeof(SpineVertex) == 10 * sizeof(float), "Unexpected SpineVertex layout");
+
+    const dmVMath::Vector4 c0 = world.getCol(0);
+    const dmVMath::Vector4 c1 = world.getCol(1);
+    const dmVMath::Vector4 c3 = world.getCol(3);
+    const float r = color[0], g = color[1], b = color[2], a = color[3];
+
+    // Since z is always 0, and the transform is affine, each output is a 2x2 multiply and an add.
+    // Four vertices (40 floats) are written as 10 blocks of 4 floats
+    uint32_t i = 0;
+#if defined(SPINE_VERTICES_SSE2)
+    const __m128 m00 = _mm_set1_ps(c0.getX()), m01 = _mm_set1_ps(c1.getX()), t0 = _mm_set1_ps(c3.getX());
+    const __m128 m10 = _mm_set1_ps(c0.getY()), m11 = _mm_set1_ps(c1.getY()), t1 = _mm_set1_ps(c3.getY());
+    const __m128 m20 = _mm_set1_ps(c0.getZ()), m21 = _mm_set1_ps(c1.getZ()), t2 = _mm_set1_ps(c3.getZ());
+
+    const __m128 rgba = _mm_setr_ps(r, g, b, a);
+    const __m128 rrgb = _mm_setr_ps(r, r, g, b);
+    const __m128 gbap = _mm_setr_ps(g, b, a, page_index);
+    const __m128 ap   = _mm_setr_ps(a, page_index, 0.0f, 0.0f);
+
+    for (; i + 4 <= count; i += 4)
+    {
+        const float* p = positions + i * 2;
+        const float* uv = uvs + i * 2;
+        float* dst = (float*)(out + i);
+
+        __m128 p01 = _mm_loadu_ps(p);       // x0 y0 x1 y1
+        __m128 p23 = _mm_loadu_ps(p + 4);   // x2 y2 x3 y3
+        __m128 xs  = _mm_shuffle_ps(p01, p23, _MM_SHUFFLE(2, 0, 2, 0));
+        __m128 ys  = _mm_shuffle_ps(p01, p23, _MM_SHUFFLE(3, 1, 3, 1));
+        __m128 x   = _mm_add_ps(_mm_add_ps(_mm_mul_ps(xs, m00), _mm_mul_ps(ys, m01)), t0);
+        __m128 y   = _mm_add_ps(_mm_add_ps(_mm_mul_ps(xs, m10), _mm_mul_ps(ys, m11)), t1);
+        __m128 z   = _mm_add_ps(_mm_add_ps(_mm_mul_ps(xs, m20), _mm_mul_ps(ys, m21)), t2);
+        __m128 z23 = _mm_movehl_ps(z, z);   // z2 z3 z2 z3
+
+        __m128 uv01 = _mm_loadu_ps(uv);     // u0 v0 u1 v1
+        __m128 uv23 = _mm_loadu_ps(uv + 4); // u2 v2 u3 v3
+        __m128 xy01 = _mm_unpacklo_ps(x, y);
+        __m128 xy23 = _mm_unpackhi_ps(x, y);
+
+        // x0 y0 z0 u0 | v0 r g b | a pg x1 y1 | z1 u1 v1 r | g b a pg
+        _mm_storeu_ps(dst +  0, _mm_movelh_ps(xy01, _mm_unpacklo_ps(z, uv01)));
+        _mm_storeu_ps(dst +  4, _mm_move_ss(rrgb, _mm_shuffle_ps(uv01, uv01, _MM_SHUFFLE(1, 1, 1, 1))));
+        _mm_storeu_ps(dst +  8, _mm_shuffle_ps(ap, xy01, _MM_SHUFFLE(3, 2, 1, 0)));
+        _mm_storeu_ps(dst + 12, _mm_shuffle_ps(_mm_shuffle_ps(z, uv01, _MM_SHUFFLE(2, 2, 1, 1)), _mm_shuffle_ps(uv01, rgba, _MM_SHUFFLE(0, 0, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0)));
+        _mm_storeu_ps(dst + 16, gbap);
+        // x2 y2 z2 u2 | v2 r g b | a pg x3 y3 | z3 u3 v3 r | g b a pg
+        _mm_storeu_ps(dst + 20, _mm_movelh_ps(xy23, _mm_unpacklo_ps(z23, uv23)));
+        _mm_storeu_ps(dst + 24, _mm_move_ss(rrgb, _mm_shuffle_ps(uv23, uv23, _MM_SHUFFLE(1, 1, 1, 1))));
+        _mm_storeu_ps(dst + 28, _mm_shuffle_ps(ap, xy23, _MM_SHUFFLE(3, 2, 1, 0)));
+        _mm_storeu_ps(dst + 32, _mm_shuffle_ps(_mm_shuffle_ps(z23, uv23, _MM_SHUFFLE(2, 2, 1, 1)), _mm_shuffle_ps(uv23, rgba, _MM_SHUFFLE(0, 0, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0)));
+        _mm_storeu_ps(dst + 36, gbap);
+    }
+#else
+    const float32x4_t m00 = vdupq_n_f32(c0.getX()), m01 = vdupq_n_f32(c1.getX()), t0 = vdupq_n_f32(c3.getX());
+    const float32x4_t m10 = vdupq_n_f32(c0.getY()), m11 = vdupq_n_f32(c1.getY()), t1 = vdupq_n_f32(c3.getY());
+    const float32x4_t m20 = vdupq_n_f32(c0.getZ()), m21 = vdupq_n_f32(c1.getZ()), t2 = vdupq_n_f32(c3.getZ());
+
+    float x[4], y[4], z[4];
+    for (; i + 4 <= count; i += 4)
+    {
+        const float* uv = uvs + i * 2;
+        float* dst = (float*)(out + i);
+
+        float32x4x2_t xy = vld2q_f32(positions + i * 2); // deinterleaves the x and y
+        vst1q_f32(x, vmlaq_f32(vmlaq_f32(t0, xy.val[0], m00), xy.val[1], m01));
+        vst1q_f32(y, vmlaq_f32(vmlaq_f32(t1, xy.val[0], m10), xy.val[1], m11));
+        vst1q_f32(z, vmlaq_f32(vmlaq_f32(t2, xy.val[0], m20), xy.val[1], m21));
+
+        const float blocks[40] = {
+            x[0], y[0], z[0], uv[0], uv[1], r, g, b, a, page_index,
+            x[1], y[1], z[1], uv[2], uv[3], r, g, b, a, page_index,
+            x[2], y[2], z[2], uv[4], uv[5], r, g, b, a, page_index,
+            x[3], y[3], z[3], uv[6], uv[7], r, g, b, a, page_index,
+        };
+        for (uint32_t k = 0; k < 40; k += 4)
+        {
+            vst1q_f32(dst + k, vld1q_f32(blocks + k));
+        }
+    }
+#endif
+
+    TransformVerticesScalar(out + i, positions + i * 2, uvs + i * 2, count - i, world, color, page_index);
+}
+
+#else
+
+void TransformVertices(SpineVertex* out, const float* positions, const float* uvs, uint32_t count, const dmVMath::Matrix4& world, const float color[4], float page_index)
+{
+    TransformVerticesScalar(out, positions, uvs, count, world, color, page_index);
+}
+
+#endif
+
+static inline uint16_t PackUnorm16(float value)
+{
+    return (uint16_t)(dmMath::Clamp(value, 0.0f, 1.0f) * 65535.0f + 0.5f);
+}
+
+static inline uint8_t PackUnorm8(float value)
+{
+    return (uint8_t)(dmMath::Clamp(value, 0.0f, 1.0f) * 255.0f + 0.5f);
+}
+
+void TransformVertices(SpineCompactVertex* out, const float* positions, const float* uvs, uint32_t count, const dmVMath::Matrix4& world, const float color[4], float page_index)
+{
+    (void)page_index;
+
+    const dmVMath::Vector4 c0 = world.getCol(0);
+    const dmVMath::Vector4 c1 = world.getCol(1);
+    const dmVMath::Vector4 c3 = world.getCol(3);
+    const float m00 = c0.getX(), m01 = c1.getX(), t0 = c3.getX();
+    const float m10 = c0.getY(), m11 = c1.getY(), t1 = c3.getY();
+    const float m20 = c0.getZ(), m21 = c1.getZ(), t2 = c3.getZ();
+
+    const uint8_t r = PackUnorm8(color[0]);
+    const uint8_t g = PackUnorm8(color[1]);
+    const uint8_t b = PackUnorm8(color[2]);
+    const uint8_t a = PackUnorm8(color[3]);
+
+    // z is always 0, and the transform is affine
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        const float x = positions[i * 2];
+        const float y = positions[i * 2 + 1];
+        SpineCompactVertex* vertex = &out[i];
+        vertex->x = m00 * x + m01 * y + t0;
+        vertex->y = m10 * x + m11 * y + t1;
+        vertex->z = m20 * x + m21 * y + t2;
+        vertex->u = PackUnorm16(uvs[i * 2]);
+        vertex->v = PackUnorm16(uvs[i * 2 + 1]);
+        vertex->r = r;
+        vertex->g = g;
+        vertex->b = b;
+        vertex->a = a;
+    }
+}
+
+void TransformVertices(SpineSkinnedVertex* out, const float* positions, const float* uvs, uint32_t count, const dmVMath::Matrix4& world, const float color[4], float page_index)
+{
+    (void)page_index;
+
+    const dmVMath::Vector4 c0 = world.getCol(0);
+    const dmVMath::Vector4 c1 = world.getCol(1);
+    const dmVMath::Vector4 c3 = world.getCol(3);
+    const float m00 = c0.getX(), m01 = c1.getX(), t0 = c3.getX();
+    const float m10 = c0.getY(), m11 = c1.getY(), t1 = c3.getY();
+
+    const uint8_t r = PackUnorm8(color[0]);
+    const uint8_t g = PackUnorm8(color[1]);
+    const uint8_t b = PackUnorm8(color[2]);
+    const uint8_t a = PackUnorm8(color[3]);
+
+    // The skinning shader applies the model transform, so only the 2D part is used
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        const float x = positions[i * 2];
+        const float y = positions[i * 2 + 1];
+        SpineSkinnedVertex* vertex = &out[i];
+        memset(vertex, 0, sizeof(SpineSkinnedVertex));
+        vertex->positions[0] = m00 * x + m01 * y + t0;
+        vertex->positions[1] = m10 * x + m11 * y + t1;
+        vertex->weights[0] = 1.0f;
+        vertex->u = uvs[i * 2];
+        vertex->v = uvs[i * 2 + 1];
+        vertex->r = r;
+        vertex->g = g;
+        vertex->b = b;
+        vertex->a = a;
+    }
+}
+
+template <typename TVertex>
+static void TransformRegionVerticesT(TVertex* out, const spRegionAttachment* attachment, const spBone* bone, const dmVMath::Matrix4& world, const float color[4], float page_index)
+{
+    // The bone maps the offsets to skeleton space as x' = a*x + b*y + worldX, y' = c*x + d*y + worldY
+    const dmVMath::Vector4 c0 = world.getCol(0);
+    const dmVMath::Vector4 c1 = world.getCol(1);
+    dmVMath::Matrix4 transform = world;
+    transform.setCol(0, c0 * bone->a + c1 * bone->c);
+    transform.setCol(1, c0 * bone->b + c1 * bone->d);
+    transform.setCol(3, c0 * bone->worldX + c1 * bone->worldY + world.getCol(3));
+
+    // In the order written by spRegionAttachment_computeWorldVertices(), which the uvs follow
+    const float* offset = attachment->offset;
+    const float positions[ATTACHMENT_REGION_NUM_FLOATS] = {
+        offset[6], offset[7],   // br
+        offset[0], offset[1],   // bl
+        offset[2], offset[3],   // ul
+        offset[4], offset[5],   // ur
+    };
+    TransformVertices(out, positions, attachment->uvs, ATTACHMENT_REGION_VERTEX_COUNT, transform, color, page_index);
+}
+
+void TransformRegionVertices(SpineVertex* out, const spRegionAttachment* attachment, const spBone* bone, const dmVMath::Matrix4& world, const float color[4], float page_index)
+{
+    TransformRegionVerticesT(out, attachment, bone, world, color, page_index);
+}
+
+void TransformRegionVertices(SpineCompactVertex* out, const spRegionAttachment* attachment, const spBone* bone, const dmVMath::Matrix4& world, const float color[4], float page_index)
+{
+    TransformRegionVerticesT(out, attachment, bone, world, color, page_index);
+}
+
+void TransformRegionVertices(SpineSkinnedVertex* out, const spRegionAttachment* attachment, const spBone* bone, const dmVMath::Matrix4& world, const float color[4], float page_index)
+{
+    TransformRegionVerticesT(out, attachment, bone, world, color, page_index);
+}
+
 void MergeDrawDescs(const dmArray<SpineDrawDesc>& src, dmArray<SpineDrawDesc>& dst)
 {
     dst.SetCapacity(src.Size());
@@ -45,6 +45,7 @@
            [com.jogamp.opengl GL GL2]
            [editor.gl.shader ShaderLifecycle]
            [editor.types AABB]
+           [com.google.protobuf ByteString]
            [java.io IOException]
            [java.nio ByteBuffer ByteOrder]
            [javax.vecmath Matrix4d Vector3d]
@@ -59,6 +60,7 @@
 (def spine-material-path "/defold-spine/assets/spine.material")
 
 (def spine-json-ext "spinejson")
+(def spine-skel-ext "spineskel") ; The binary skeleton format
 (def spine-scene-ext "spinescene")
 (def spine-model-ext "spinemodel")
 
@@ -79,6 +81,11 @@
 (def spine-plugin-pointer-cls (workspace/load-class! "com.dynamo.bob.pipeline.Spine$SpinePointer"))
 (def spine-plugin-aabb-cls (workspace/load-class! "com.dynamo.bob.pipeline.Spine$AABB"))
 (def spine-plugin-blendmode-cls (workspace/load-class! "com.dynamo.spine.proto.Spine$SpineModelDesc$BlendMode"))
+(def spine-plugin-culledupdate-cls (workspace/load-class! "com.dynamo.spine.proto.Spine$SpineModelDesc$CulledUpdate"))
+(def spine-plugin-vertexformat-cls (workspace/load-class! "com.dynamo.spine.proto.Spine$SpineModelDesc$VertexFormat"))
+(def spine-plugin-skinning-cls (workspace/load-class! "com.dynamo.spine.proto.Spine$SpineModelDesc$Skinning"))
+(def spine-plugin-draworder-cls (workspace/load-class! "com.dynamo.spine.proto.Spine$SpineModelDesc$DrawOrder"))
+(def spine-plugin-cullingbounds-cls (workspace/load-class! "com.dynamo.spine.proto.Spine$SpineModelDesc$CullingBounds"))
 (def spine-plugin-spinescene-cls (workspace/load-class! "com.dynamo.spine.proto.Spine$SpineSceneDesc"))
 (def spine-plugin-spinemodel-cls (workspace/load-class! "com.dynamo.spine.proto.Spine$SpineModelDesc"))
 
@@ -155,6 +162,12 @@
 (defn- plugin-get-draw-descs [handle]
   (plugin-invoke-static spine-plugin-cls "SPINE_GetDrawDescs" (into-array Class [spine-plugin-pointer-cls]) [handle]))
 
+(defn- plugin-bake-animations [handle animations sample-rate]
+  (plugin-invoke-static spine-plugin-cls "SPINE_BakeAnimations" (into-array Class [spine-plugin-pointer-cls string-array-cls Float/TYPE]) [handle (into-array String animations) (float sample-rate)]))
+
+(defn- plugin-get-animation-bounds [handle]
+  (plugin-invoke-static spine-plugin-cls "SPINE_GetAnimationBounds" (into-array Class [spine-plugin-pointer-cls]) [handle]))
+
 
 (set! *warn-on-reflection* false)
 
@@ -181,8 +194,8 @@
 
 (defn- is-spine-scene-json-name? [resource prop-name]
   (let [path (resource/resource->proj-path resource)]
-    (when (not (str/ends-with? path spine-json-ext))
-      (format "%s file '%s' doesn't end with '.%s'" prop-name path spine-json-ext))))
+    (when (not (or (str/ends-with? path spine-json-ext) (str/ends-with? path spine-skel-ext)))
+      (format "%s file '%s' doesn't end with '.%s' or '.%s'" prop-name path spine-json-ext spine-skel-ext))))
 
 (defn- validate-scene-spine-json [_node-id spine-json]
   (or (prop-resource-error :fatal _node-id :spine-json spine-json "Spine Json")
@@ -212,10 +225,24 @@
 ;;         (get spine-scene "bones")))
 
 
-(g/defnk produce-spine-scene-pb [_node-id spine-json atlas]
+(g/defnk produce-spine-scene-pb [_node-id spine-json atlas baked-animations bake-sample-rate]
   (protobuf/make-map-without-defaults spine-plugin-spinescene-cls
     :spine-json (resource/resource->proj-path spine-json)
-    :atlas (resource/resource->proj-path atlas)))
+    :atlas (resource/resource->proj-path atlas)
+    :baked-animations baked-animations
+    :bake-sample-rate bake-sample-rate))
+
+(defn- parse-baked-animations [baked-animations]
+  (into [] (comp (map str/trim) (remove str/blank?)) (str/split (or baked-animations "") #",")))
+
+(defn- validate-scene-baked-animations [_node-id baked-animations animations]
+  (when animations
+    (validation/prop-error :fatal _node-id :baked-animations
+                           (fn [names valid-names]
+                             (when-let [missing (seq (remove #(or (= "*" %) (contains? valid-names %)) names))]
+                               (format "animations could not be found in the spine json: %s" (str/join ", " missing))))
+                           (parse-baked-animations baked-animations)
+                           (set animations))))
 
 ;; (defn- transform-positions [^Matrix4d transform mesh]
 ;;   (let [p (Point3d.)]
@@ -498,7 +525,7 @@
       :else
       (g/->error node-id :resource :fatal resource (format "Couldn't read %s file %s: %s" spine-json-ext path msg)))))
 
-; Loads the .spinejson file
+; Loads the .spinejson (or binary .spineskel) file
 (defn- load-spine-json
   ([node-id resource]
    (load-spine-json nil node-id resource))
@@ -583,7 +610,9 @@
       (g/set-property self :material default-material-resource)
       (gu/set-properties-from-pb-map self spine-plugin-spinescene-cls spine-scene-desc
         spine-json (resolve-resource :spine-json)
-        atlas (resolve-resource :atlas)))))
+        atlas (resolve-resource :atlas)
+        baked-animations :baked-animations
+        bake-sample-rate :bake-sample-rate))))
 
 ;; (defn- make-spine-skeleton-scene [_node-id aabb gpu-texture scene-structure]
 ;;   (let [scene {:node-id _node-id :aabb aabb}]
@@ -604,15 +633,19 @@
                                  (make-spine-outline-scene _node-id aabb)])
     {:node-id _node-id :aabb aabb}))
 
-(g/defnk produce-spine-scene-save-value [spine-json-resource atlas-resource]
-  {:spine-json (resource/resource->proj-path spine-json-resource)
-   :atlas (resource/resource->proj-path atlas-resource)})
+(g/defnk produce-spine-scene-save-value [spine-json-resource atlas-resource baked-animations bake-sample-rate]
+  (protobuf/make-map-without-defaults spine-plugin-spinescene-cls
+    :spine-json (resource/resource->proj-path spine-json-resource)
+    :atlas (resource/resource->proj-path atlas-resource)
+    :baked-animations baked-animations
+    :bake-sample-rate bake-sample-rate))
 
 
-(g/defnk produce-spine-scene-own-build-errors [_node-id atlas spine-json texture-set-pb spine-json-content]
+(g/defnk produce-spine-scene-own-build-errors [_node-id atlas spine-json texture-set-pb spine-json-content baked-animations animations]
   (g/package-errors _node-id
                     (validate-scene-atlas _node-id atlas)
                     (validate-scene-spine-json _node-id spine-json)
+                    (validate-scene-baked-animations _node-id baked-animations animations)
                     (when (and texture-set-pb spine-json-content)
                       (try
                         (plugin-load-file-from-buffer
@@ -622,25 +655,51 @@
                         (catch Exception error
                           (handle-read-error error _node-id spine-json))))))
 
+; Samples the bone timelines into the format read by the runtime (see spine_baked.h)
+(defn- bake-spine-animations [{:keys [spine-json-content spine-json-path animations sample-rate]}]
+  (let [spine-data-handle (plugin-load-file-from-buffer spine-json-content spine-json-path)]
+    (ByteString/copyFrom ^bytes (plugin-bake-animations spine-data-handle animations sample-rate))))
+
+; The bounds of the setup pose and of each animation, for the models culled using them (see res_spine_scene.cpp)
+(defn- calculate-animation-bounds [{:keys [spine-json-content spine-json-path texture-set-pb atlas-path]}]
+  (let [spine-data-handle (plugin-load-file-from-buffer spine-json-content spine-json-path texture-set-pb atlas-path)]
+    (vec (plugin-get-animation-bounds spine-data-handle))))
+
 (defn- build-spine-scene [resource dep-resources user-data]
   (let [pb (:proto-msg user-data)
-        pb (reduce #(assoc %1 (first %2) (second %2)) pb (map (fn [[label res]] [label (resource/proj-path (get dep-resources res))]) (:dep-resources user-data)))]
+        pb (reduce #(assoc %1 (first %2) (second %2)) pb (map (fn [[label res]] [label (resource/proj-path (get dep-resources res))]) (:dep-resources user-data)))
+        pb (if-let [bake (:bake user-data)]
+             (assoc pb :baked-animation-data (bake-spine-animations bake))
+             pb)
+        pb (assoc pb :animation-bounds (calculate-animation-bounds (:bounds user-data)))]
     {:resource resource :content (protobuf/map->bytes spine-plugin-spinescene-cls pb)}))
 
 
 (g/defnk produce-spine-scene-build-targets
-  [_node-id own-build-errors resource spine-json-resource atlas-resource spine-scene-pb dep-build-targets]
+  [_node-id own-build-errors resource spine-json-resource atlas-resource spine-scene-pb dep-build-targets spine-json-content texture-set-pb baked-animations bake-sample-rate]
   (g/precluding-errors own-build-errors
     (let [dep-build-targets (flatten dep-build-targets)
           deps-by-source (into {} (map #(let [res (:resource %)] [(:resource res) res]) dep-build-targets))
-          dep-resources (map (fn [[label resource]] [label (get deps-by-source resource)]) [[:spine-json spine-json-resource] [:atlas atlas-resource]])]
+          dep-resources (map (fn [[label resource]] [label (get deps-by-source resource)]) [[:spine-json spine-json-resource] [:atlas atlas-resource]])
+          animations (parse-baked-animations baked-animations)
+          bake (when (seq animations)
+                 {:spine-json-content spine-json-content
+                  :spine-json-path (resource/resource->proj-path spine-json-resource)
+                  :animations animations
+                  :sample-rate bake-sample-rate})
+          bounds {:spine-json-content spine-json-content
+                  :spine-json-path (resource/resource->proj-path spine-json-resource)
+                  :texture-set-pb texture-set-pb
+                  :atlas-path (resource/resource->proj-path atlas-resource)}]
 
       [(bt/with-content-hash
          {:node-id _node-id
           :resource (workspace/make-build-resource resource)
           :build-fn build-spine-scene
           :user-data {:proto-msg spine-scene-pb
-                      :dep-resources dep-resources}
+                      :dep-resources dep-resources
+                      :bake bake
+                      :bounds bounds}
 
           :deps dep-build-targets})])))
 
@@ -658,7 +717,7 @@
                                             [:bones :bones]
                                             [:node-outline :source-outline]
                                             [:build-targets :dep-build-targets])))
-            (dynamic edit-type (g/constantly {:type resource/Resource :ext spine-json-ext}))
+            (dynamic edit-type (g/constantly {:type resource/Resource :ext [spine-json-ext spine-skel-ext]}))
             (dynamic error (g/fnk [_node-id spine-json]
                              (validate-scene-spine-json _node-id spine-json))))
 
@@ -674,6 +733,12 @@
             (dynamic error (g/fnk [_node-id atlas]
                              (validate-scene-atlas _node-id atlas))))
 
+  (property baked-animations g/Str (default "")
+            (dynamic error (g/fnk [_node-id baked-animations animations]
+                             (validate-scene-baked-animations _node-id baked-animations animations))))
+  (property bake-sample-rate g/Num (default (float 30.0))
+            (dynamic edit-type (g/constantly {:type g/Num :min 1.0})))
+
   ; This property isn't visible, but here to allow us to preview the .spinescene
   (property material resource/Resource
             (value (gu/passthrough material-resource))
@@ -727,7 +792,7 @@
 
 ;;//////////////////////////////////////////////////////////////////////////////////////////////
 
-(g/defnk produce-model-pb [spine-scene-resource blend-mode default-animation skin material-resource create-go-bones playback-rate offset]
+(g/defnk produce-model-pb [spine-scene-resource blend-mode default-animation skin material-resource create-go-bones playback-rate offset pose-cache-step culled-update lod-threshold-1 lod-threshold-2 lod-disable-constraints vertex-format skinning draw-order culling-bounds]
   (protobuf/make-map-without-defaults spine-plugin-spinemodel-cls
     :spine-scene (resource/resource->proj-path spine-scene-resource)
     :default-animation default-animation
@@ -736,7 +801,16 @@
     :blend-mode blend-mode
     :create-go-bones create-go-bones
     :playback-rate playback-rate
-    :offset offset))
+    :offset offset
+    :pose-cache-step pose-cache-step
+    :culled-update culled-update
+    :lod-threshold-1 lod-threshold-1
+    :lod-threshold-2 lod-threshold-2
+    :lod-disable-constraints lod-disable-constraints
+    :vertex-format vertex-format
+    :skinning skinning
+    :draw-order draw-order
+    :culling-bounds culling-bounds))
 
 (defn ->skin-choicebox [spine-skins]
   (properties/->choicebox (cons "" (remove (partial = "default") spine-skins))))
@@ -808,7 +882,16 @@
         material (resolve-resource (:material :or spine-material-path))
         create-go-bones :create-go-bones
         playback-rate :playback-rate
-        offset :offset))))
+        offset :offset
+        pose-cache-step :pose-cache-step
+        culled-update :culled-update
+        lod-threshold-1 :lod-threshold-1
+        lod-threshold-2 :lod-threshold-2
+        lod-disable-constraints :lod-disable-constraints
+        vertex-format :vertex-format
+        skinning :skinning
+        draw-order :draw-order
+        culling-bounds :culling-bounds))))
 
 (defn- step-animation
   [state dt spine-data-handle animation skin]
@@ -875,6 +958,21 @@
                                               :min 0.0
                                               :max 1.0
                                               :precision 0.01})))
+  (property pose-cache-step g/Num (default (float 0.0))
+            (dynamic edit-type (g/constantly {:type g/Num :min 0.0})))
+  (property culled-update g/Any (default :culled-update-always)
+            (dynamic edit-type (g/constantly (properties/->pb-choicebox spine-plugin-culledupdate-cls))))
+  (property lod-threshold-1 g/Num (default (float 0.0)))
+  (property lod-threshold-2 g/Num (default (float 0.0)))
+  (property lod-disable-constraints g/Bool (default false))
+  (property vertex-format g/Any (default :vertex-format-default)
+            (dynamic edit-type (g/constantly (properties/->pb-choicebox spine-plugin-vertexformat-cls))))
+  (property skinning g/Any (default :skinning-cpu)
+            (dynamic edit-type (g/constantly (properties/->pb-choicebox spine-plugin-skinning-cls))))
+  (property draw-order g/Any (default :draw-order-slots)
+            (dynamic edit-type (g/constantly (properties/->pb-choicebox spine-plugin-draworder-cls))))
+  (property culling-bounds g/Any (default :culling-bounds-pose)
+            (dynamic edit-type (g/constantly (properties/->pb-choicebox spine-plugin-cullingbounds-cls))))
 
   (input spine-json-resource resource/Resource)
   (input atlas-resource resource/Resource)
@@ -975,6 +1073,12 @@
       :textual? true
       :load-fn load-spine-json
       :icon spine-json-icon
+      :view-types [:default])
+    (workspace/register-resource-type workspace
+      :ext spine-skel-ext
+      :node-type SpineSceneJson
+      :load-fn load-spine-json
+      :icon spine-json-icon
       :view-types [:default])))
 
 ; The plugin
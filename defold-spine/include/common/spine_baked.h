@@ -0,0 +1,90 @@
+#ifndef DM_SPINE_BAKED_H
+#define DM_SPINE_BAKED_H
+
+#include <stdint.h>
+#include <dmsdk/dlib/array.h>
+
+struct spSkeleton;
+struct spSkeletonData;
+
+namespace dmSpine
+{
+    // Baked animations store the bone timelines of an animation as local bone transforms,
+    // sampled at a fixed rate. All other timelines (slots, constraints, events etc) are still
+    // applied from the skeleton data at runtime.
+    //
+    // Layout of the blob:
+    //  BakedAnimationsHeader
+    //  BakedAnimation[m_AnimationCount]
+    //  per animation: BakedBone[m_BoneCount], float[m_FrameCount * m_ChannelCount]
+
+    static const uint32_t BAKED_ANIMATIONS_MAGIC = 0x4B425053; // "SPBK"
+    static const uint32_t BAKED_ANIMATIONS_VERSION = 1;
+
+    enum BakedChannel
+    {
+        BAKED_CHANNEL_X         = 1 << 0,
+        BAKED_CHANNEL_Y         = 1 << 1,
+        BAKED_CHANNEL_ROTATION  = 1 << 2,
+        BAKED_CHANNEL_SCALE_X   = 1 << 3,
+        BAKED_CHANNEL_SCALE_Y   = 1 << 4,
+        BAKED_CHANNEL_SHEAR_X   = 1 << 5,
+        BAKED_CHANNEL_SHEAR_Y   = 1 << 6,
+    };
+
+    struct BakedAnimationsHeader
+    {
+        uint32_t m_Magic;
+        uint32_t m_Version;
+        uint32_t m_BoneCount;       // Must match the skeleton data
+        uint32_t m_AnimationCount;
+    };
+
+    struct BakedAnimation
+    {
+        uint64_t m_NameHash;
+        float    m_SampleRate;      // Frames per second. The last frame is at the end of the animation
+        float    m_Duration;
+        uint32_t m_FrameCount;
+        uint32_t m_BoneCount;       // Number of animated bones
+        uint32_t m_ChannelCount;    // Number of floats per frame
+        uint32_t m_BonesOffset;     // Offset from the start of the blob
+        uint32_t m_FramesOffset;    // Offset from the start of the blob
+        uint32_t m_Padding;
+    };
+
+    struct BakedBone
+    {
+        uint16_t m_BoneIndex;
+        uint8_t  m_Channels;        // BakedChannel mask, the floats are stored in enum order
+        uint8_t  m_Padding;
+    };
+
+    // Build time statistics for one baked animation
+    struct BakedAnimationInfo
+    {
+        const char* m_Name;
+        uint32_t    m_FrameCount;
+        uint32_t    m_BoneCount;
+        uint32_t    m_ChannelCount;
+        uint32_t    m_DataSize;         // Bytes used in the blob
+        uint32_t    m_BakedTimelines;   // Number of timelines replaced by the baked data
+        uint32_t    m_TotalTimelines;
+        uint32_t    m_BakedKeys;        // Number of keys in the replaced timelines
+    };
+
+    // Samples the named animations into a blob. Animations without bone timelines are reported, but not stored.
+    // Returns false if an animation couldn't be found
+    bool BakeAnimations(spSkeletonData* skeleton_data, const char** names, uint32_t names_count, float sample_rate,
+                        dmArray<uint8_t>& out_data, dmArray<BakedAnimationInfo>& out_info);
+
+    // Returns 0 if the blob is invalid or doesn't match the skeleton data
+    const BakedAnimationsHeader* GetBakedAnimations(const void* data, uint32_t data_size, const spSkeletonData* skeleton_data);
+    const BakedAnimation*        GetBakedAnimation(const BakedAnimationsHeader* header, uint32_t index);
+
+    // Writes the interpolated local transforms of the animated bones
+    void ApplyBakedAnimation(const BakedAnimationsHeader* header, const BakedAnimation* animation, spSkeleton* skeleton, float time);
+
+} // namespace
+
+#endif // DM_SPINE_BAKED_H
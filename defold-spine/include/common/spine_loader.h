@@ -5,10 +5,12 @@ extern "C" {
 #include <spine/AttachmentLoader.h>
 }
 
+#include <stdint.h>
 #include <dmsdk/dlib/hashtable.h>
 
 struct spAtlasRegion;
 struct spSkeletonData;
+struct Json;
 
 namespace dmGameSystemDDF
 {
@@ -40,7 +42,21 @@ namespace dmSpine
 
     void Dispose(spDefoldAtlasAttachmentLoader* loader);
 
-    spSkeletonData* ReadSkeletonJsonData(spAttachmentLoader* loader, const char* path, void* json_data);
+    // The json data doesn't have to be null terminated
+    spSkeletonData* ReadSkeletonJsonData(spAttachmentLoader* loader, const char* path, const void* json_data, uint32_t json_size);
+
+    // Parses the json document once, so that it can be read without keeping a copy of the text (see res_spine_json.cpp)
+    struct Json* ParseSkeletonJson(const char* path, const void* json_data, uint32_t json_size);
+    void DisposeSkeletonJson(struct Json* json);
+    // Reads from a parsed document. The document is left untouched, and is still owned by the caller
+    spSkeletonData* ReadSkeletonJsonData(spAttachmentLoader* loader, const char* path, struct Json* json);
+    spSkeletonData* ReadSkeletonBinaryData(spAttachmentLoader* loader, const char* path, const void* data, uint32_t data_size);
+
+    // True for the binary skeleton files (.spineskel, and .spineskelc once built)
+    bool IsSkeletonBinaryPath(const char* path);
+
+    // Reads either format, depending on the path (see IsSkeletonBinaryPath)
+    spSkeletonData* ReadSkeletonData(spAttachmentLoader* loader, const char* path, void* data, uint32_t data_size);
 
 } // namespace
 
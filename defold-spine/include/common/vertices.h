@@ -5,6 +5,9 @@
 #include <dmsdk/dlib/array.h>
 #include <dmsdk/dlib/vmath.h>
 
+struct spAnimation;
+struct spBone;
+struct spRegionAttachment;
 struct spSkeleton;
 struct spSkeletonClipping;
 
@@ -19,6 +22,26 @@ struct SpineVertex
     float page_index;
 };
 
+// Half the size of a SpineVertex: normalized 16 bit texture coordinates, 8 bit color and no page index
+struct SpineCompactVertex
+{
+    float    x, y, z;
+    uint16_t u, v;
+    uint8_t  r, g, b, a;
+};
+
+// The vertex layout of the GPU skinned geometry (see spine_skinning.h).
+// The position is the weighted sum of (up to) four bone local positions, transformed by their bones in the vertex shader
+struct SpineSkinnedVertex
+{
+    float    positions[8];  // x,y per bone
+    float    weights[4];
+    uint8_t  bones[4];      // Indices into the bone transform constants
+    float    u, v;
+    uint8_t  r, g, b, a;    // The attachment color
+    float    slot;          // Index into the slot color constants
+};
+
 struct SpineModelBounds
 {
     float minX;
@@ -41,11 +64,72 @@ struct SpineIndexedDrawDesc
     uint32_t m_BlendMode; // spBlendMode
 };
 
+// The 16 bit indices address 65536 vertices, so the vertex buffers are drawn in segments of that size
+static const uint32_t VERTEX_SEGMENT_SHIFT = 16;
+static const uint32_t VERTEX_SEGMENT_SIZE = 1U << VERTEX_SEGMENT_SHIFT;
+
+// A range of 16 bit indices whose vertices are all in one 65536 vertex segment (see GenerateSegmentedVertexData)
+struct SpineIndexSegment
+{
+    uint32_t m_IndexStart;
+    uint32_t m_IndexCount;
+    uint32_t m_Segment;     // Relative to the segment the geometry starts in
+};
+
+// The output size of the last generated geometry, and the signature of the attachments it was generated from
+struct SpineGeometrySizeCache
+{
+    uint64_t m_Signature;
+    uint32_t m_VertexCount;
+    uint32_t m_IndexCount;
+    uint8_t  m_Clipped : 1; // The size also depends on the pose, and may change while the signature doesn't
+};
+
 uint32_t CalcVertexBufferSize(const spSkeleton* skeleton, spSkeletonClipping* skeleton_clipper, uint32_t* out_max_triangle_count);
 uint32_t CalcDrawDescCount(const spSkeleton* skeleton);
-uint32_t GenerateVertexData(dmArray<SpineVertex>& vertex_buffer, const spSkeleton* skeleton, spSkeletonClipping* skeleton_clipper, const dmVMath::Matrix4& world, const dmVMath::Vector4& color_tint, dmArray<SpineDrawDesc>* draw_descs);
-uint32_t GenerateIndexedVertexData(dmArray<SpineVertex>& vertex_buffer, dmArray<uint32_t>& index_buffer, const spSkeleton* skeleton, spSkeletonClipping* skeleton_clipper, const dmVMath::Matrix4& world, const dmVMath::Vector4& color_tint, dmArray<SpineIndexedDrawDesc>* draw_descs, dmArray<float>& scratch);
+// A hash of the drawn attachments and the clipping attachments, which doesn't depend on the pose
+uint64_t CalcGeometrySignature(const spSkeleton* skeleton, bool* out_clipped);
+// Returns true if the cached size is that of the skeleton's geometry. Otherwise the new signature is stored, and the
+// size is expected to be updated once the geometry is generated
+bool CheckGeometrySizeCache(SpineGeometrySizeCache& cache, const spSkeleton* skeleton);
+// If size_cache is set, the vertex buffer is sized from it (while the signature is unchanged), and it's updated afterwards.
+// Otherwise the vertex buffer grows as the attachments are added
+uint32_t GenerateVertexData(dmArray<SpineVertex>& vertex_buffer, const spSkeleton* skeleton, spSkeletonClipping* skeleton_clipper, const dmVMath::Matrix4& world, const dmVMath::Vector4& color_tint, dmArray<SpineDrawDesc>* draw_descs, SpineGeometrySizeCache* size_cache);
+// If world_vertices is set (see GetSkeletonWorldVertices), the attachment vertices aren't computed again
+uint32_t GenerateIndexedVertexData(dmArray<SpineVertex>& vertex_buffer, dmArray<uint32_t>& index_buffer, const spSkeleton* skeleton, spSkeletonClipping* skeleton_clipper, const dmVMath::Matrix4& world, const dmVMath::Vector4& color_tint, dmArray<SpineIndexedDrawDesc>* draw_descs, dmArray<float>& scratch, const float* world_vertices);
+// The 16 bit indices wrap around, i.e. they are relative to the 65536 vertex segment of the vertex buffer that the vertices are in.
+// The caller makes sure that the vertices of a skeleton don't cross a segment boundary (see GenerateSegmentedVertexData for larger skeletons)
+uint32_t GenerateIndexedVertexData(dmArray<SpineVertex>& vertex_buffer, dmArray<uint16_t>& index_buffer, const spSkeleton* skeleton, spSkeletonClipping* skeleton_clipper, const dmVMath::Matrix4& world, const dmVMath::Vector4& color_tint, dmArray<SpineIndexedDrawDesc>* draw_descs, dmArray<float>& scratch, const float* world_vertices);
+uint32_t GenerateIndexedVertexData(dmArray<SpineSkinnedVertex>& vertex_buffer, dmArray<uint16_t>& index_buffer, const spSkeleton* skeleton, spSkeletonClipping* skeleton_clipper, const dmVMath::Matrix4& world, const dmVMath::Vector4& color_tint, dmArray<SpineIndexedDrawDesc>* draw_descs, dmArray<float>& scratch, const float* world_vertices);
+uint32_t GenerateIndexedVertexData(dmArray<SpineCompactVertex>& vertex_buffer, dmArray<uint16_t>& index_buffer, const spSkeleton* skeleton, spSkeletonClipping* skeleton_clipper, const dmVMath::Matrix4& world, const dmVMath::Vector4& color_tint, dmArray<SpineIndexedDrawDesc>* draw_descs, dmArray<float>& scratch, const float* world_vertices);
+// For the skeletons with more than 65536 vertices. The vertex buffer must end at the start of a segment. An attachment that would
+// cross the end of a segment starts at the next one instead, with the vertices in between unused. The indices of each segment are
+// appended to out_segments, and they wrap around as above
+uint32_t GenerateSegmentedVertexData(dmArray<SpineVertex>& vertex_buffer, dmArray<uint16_t>& index_buffer, const spSkeleton* skeleton, spSkeletonClipping* skeleton_clipper, const dmVMath::Matrix4& world, const dmVMath::Vector4& color_tint, dmArray<SpineIndexedDrawDesc>* draw_descs, dmArray<float>& scratch, const float* world_vertices, dmArray<SpineIndexSegment>& out_segments);
+uint32_t GenerateSegmentedVertexData(dmArray<SpineCompactVertex>& vertex_buffer, dmArray<uint16_t>& index_buffer, const spSkeleton* skeleton, spSkeletonClipping* skeleton_clipper, const dmVMath::Matrix4& world, const dmVMath::Vector4& color_tint, dmArray<SpineIndexedDrawDesc>* draw_descs, dmArray<float>& scratch, const float* world_vertices, dmArray<SpineIndexSegment>& out_segments);
 void GetSkeletonBounds(const spSkeleton* skeleton, SpineModelBounds& bounds, dmArray<float>& scratch);
+// The bounds of all region and mesh attachments of all skins, sampled over the animation (or the setup pose if animation is 0).
+// IK targets, physics and changes made at runtime aren't accounted for. The skeleton is left in the last sampled pose
+void GetAnimationBounds(spSkeleton* skeleton, const spAnimation* animation, float sample_rate, SpineModelBounds& bounds, dmArray<float>& scratch);
+// Appends the (skeleton space) vertices of all region and mesh attachments, in draw order, and calculates their bounds.
+// Returns the number of floats added
+uint32_t GetSkeletonWorldVertices(const spSkeleton* skeleton, SpineModelBounds& bounds, dmArray<float>& out_world_vertices);
+// Transforms 2D skeleton space positions (x,y pairs) and writes complete vertices. The transform is expected to be affine.
+// Uses SSE2/NEON when available
+void TransformVertices(SpineVertex* out, const float* positions, const float* uvs, uint32_t count, const dmVMath::Matrix4& world, const float color[4], float page_index);
+// The reference implementation, with a full matrix multiplication per vertex
+void TransformVerticesScalar(SpineVertex* out, const float* positions, const float* uvs, uint32_t count, const dmVMath::Matrix4& world, const float color[4], float page_index);
+// The texture coordinates and the color are clamped to [0,1]. The page index isn't stored
+void TransformVertices(SpineCompactVertex* out, const float* positions, const float* uvs, uint32_t count, const dmVMath::Matrix4& world, const float color[4], float page_index);
+// Writes already transformed vertices, fully weighted to bone 0 (identity) and slot 0 (white). The page index isn't stored
+void TransformVertices(SpineSkinnedVertex* out, const float* positions, const float* uvs, uint32_t count, const dmVMath::Matrix4& world, const float color[4], float page_index);
+// Writes the 4 vertices of a region attachment straight from its bone, with the bone transform composed with the
+// world transform once. Equal to spRegionAttachment_computeWorldVertices() followed by TransformVertices().
+// The sequence of the attachment (if any) must already have been applied
+void TransformRegionVertices(SpineVertex* out, const spRegionAttachment* attachment, const spBone* bone, const dmVMath::Matrix4& world, const float color[4], float page_index);
+void TransformRegionVertices(SpineCompactVertex* out, const spRegionAttachment* attachment, const spBone* bone, const dmVMath::Matrix4& world, const float color[4], float page_index);
+void TransformRegionVertices(SpineSkinnedVertex* out, const spRegionAttachment* attachment, const spBone* bone, const dmVMath::Matrix4& world, const float color[4], float page_index);
+
 void MergeDrawDescs(const dmArray<SpineDrawDesc>& src, dmArray<SpineDrawDesc>& dst);
 void MergeIndexedDrawDescs(const dmArray<SpineIndexedDrawDesc>& src, dmArray<SpineIndexedDrawDesc>& dst);
 
@@ -78,6 +78,7 @@ struct spTrackEntry {
 	spTrackEntryArray *timelineHoldMix;
 	float *timelinesRotation;
 	int timelinesRotationCount;
+	int timelinesRotationCapacity; /* Defold */
 	void *rendererObject;
 	void *userData;
 };
@@ -107,6 +108,16 @@ SP_API void spAnimationState_update(spAnimationState *self, float delta);
 
 SP_API int /**bool**/ spAnimationState_apply(spAnimationState *self, struct spSkeleton *skeleton);
 
+/* Defold: Advances the event and completion bookkeeping exactly like spAnimationState_apply, but without posing a
+ * skeleton. Returns 0 without doing anything if a track is currently mixing, in which case spAnimationState_apply
+ * must be used instead. */
+SP_API int /**bool**/ spAnimationState_applyEvents(spAnimationState *self);
+
+/* Defold: Same as spAnimationState_apply for a single, unmixed track at full alpha, except that the rotate, translate,
+ * scale and shear timelines are skipped (the bone transforms are expected to come from baked data). Returns 0 without
+ * doing anything if the state doesn't qualify. */
+SP_API int /**bool**/ spAnimationState_applyWithoutBoneTransforms(spAnimationState *self, struct spSkeleton *skeleton);
+
 SP_API void spAnimationState_clearTracks(spAnimationState *self);
 
 SP_API void spAnimationState_clearTrack(spAnimationState *self, int trackIndex);
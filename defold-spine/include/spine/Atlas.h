@@ -107,6 +107,9 @@ struct spAtlasRegion {
 
 	spAtlasPage *page;
 
+	/* Defold: The page of a paged atlas (the layer of the texture array) that the region is in */
+	int pageIndex;
+
 	spAtlasRegion *next;
 };
 
@@ -84,6 +84,10 @@ SP_API void spSkeleton_updateCache(spSkeleton *self);
 
 SP_API void spSkeleton_updateWorldTransform(const spSkeleton *self, spPhysics physics);
 
+/* Defold: Same as spSkeleton_updateWorldTransform, but only the bones and IK constraints are updated. The transform, path
+ * and physics constraints are left as they are (used for low detail levels). */
+SP_API void spSkeleton_updateWorldTransformWithoutConstraints(const spSkeleton *self);
+
 SP_API void spSkeleton_update(spSkeleton *self, float delta);
 
 /* Sets the bones, constraints, and slots to their setup pose values. */
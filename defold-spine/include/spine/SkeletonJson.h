@@ -42,6 +42,7 @@ extern "C" {
 #endif
 
 struct spAtlasAttachmentLoader;
+struct Json;
 
 typedef struct spSkeletonJson {
 	float scale;
@@ -57,6 +58,12 @@ SP_API void spSkeletonJson_dispose(spSkeletonJson *self);
 
 SP_API spSkeletonData *spSkeletonJson_readSkeletonData(spSkeletonJson *self, const char *json);
 
+/* Defold: The json doesn't have to be null terminated */
+SP_API spSkeletonData *spSkeletonJson_readSkeletonDataWithLength(spSkeletonJson *self, const char *json, int length);
+
+/* Defold: Reads from a document parsed with Json_createWithLength(). The document isn't disposed. */
+SP_API spSkeletonData *spSkeletonJson_readSkeletonDataJson(spSkeletonJson *self, struct Json *root);
+
 SP_API spSkeletonData *spSkeletonJson_readSkeletonDataFile(spSkeletonJson *self, const char *path);
 
 #ifdef __cplusplus
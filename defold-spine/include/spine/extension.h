@@ -237,6 +237,8 @@ struct _spAnimationState {
 	int propertyIDsCapacity;
 
 	int /*boolean*/ animationsChanged;
+
+	spTrackEntry *trackEntryPool; /* Defold: The disposed track entries, linked by their next pointer */
 };
 
 
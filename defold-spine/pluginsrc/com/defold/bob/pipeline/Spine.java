@@ -291,6 +291,68 @@ public class Spine {
         return (DrawDesc[])first.toArray(pcount.getValue());
     }
 
+    ////////////////////////////////////////////////////////////////////////////////
+    // Baked animations
+
+    // Matching the layout 1:1 with dmSpine::BakedAnimationInfo in spine_baked.h
+    static public class BakedAnimationInfo extends Structure {
+        public String name;
+        public int frameCount;
+        public int boneCount;
+        public int channelCount;
+        public int dataSize;
+        public int bakedTimelines;
+        public int totalTimelines;
+        public int bakedKeys;
+
+        protected List getFieldOrder() {
+            return Arrays.asList(new String[] {"name", "frameCount", "boneCount", "channelCount", "dataSize", "bakedTimelines", "totalTimelines", "bakedKeys"});
+        }
+    }
+
+    public static native int SPINE_BakeAnimations(SpinePointer spine, String[] animations, int count, float sampleRate);
+    public static native Pointer SPINE_GetBakedData(SpinePointer spine, IntByReference objectCount);
+    public static native BakedAnimationInfo SPINE_GetBakedInfoData(SpinePointer spine, IntByReference objectCount);
+
+    // Samples the bone timelines of the animations ("*" for all animations) into a blob that is read by the runtime
+    public static byte[] SPINE_BakeAnimations(SpinePointer spine, String[] animations, float sampleRate) throws SpineException {
+        int size = SPINE_BakeAnimations(spine, animations, animations.length, sampleRate);
+        if (size < 0) {
+            throw new SpineException(SPINE_GetLastError());
+        }
+        IntByReference pcount = new IntByReference();
+        Pointer first = SPINE_GetBakedData(spine, pcount);
+        if (first == null || pcount.getValue() == 0) {
+            return new byte[0];
+        }
+        return first.getByteArray(0, pcount.getValue());
+    }
+
+    // The statistics from the last call to SPINE_BakeAnimations
+    public static BakedAnimationInfo[] SPINE_GetBakedInfo(SpinePointer spine) {
+        IntByReference pcount = new IntByReference();
+        BakedAnimationInfo first = SPINE_GetBakedInfoData(spine, pcount);
+        if (first == null || pcount.getValue() == 0) {
+            return new BakedAnimationInfo[0];
+        }
+        return (BakedAnimationInfo[])first.toArray(pcount.getValue());
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+    // Animation bounds
+
+    public static native Pointer SPINE_GetAnimationBounds(SpinePointer spine, IntByReference objectCount);
+
+    // The bounds (min x, min y, max x, max y) of the setup pose, followed by those of each animation
+    public static float[] SPINE_GetAnimationBounds(SpinePointer spine) {
+        IntByReference pcount = new IntByReference();
+        Pointer first = SPINE_GetAnimationBounds(spine, pcount);
+        if (first == null || pcount.getValue() == 0) {
+            return new float[0];
+        }
+        return first.getFloatArray(0, pcount.getValue());
+    }
+
     ////////////////////////////////////////////////////////////////////////////////
 
     public static SpinePointer SPINE_LoadFileFromBuffer(byte[] json_buffer, String path, byte[] atlas_buffer, String atlas_path) throws SpineException {
@@ -327,11 +389,46 @@ public class Spine {
     //     SPINE_GetVertices(spine, b, b.capacity()*4);
     // }
 
+    public static native double SPINE_BenchmarkVertexTransform(SpinePointer spine, int iterations, int use_simd);
+    public static native double SPINE_BenchmarkRegionVertices(SpinePointer spine, int iterations, int use_fast_path);
+    public static native int SPINE_BenchmarkAnimationSwitching(SpinePointer spine, int iterations);
+    public static native int SPINE_CheckVertexSegments(SpinePointer spine);
+
     private static void Usage() {
-        System.out.printf("Usage: pluginSpineExt.jar <.spinejson> <.texturesetc>\n");
+        System.out.printf("Usage: pluginSpineExt.jar <.spinejson|.spineskel> <.texturesetc> [--benchmark [iterations] | --check-segments]\n");
         System.out.printf("\n");
     }
 
+    private static void BenchmarkVertexTransform(String path, SpinePointer p, int iterations) {
+        // Warm up
+        SPINE_BenchmarkVertexTransform(p, 1, 0);
+        SPINE_BenchmarkVertexTransform(p, 1, 1);
+
+        double scalar = SPINE_BenchmarkVertexTransform(p, iterations, 0);
+        double simd = SPINE_BenchmarkVertexTransform(p, iterations, 1);
+        System.out.printf("%s: vertex transform x%d: scalar: %.3f ms  simd: %.3f ms  speedup: %.2fx\n",
+                path, iterations, scalar, simd, simd > 0.0 ? scalar / simd : 0.0);
+    }
+
+    private static void BenchmarkRegionVertices(String path, SpinePointer p, int iterations) {
+        // Warm up
+        SPINE_BenchmarkRegionVertices(p, 1, 0);
+        SPINE_BenchmarkRegionVertices(p, 1, 1);
+
+        double generic = SPINE_BenchmarkRegionVertices(p, iterations, 0);
+        double fast = SPINE_BenchmarkRegionVertices(p, iterations, 1);
+        System.out.printf("%s: region vertices x%d: generic: %.3f ms  fast path: %.3f ms  speedup: %.2fx\n",
+                path, iterations, generic, fast, fast > 0.0 ? generic / fast : 0.0);
+    }
+
+    private static void BenchmarkAnimationSwitching(String path, SpinePointer p, int iterations) {
+        long start = System.nanoTime();
+        int allocations = SPINE_BenchmarkAnimationSwitching(p, iterations);
+        double time = (System.nanoTime() - start) / 1000000.0;
+        System.out.printf("%s: animation switching x%d: %.3f ms  allocations in steady state: %d\n",
+                path, iterations, time, allocations);
+    }
+
     private static void DebugPrintBone(Bone bone, Bone[] bones, int indent) {
         String tab = " ".repeat(indent * 4);
         System.out.printf("Bone:%s %s: idx: %d parent = %d, pos: %f, %f  scale: %f, %f  rot: %f  length: %f\n",
@@ -363,7 +460,7 @@ public class Spine {
             return;
         }
 
-        String path = args[0];       // .spinejson
+        String path = args[0];       // .spinejson or .spineskel
         String atlas_path = args[1]; // .texturesetc
         Pointer spine_file = SPINE_LoadFromPath(path, atlas_path);
 
@@ -371,11 +468,29 @@ public class Spine {
             System.out.printf("Loaded %s\n", path);
         } else {
             System.err.printf("Failed to load %s\n", path);
-            return;
+            System.exit(1);
         }
 
         SpinePointer p = new SpinePointer(spine_file);
 
+        if (args.length > 2 && args[2].equals("--benchmark")) {
+            int iterations = args.length > 3 ? Integer.parseInt(args[3]) : 100;
+            BenchmarkVertexTransform(path, p, iterations);
+            BenchmarkRegionVertices(path, p, iterations);
+            BenchmarkAnimationSwitching(path, p, iterations);
+            return;
+        }
+
+        if (args.length > 2 && args[2].equals("--check-segments")) {
+            int segments = SPINE_CheckVertexSegments(p);
+            if (segments < 0) {
+                System.err.printf("%s: %s\n", path, SPINE_GetLastError());
+                System.exit(1);
+            }
+            System.out.printf("%s: vertex segments: %d ok\n", path, segments);
+            return;
+        }
+
         {
             int i = 0;
             for (String name : SPINE_GetAnimations(p)) {
@@ -12,11 +12,102 @@ import com.dynamo.bob.pipeline.Spine;
 
 import java.io.IOException;
 import java.nio.Buffer;
+import java.util.ArrayList;
+import java.util.List;
+import java.util.logging.Logger;
+
+import com.google.protobuf.ByteString;
 
 @ProtoParams(srcClass = SpineSceneDesc.class, messageClass = SpineSceneDesc.class)
 @BuilderParams(name="SpineScene", inExts=".spinescene", outExt=".spinescenec")
 public class SpineSceneBuilder extends ProtoBuilder<SpineSceneDesc.Builder> {
 
+    private static Logger logger = Logger.getLogger(SpineSceneBuilder.class.getName());
+
+    private static String[] parseAnimationNames(String names) {
+        List<String> result = new ArrayList<String>();
+        for (String name : names.split(",")) {
+            name = name.trim();
+            if (!name.isEmpty()) {
+                result.add(name);
+            }
+        }
+        return result.toArray(new String[0]);
+    }
+
+    // The skeleton data is either json (.spinejsonc) or binary (.spineskelc)
+    private static boolean isSkeletonData(String path) {
+        return path.endsWith("spinejsonc") || path.endsWith("spineskelc");
+    }
+
+    private void bakeAnimations(Task task, IResource resource, SpineSceneDesc.Builder builder) throws CompileExceptionError {
+        String[] animations = parseAnimationNames(builder.getBakedAnimations());
+        if (animations.length == 0) {
+            return;
+        }
+
+        IResource spinejsonc = null;
+        for (IResource input: task.getInputs()) {
+            if (isSkeletonData(input.getPath())) {
+                spinejsonc = input;
+            }
+        }
+        if (spinejsonc == null) {
+            throw new CompileExceptionError(resource, -1, "Baked animations need the skeleton data (spine_json) of the scene");
+        }
+
+        try {
+            // The bones and timelines are all we need, so we don't need the atlas here
+            Spine.SpinePointer spine = Spine.SPINE_LoadFileFromBuffer(spinejsonc.getContent(), spinejsonc.getPath());
+            byte[] data = Spine.SPINE_BakeAnimations(spine, animations, builder.getBakeSampleRate());
+            builder.setBakedAnimationData(ByteString.copyFrom(data));
+
+            // Report the memory/cpu trade off per animation
+            for (Spine.BakedAnimationInfo info : Spine.SPINE_GetBakedInfo(spine)) {
+                if (info.dataSize == 0) {
+                    logger.info(String.format("%s: '%s' has no bone timelines, nothing to bake", resource.getPath(), info.name));
+                    continue;
+                }
+                logger.info(String.format("%s: baked '%s': %d frames, %d bones (%d channels), %d bytes. Replaces %d of %d timelines (%d keys) with %d lookups per frame",
+                                          resource.getPath(), info.name, info.frameCount, info.boneCount, info.channelCount, info.dataSize,
+                                          info.bakedTimelines, info.totalTimelines, info.bakedKeys, info.channelCount));
+            }
+        }
+        catch (IOException | Spine.SpineException e) {
+            throw new CompileExceptionError(resource, -1, e.getMessage());
+        }
+    }
+
+    // The bounds are calculated here rather than when the scene is loaded, since sampling all animations is slow on big skeletons
+    private void calculateAnimationBounds(Task task, IResource resource, SpineSceneDesc.Builder builder) throws CompileExceptionError {
+        IResource testurec = null;
+        IResource spinejsonc = null;
+        for (IResource input: task.getInputs()) {
+            String path = input.getPath();
+            if (path.endsWith("texturesetc")) {
+                testurec = input;
+            }
+            else if (isSkeletonData(path)) {
+                spinejsonc = input;
+            }
+        }
+        if (spinejsonc == null || testurec == null) {
+            throw new CompileExceptionError(resource, -1, "The spine scene needs both the skeleton data (spine_json) and the atlas");
+        }
+
+        try {
+            // The attachments need the atlas regions for their size
+            Spine.SpinePointer spine = Spine.SPINE_LoadFileFromBuffer(spinejsonc.getContent(), spinejsonc.getPath(), testurec.getContent(), testurec.getPath());
+            builder.clearAnimationBounds();
+            for (float value : Spine.SPINE_GetAnimationBounds(spine)) {
+                builder.addAnimationBounds(value);
+            }
+        }
+        catch (IOException | Spine.SpineException e) {
+            throw new CompileExceptionError(resource, -1, e.getMessage());
+        }
+    }
+
     @Override
     protected SpineSceneDesc.Builder transform(Task task, IResource resource, SpineSceneDesc.Builder builder) throws CompileExceptionError {
 
@@ -25,7 +116,11 @@ public class SpineSceneBuilder extends ProtoBuilder<SpineSceneDesc.Builder> {
         if (!path.equals("")) {
             BuilderUtil.checkResource(this.project, resource, "spine_json", path);
         }
-        builder.setSpineJson(BuilderUtil.replaceExt(path, ".spinejson", ".spinejsonc"));
+        if (path.endsWith(".spineskel")) {
+            builder.setSpineJson(BuilderUtil.replaceExt(path, ".spineskel", ".spineskelc"));
+        } else {
+            builder.setSpineJson(BuilderUtil.replaceExt(path, ".spinejson", ".spinejsonc"));
+        }
 
 
         path = builder.getAtlas();
@@ -34,6 +129,9 @@ public class SpineSceneBuilder extends ProtoBuilder<SpineSceneDesc.Builder> {
         }
         builder.setAtlas(BuilderUtil.replaceExt(path, ".atlas", ".a.texturesetc"));
 
+        bakeAnimations(task, resource, builder);
+        calculateAnimationBounds(task, resource, builder);
+
         return builder;
     }
 
@@ -48,10 +146,13 @@ public class SpineSceneBuilder extends ProtoBuilder<SpineSceneDesc.Builder> {
             if (path.endsWith("texturesetc")) {
                 testurec = input;
             }
-            else if (path.endsWith("spinejsonc")) {
+            else if (isSkeletonData(path)) {
                 spinejsonc = input;
             }
         }
+        if (spinejsonc == null || testurec == null) {
+            throw new CompileExceptionError(task.getInputs().get(0), -1, "The spine scene needs both the skeleton data (spine_json) and the atlas");
+        }
         try {
             Spine.SPINE_LoadFileFromBuffer(spinejsonc.getContent(), spinejsonc.getPath(), testurec.getContent(), testurec.getPath());
         }
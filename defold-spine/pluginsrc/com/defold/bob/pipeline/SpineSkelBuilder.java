@@ -0,0 +1,8 @@
+package com.dynamo.bob.pipeline;
+
+import com.dynamo.bob.BuilderParams;
+import com.dynamo.bob.CopyBuilder;
+
+// The binary skeleton format, exported from Spine as .skel and renamed to .spineskel
+@BuilderParams(name="SpineSkelFile", inExts=".spineskel", outExt=".spineskelc")
+public class SpineSkelBuilder extends CopyBuilder {}
@@ -14,6 +14,7 @@
 // #endif
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <stdint.h>
 
 #include <dmsdk/sdk.h>
@@ -22,18 +23,24 @@
 #include <dmsdk/dlib/math.h>
 #include <dmsdk/dlib/dstrings.h>
 #include <dmsdk/dlib/shared_library.h>
+#include <dmsdk/dlib/time.h>
 #include <dmsdk/ddf/ddf.h>
 #include <dmsdk/gamesys/resources/res_textureset.h>
 #include <gamesys/texture_set_ddf.h>
 
+#include <common/spine_baked.h>
 #include <common/spine_loader.h>
 #include <common/vertices.h>
 
+#include <spine/Animation.h>
 #include <spine/AnimationStateData.h>
 #include <spine/AnimationState.h>
+#include <spine/MeshAttachment.h>
+#include <spine/RegionAttachment.h>
 #include <spine/SkeletonData.h>
 #include <spine/Skeleton.h>
 #include <spine/SkeletonClipping.h>
+#include <spine/extension.h>
 
 static const dmhash_t UNIFORM_TINT = dmHashString64("tint");
 
@@ -70,6 +77,10 @@ struct SpineFile
     dmArray<dmSpine::SpineIndexedDrawDesc>  m_DrawDescScratch;
     dmArray<dmSpine::SpineIndexedDrawDesc>  m_MergedDrawDescScratch;
     dmArray<float>                           m_GeometryScratch;
+    // Bake data
+    dmArray<uint8_t>                        m_BakedData;
+    dmArray<dmSpine::BakedAnimationInfo>    m_BakedInfo;
+    dmArray<float>                          m_AnimationBounds;
     uint32_t                                m_VertexBufferVersion;
     uint32_t                                m_IndexBufferVersion;
     dmhash_t                                m_CurrentSkin;
@@ -280,13 +291,13 @@ extern "C" DM_DLLEXPORT void* SPINE_LoadFromBuffer(void* json, size_t json_size,
 
     // Create the spine resource
     spAttachmentLoader* attachment_loader = (spAttachmentLoader*)file->m_AttachmentLoader;
-    file->m_SkeletonData = dmSpine::ReadSkeletonJsonData(attachment_loader, path, json);
+    file->m_SkeletonData = dmSpine::ReadSkeletonData(attachment_loader, path, json, (uint32_t)json_size);
     if (!file->m_SkeletonData)
     {
         if (attachment_loader->error1 || attachment_loader->error2)
             SPINE_SetLastError(attachment_loader);
 
-        dmLogError("Failed to load Spine skeleton from json file %s", path);
+        dmLogError("Failed to load Spine skeleton from file %s", path);
         SPINE_Destroy(file);
         return 0;
     }
@@ -599,6 +610,398 @@ extern "C" DM_DLLEXPORT void SPINE_SetAnimation(void* _file, const char* animati
     spAnimationState_setAnimationByName(file->m_AnimationStateInstance, track, animation, loop);
 }
 
+// Microbenchmark for the vertex transform (see utils/benchmark_vertices.sh).
+// Poses the skeleton at a few points of every animation, and returns the time (in milliseconds)
+// spent transforming the attachment vertices with either the SIMD or the scalar kernel
+extern "C" DM_DLLEXPORT double SPINE_BenchmarkVertexTransform(void* _file, int iterations, int use_simd)
+{
+    SpineFile* file = TO_SPINE_FILE(_file);
+    CHECK_FILE_RETURN_VALUE(file, -1.0);
+
+    static const int FRAMES_PER_ANIMATION = 10;
+    const float color[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+    const dmVMath::Matrix4 transform = dmVMath::Matrix4::translation(dmVMath::Vector3(100.0f, 50.0f, 0.0f)) * dmVMath::Matrix4::rotationZ(0.5f);
+
+    spSkeleton* skeleton = file->m_SkeletonInstance;
+    spSkeletonData* skeleton_data = file->m_SkeletonData;
+
+    dmArray<float> world_vertices;
+    dmArray<dmSpine::SpineVertex> vertices;
+    uint64_t total_time = 0;
+
+    for (int a = 0; a < skeleton_data->animationsCount; ++a)
+    {
+        spAnimation* animation = skeleton_data->animations[a];
+        for (int f = 0; f < FRAMES_PER_ANIMATION; ++f)
+        {
+            float time = animation->duration * f / FRAMES_PER_ANIMATION;
+            spSkeleton_setToSetupPose(skeleton);
+            spAnimation_apply(animation, skeleton, -1.0f, time, 0, 0, 0, 1.0f, SP_MIX_BLEND_SETUP, SP_MIX_DIRECTION_IN);
+            spSkeleton_updateWorldTransform(skeleton, SP_PHYSICS_NONE);
+
+            dmSpine::SpineModelBounds bounds;
+            world_vertices.SetSize(0);
+            uint32_t vertex_count = dmSpine::GetSkeletonWorldVertices(skeleton, bounds, world_vertices) / 2;
+            if (vertices.Capacity() < vertex_count)
+                vertices.SetCapacity(vertex_count);
+            vertices.SetSize(vertex_count);
+
+            uint64_t start = dmTime::GetTime();
+            for (int i = 0; i < iterations; ++i)
+            {
+                // One call per attachment, as in GenerateIndexedVertexData()
+                const float* positions = world_vertices.Begin();
+                dmSpine::SpineVertex* out = vertices.Begin();
+                for (int s = 0; s < skeleton->slotsCount; ++s)
+                {
+                    spAttachment* attachment = skeleton->drawOrder[s]->attachment;
+                    if (!attachment)
+                        continue;
+
+                    const float* uvs = 0;
+                    uint32_t count = 0;
+                    if (attachment->type == SP_ATTACHMENT_REGION)
+                    {
+                        uvs = ((spRegionAttachment*)attachment)->uvs;
+                        count = 4;
+                    }
+                    else if (attachment->type == SP_ATTACHMENT_MESH)
+                    {
+                        spMeshAttachment* mesh = (spMeshAttachment*)attachment;
+                        uvs = mesh->uvs;
+                        count = mesh->super.worldVerticesLength / 2;
+                    }
+                    else
+                    {
+                        continue;
+                    }
+
+                    if (use_simd)
+                        dmSpine::TransformVertices(out, positions, uvs, count, transform, color, 0.0f);
+                    else
+                        dmSpine::TransformVerticesScalar(out, positions, uvs, count, transform, color, 0.0f);
+                    positions += count * 2;
+                    out += count;
+                }
+            }
+            total_time += dmTime::GetTime() - start;
+        }
+    }
+
+    spSkeleton_setToSetupPose(skeleton);
+    return total_time / 1000.0;
+}
+
+// Microbenchmark for the region attachments (see utils/benchmark_vertices.sh).
+// Returns the time (in milliseconds) spent writing the vertices and indices of the region attachments, either
+// from their bones (TransformRegionVertices) or via spRegionAttachment_computeWorldVertices() and TransformVertices()
+extern "C" DM_DLLEXPORT double SPINE_BenchmarkRegionVertices(void* _file, int iterations, int use_fast_path)
+{
+    SpineFile* file = TO_SPINE_FILE(_file);
+    CHECK_FILE_RETURN_VALUE(file, -1.0);
+
+    static const int FRAMES_PER_ANIMATION = 10;
+    static const uint16_t QUAD_INDICES[] = { 0, 1, 2, 2, 3, 0 };
+    const float color[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+    const dmVMath::Matrix4 transform = dmVMath::Matrix4::translation(dmVMath::Vector3(100.0f, 50.0f, 0.0f)) * dmVMath::Matrix4::rotationZ(0.5f);
+
+    spSkeleton* skeleton = file->m_SkeletonInstance;
+    spSkeletonData* skeleton_data = file->m_SkeletonData;
+
+    dmArray<dmSpine::SpineVertex> vertices;
+    dmArray<uint16_t> indices;
+    vertices.SetCapacity(skeleton->slotsCount * 4);
+    indices.SetCapacity(skeleton->slotsCount * 6);
+    float scratch[8];
+    uint64_t total_time = 0;
+
+    for (int a = 0; a < skeleton_data->animationsCount; ++a)
+    {
+        spAnimation* animation = skeleton_data->animations[a];
+        for (int f = 0; f < FRAMES_PER_ANIMATION; ++f)
+        {
+            float time = animation->duration * f / FRAMES_PER_ANIMATION;
+            spSkeleton_setToSetupPose(skeleton);
+            spAnimation_apply(animation, skeleton, -1.0f, time, 0, 0, 0, 1.0f, SP_MIX_BLEND_SETUP, SP_MIX_DIRECTION_IN);
+            spSkeleton_updateWorldTransform(skeleton, SP_PHYSICS_NONE);
+
+            uint64_t start = dmTime::GetTime();
+            for (int i = 0; i < iterations; ++i)
+            {
+                vertices.SetSize(0);
+                indices.SetSize(0);
+                for (int s = 0; s < skeleton->slotsCount; ++s)
+                {
+                    spSlot* slot = skeleton->drawOrder[s];
+                    if (!slot->attachment || slot->attachment->type != SP_ATTACHMENT_REGION)
+                        continue;
+
+                    spRegionAttachment* region = (spRegionAttachment*)slot->attachment;
+                    uint32_t vertex_base = vertices.Size();
+                    vertices.SetSize(vertex_base + 4);
+                    if (use_fast_path && !region->sequence) // As GenerateIndexedVertexData does
+                    {
+                        dmSpine::TransformRegionVertices(vertices.Begin() + vertex_base, region, slot->bone, transform, color, 0.0f);
+                    }
+                    else
+                    {
+                        spRegionAttachment_computeWorldVertices(region, slot, scratch, 0, 2);
+                        dmSpine::TransformVertices(vertices.Begin() + vertex_base, scratch, region->uvs, 4, transform, color, 0.0f);
+                    }
+                    for (int j = 0; j < 6; ++j)
+                        indices.Push((uint16_t)(vertex_base + QUAD_INDICES[j]));
+                }
+            }
+            total_time += dmTime::GetTime() - start;
+        }
+    }
+
+    spSkeleton_setToSetupPose(skeleton);
+    return total_time / 1000.0;
+}
+
+static uint32_t g_BenchmarkAllocationCount = 0;
+
+static void* BenchmarkMalloc(size_t size)
+{
+    ++g_BenchmarkAllocationCount;
+    return malloc(size);
+}
+
+static void* BenchmarkRealloc(void* ptr, size_t size)
+{
+    ++g_BenchmarkAllocationCount;
+    return realloc(ptr, size);
+}
+
+static void SwitchAnimation(spAnimationState* state, spSkeleton* skeleton, spSkeletonData* skeleton_data, int i)
+{
+    // As play_anim does, and with an animation queued after it, so that there are entries both mixing and waiting
+    int count = skeleton_data->animationsCount;
+    spAnimationState_setAnimation(state, 0, skeleton_data->animations[i % count], 1);
+    spAnimationState_addAnimation(state, 0, skeleton_data->animations[(i + 1) % count], 0, 0.0f);
+    spAnimationState_update(state, 1.0f / 60.0f);
+    spAnimationState_apply(state, skeleton);
+}
+
+// Stress benchmark for the animation state (see utils/benchmark_vertices.sh).
+// Switches between all the animations (mixing them), and returns the number of heap allocations
+// made by the spine runtime once warmed up, which should be 0
+extern "C" DM_DLLEXPORT int SPINE_BenchmarkAnimationSwitching(void* _file, int iterations)
+{
+    SpineFile* file = TO_SPINE_FILE(_file);
+    CHECK_FILE_RETURN_VALUE(file, -1);
+
+    spSkeleton* skeleton = file->m_SkeletonInstance;
+    spSkeletonData* skeleton_data = file->m_SkeletonData;
+    if (skeleton_data->animationsCount == 0)
+        return 0;
+
+    float default_mix = file->m_AnimationStateData->defaultMix;
+    file->m_AnimationStateData->defaultMix = 0.2f;
+    spAnimationState* state = spAnimationState_create(file->m_AnimationStateData);
+
+    // Until the mixing chains are as long as they get, and the pooled track entries have played every animation
+    int warmup = (skeleton_data->animationsCount + 1) * 60;
+    for (int i = 0; i < warmup; ++i)
+        SwitchAnimation(state, skeleton, skeleton_data, i);
+
+    g_BenchmarkAllocationCount = 0;
+    _spSetMalloc(BenchmarkMalloc);
+    _spSetRealloc(BenchmarkRealloc);
+
+    for (int i = 0; i < iterations; ++i)
+        SwitchAnimation(state, skeleton, skeleton_data, warmup + i);
+
+    _spSetMalloc(malloc);
+    _spSetRealloc(realloc);
+
+    spAnimationState_dispose(state);
+    file->m_AnimationStateData->defaultMix = default_mix;
+    spSkeleton_setToSetupPose(skeleton);
+    return (int)g_BenchmarkAllocationCount;
+}
+
+static int CheckVertexSegmentsFailed(const char* reason, uint32_t index)
+{
+    char buffer[256];
+    dmSnPrintf(buffer, sizeof(buffer), "Vertex segment check failed: %s (index %u)", reason, index);
+    SPINE_SetLastError(buffer);
+    return -1;
+}
+
+// Test for the skeletons with more than 65536 vertices (see utils/test_plugin.sh).
+// Repeats the draw order of the skeleton until it has more than two segments of vertices, and checks that the segmented
+// 16 bit geometry (GenerateSegmentedVertexData) draws the same vertices as the 32 bit geometry, and that no attachment
+// crosses a segment. Returns the number of segments, or -1 on failure (see SPINE_GetLastError)
+extern "C" DM_DLLEXPORT int SPINE_CheckVertexSegments(void* _file)
+{
+    SpineFile* file = TO_SPINE_FILE(_file);
+    CHECK_FILE_RETURN_VALUE(file, -1);
+
+    static const uint32_t SEGMENT_SIZE = dmSpine::VERTEX_SEGMENT_SIZE;
+    const dmVMath::Matrix4 transform = dmVMath::Matrix4::translation(dmVMath::Vector3(100.0f, 50.0f, 0.0f));
+    const dmVMath::Vector4 color(1.0f);
+
+    spSkeleton* skeleton = file->m_SkeletonInstance;
+    spSkeleton_setToSetupPose(skeleton);
+    spSkeleton_updateWorldTransform(skeleton, SP_PHYSICS_NONE);
+
+    // Without the clipping attachments, since a repeated clip would never end
+    dmArray<spSlot*> draw_order;
+    draw_order.SetCapacity(skeleton->slotsCount);
+    for (int s = 0; s < skeleton->slotsCount; ++s)
+    {
+        spSlot* slot = skeleton->drawOrder[s];
+        if (!slot->attachment || slot->attachment->type != SP_ATTACHMENT_CLIPPING)
+            draw_order.Push(slot);
+    }
+    spSkeleton repeated = *skeleton;
+    repeated.drawOrder = draw_order.Begin();
+    repeated.slotsCount = (int)draw_order.Size();
+
+    spSkeletonClipping* clipper = spSkeletonClipping_create();
+    dmArray<float> scratch;
+    dmArray<dmSpine::SpineVertex> ref_vertices;
+    dmArray<uint32_t> ref_indices;
+    uint32_t skeleton_vertex_count = dmSpine::GenerateIndexedVertexData(ref_vertices, ref_indices, &repeated, clipper, transform, color, 0, scratch, 0);
+    if (skeleton_vertex_count == 0)
+    {
+        spSkeletonClipping_dispose(clipper);
+        return CheckVertexSegmentsFailed("the skeleton has no vertices", 0);
+    }
+
+    // The attachments are the same, so they're generated once per copy of the draw order
+    uint32_t slot_count = draw_order.Size();
+    uint32_t copies = (2 * SEGMENT_SIZE) / skeleton_vertex_count + 2;
+    draw_order.SetCapacity(copies * slot_count);
+    for (uint32_t i = 1; i < copies; ++i)
+    {
+        for (uint32_t s = 0; s < slot_count; ++s)
+            draw_order.Push(draw_order[s]);
+    }
+    repeated.drawOrder = draw_order.Begin();
+    repeated.slotsCount = (int)draw_order.Size();
+
+    ref_vertices.SetSize(0);
+    ref_indices.SetSize(0);
+    dmSpine::GenerateIndexedVertexData(ref_vertices, ref_indices, &repeated, clipper, transform, color, 0, scratch, 0);
+
+    // Starts after a segment, as in the vertex buffer of a world with other spine models
+    dmArray<dmSpine::SpineVertex> vertices;
+    dmArray<uint16_t> indices;
+    dmArray<dmSpine::SpineIndexedDrawDesc> draw_descs;
+    dmArray<dmSpine::SpineIndexSegment> segments;
+    vertices.SetCapacity(SEGMENT_SIZE);
+    vertices.SetSize(SEGMENT_SIZE);
+    draw_descs.SetCapacity(draw_order.Size());
+    dmSpine::GenerateSegmentedVertexData(vertices, indices, &repeated, clipper, transform, color, &draw_descs, scratch, 0, segments);
+    spSkeletonClipping_dispose(clipper);
+
+    if (indices.Size() != ref_indices.Size())
+        return CheckVertexSegmentsFailed("the index counts differ", indices.Size());
+    if (segments.Size() < 2)
+        return CheckVertexSegmentsFailed("the geometry isn't split", segments.Size());
+
+    uint32_t index_start = 0;
+    for (uint32_t i = 0; i < segments.Size(); ++i)
+    {
+        const dmSpine::SpineIndexSegment& segment = segments[i];
+        if (segment.m_IndexStart != index_start || (i > 0 && segment.m_Segment <= segments[i - 1].m_Segment))
+            return CheckVertexSegmentsFailed("the segments aren't in order", i);
+
+        uint32_t segment_start = SEGMENT_SIZE + (segment.m_Segment << dmSpine::VERTEX_SEGMENT_SHIFT);
+        for (uint32_t j = segment.m_IndexStart; j < segment.m_IndexStart + segment.m_IndexCount; ++j)
+        {
+            uint32_t vertex = segment_start + indices[j];
+            if (vertex >= vertices.Size())
+                return CheckVertexSegmentsFailed("the index is out of range", j);
+            if (memcmp(&vertices[vertex], &ref_vertices[ref_indices[j]], sizeof(dmSpine::SpineVertex)) != 0)
+                return CheckVertexSegmentsFailed("the vertex differs", j);
+        }
+        index_start += segment.m_IndexCount;
+    }
+    if (index_start != indices.Size())
+        return CheckVertexSegmentsFailed("the segments don't cover the indices", index_start);
+
+    // One draw desc per attachment
+    uint32_t segment = 0;
+    for (uint32_t i = 0; i < draw_descs.Size(); ++i)
+    {
+        const dmSpine::SpineIndexedDrawDesc& desc = draw_descs[i];
+        while (segment < segments.Size() && segments[segment].m_IndexStart + segments[segment].m_IndexCount <= desc.m_IndexStart)
+            ++segment;
+        if (segment == segments.Size() || desc.m_IndexStart + desc.m_IndexCount > segments[segment].m_IndexStart + segments[segment].m_IndexCount)
+            return CheckVertexSegmentsFailed("an attachment crosses a segment", i);
+    }
+
+    return (int)segments.Size();
+}
+
+// Returns the size of the baked data, or -1 on failure (see SPINE_GetLastError)
+extern "C" DM_DLLEXPORT int SPINE_BakeAnimations(void* _file, const char** animations, int count, float sample_rate)
+{
+    SpineFile* file = TO_SPINE_FILE(_file);
+    CHECK_FILE_RETURN_VALUE(file, -1);
+
+    if (!dmSpine::BakeAnimations(file->m_SkeletonData, animations, (uint32_t)count, sample_rate, file->m_BakedData, file->m_BakedInfo))
+    {
+        char error[1024];
+        dmSnPrintf(error, sizeof(error), "Failed to bake the animations in '%s' (sample rate %.2f). Check that the animation names are correct", file->m_Path, sample_rate);
+        SPINE_SetLastError(error);
+        return -1;
+    }
+    return (int)file->m_BakedData.Size();
+}
+
+extern "C" DM_DLLEXPORT void* SPINE_GetBakedData(void* _file, int* pcount)
+{
+    SpineFile* file = TO_SPINE_FILE(_file);
+    CHECK_FILE_RETURN(file);
+    *pcount = (int)file->m_BakedData.Size();
+    return file->m_BakedData.Begin();
+}
+
+extern "C" DM_DLLEXPORT dmSpine::BakedAnimationInfo* SPINE_GetBakedInfoData(void* _file, int* pcount)
+{
+    SpineFile* file = TO_SPINE_FILE(_file);
+    CHECK_FILE_RETURN(file);
+    *pcount = (int)file->m_BakedInfo.Size();
+    return file->m_BakedInfo.Begin();
+}
+
+// The animations are sampled at this rate when calculating their bounds
+static const float ANIMATION_BOUNDS_SAMPLE_RATE = 30.0f;
+
+// The bounds (min x, min y, max x, max y) of the setup pose, followed by those of each animation, in the order of the skeleton data.
+// Read by the runtime for the models that are culled using them (see culling_bounds in the .spinemodel)
+extern "C" DM_DLLEXPORT float* SPINE_GetAnimationBounds(void* _file, int* pcount)
+{
+    SpineFile* file = TO_SPINE_FILE(_file);
+    CHECK_FILE_RETURN(file);
+
+    spSkeletonData* skeleton_data = file->m_SkeletonData;
+    spSkeleton* skeleton = spSkeleton_create(skeleton_data);
+
+    uint32_t count = (uint32_t)skeleton_data->animationsCount + 1;
+    file->m_AnimationBounds.SetCapacity(count * 4);
+    file->m_AnimationBounds.SetSize(0);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        const spAnimation* animation = i == 0 ? 0 : skeleton_data->animations[i - 1];
+        dmSpine::SpineModelBounds bounds;
+        dmSpine::GetAnimationBounds(skeleton, animation, ANIMATION_BOUNDS_SAMPLE_RATE, bounds, file->m_GeometryScratch);
+        file->m_AnimationBounds.Push(bounds.minX);
+        file->m_AnimationBounds.Push(bounds.minY);
+        file->m_AnimationBounds.Push(bounds.maxX);
+        file->m_AnimationBounds.Push(bounds.maxY);
+    }
+
+    spSkeleton_dispose(skeleton);
+    *pcount = (int)file->m_AnimationBounds.Size();
+    return file->m_AnimationBounds.Begin();
+}
+
 extern "C" DM_DLLEXPORT AABB SPINE_GetAABB(void* _file)
 {
     AABB aabb;
@@ -749,7 +1152,7 @@ static void UpdateRenderData(SpineFile* file, const dmVMath::Matrix4& transform,
             file->m_DrawDescScratch.SetCapacity(new_capacity);
         }
 
-        dmSpine::GenerateIndexedVertexData(file->m_VertexBuffer, file->m_IndexBuffer, file->m_SkeletonInstance, clipper, transform, color_tint, &file->m_DrawDescScratch, file->m_GeometryScratch);
+        dmSpine::GenerateIndexedVertexData(file->m_VertexBuffer, file->m_IndexBuffer, file->m_SkeletonInstance, clipper, transform, color_tint, &file->m_DrawDescScratch, file->m_GeometryScratch, 0);
 
         MergeIndexedDrawDescs(file->m_DrawDescScratch, file->m_MergedDrawDescScratch);
 
@@ -767,7 +1170,7 @@ static void UpdateRenderData(SpineFile* file, const dmVMath::Matrix4& transform,
     }
     else
     {
-        dmSpine::GenerateVertexData(file->m_VertexBuffer, file->m_SkeletonInstance, clipper, transform, color_tint, 0);
+        dmSpine::GenerateVertexData(file->m_VertexBuffer, file->m_SkeletonInstance, clipper, transform, color_tint, 0, 0);
     }
 
     file->m_VertexBufferVersion++;
@@ -45,8 +45,13 @@ extern "C" {
 #include <dmsdk/resource/resource.hpp>
 #include <gameobject/gameobject_ddf.h>
 
+#include <common/spine_baked.h>
 #include <common/vertices.h>
 #include "spine_gui_common.h"
+#include "spine_allocator.h"
+#include "spine_jobs.h"
+#include "spine_pose_cache.h"
+#include "spine_skinning.h"
 
 
 #define _USE_MATH_DEFINES
@@ -55,9 +60,26 @@ extern "C" {
 DM_PROPERTY_GROUP(rmtp_Spine, "Spine", 0);
 DM_PROPERTY_U32(rmtp_SpineBones, 0, PROFILE_PROPERTY_FRAME_RESET, "# spine bones", &rmtp_Spine);
 DM_PROPERTY_U32(rmtp_SpineComponents, 0, PROFILE_PROPERTY_FRAME_RESET, "# spine components", &rmtp_Spine);
+DM_PROPERTY_U32(rmtp_SpineLod0, 0, PROFILE_PROPERTY_FRAME_RESET, "# spine components at LOD 0", &rmtp_Spine);
+DM_PROPERTY_U32(rmtp_SpineLod1, 0, PROFILE_PROPERTY_FRAME_RESET, "# spine components at LOD 1", &rmtp_Spine);
+DM_PROPERTY_U32(rmtp_SpineLod2, 0, PROFILE_PROPERTY_FRAME_RESET, "# spine components at LOD 2", &rmtp_Spine);
+DM_PROPERTY_U32(rmtp_SpineSkinned, 0, PROFILE_PROPERTY_FRAME_RESET, "# spine components skinned on the GPU", &rmtp_Spine);
+DM_PROPERTY_U32(rmtp_SpineGeometryReused, 0, PROFILE_PROPERTY_FRAME_RESET, "# spine components drawn with the vertices of an earlier frame", &rmtp_Spine);
 DM_PROPERTY_U32(rmtp_SpineVertexCount, 0, PROFILE_PROPERTY_FRAME_RESET, "# vertices", &rmtp_Spine);
-DM_PROPERTY_U32(rmtp_SpineVertexSize, 0, PROFILE_PROPERTY_FRAME_RESET, "size of vertices in bytes", &rmtp_Spine);
+DM_PROPERTY_U32(rmtp_SpineVertexSize, 0, PROFILE_PROPERTY_FRAME_RESET, "size of uploaded vertices in bytes", &rmtp_Spine);
 DM_PROPERTY_U32(rmtp_SpineIndexSize, 0, PROFILE_PROPERTY_FRAME_RESET, "size of indices in bytes", &rmtp_Spine);
+DM_PROPERTY_U32(rmtp_SpineFrameGeometrySize, 0, PROFILE_PROPERTY_FRAME_RESET, "size of the per frame geometry in bytes", &rmtp_Spine);
+DM_PROPERTY_U32(rmtp_SpineFrameGeometryPeak, 0, PROFILE_PROPERTY_FRAME_RESET, "peak size of the per frame geometry in bytes", &rmtp_Spine);
+DM_PROPERTY_U32(rmtp_SpineFrameGeometryAverage, 0, PROFILE_PROPERTY_FRAME_RESET, "average size of the per frame geometry in bytes", &rmtp_Spine);
+DM_PROPERTY_U32(rmtp_SpineFrameGeometryGrowth, 0, PROFILE_PROPERTY_FRAME_RESET, "# per frame geometry reallocations", &rmtp_Spine);
+DM_PROPERTY_U32(rmtp_SpineBatches, 0, PROFILE_PROPERTY_FRAME_RESET, "# spine batches", &rmtp_Spine);
+DM_PROPERTY_U32(rmtp_SpineRenderObjects, 0, PROFILE_PROPERTY_FRAME_RESET, "# spine render objects", &rmtp_Spine);
+DM_PROPERTY_U32(rmtp_SpineRenderObjectsReused, 0, PROFILE_PROPERTY_FRAME_RESET, "# spine render objects reused from the previous frame", &rmtp_Spine);
+DM_PROPERTY_U32(rmtp_SpineDataSize, 0, PROFILE_PROPERTY_FRAME_RESET, "size of the loaded spine data in bytes", &rmtp_Spine);
+DM_PROPERTY_U32(rmtp_SpineDataAllocations, 0, PROFILE_PROPERTY_FRAME_RESET, "# spine data allocations", &rmtp_Spine);
+DM_PROPERTY_U32(rmtp_SpineInstanceSize, 0, PROFILE_PROPERTY_FRAME_RESET, "size of the spine instance allocations in bytes", &rmtp_Spine);
+DM_PROPERTY_U32(rmtp_SpineInstanceAllocations, 0, PROFILE_PROPERTY_FRAME_RESET, "# spine instance allocations", &rmtp_Spine);
+DM_PROPERTY_U32(rmtp_SpinePoolSize, 0, PROFILE_PROPERTY_FRAME_RESET, "size of the spine allocation pools in bytes", &rmtp_Spine);
 
 namespace dmSpine
 {
@@ -68,9 +90,21 @@ namespace dmSpine
     static const dmhash_t PROP_CURSOR = dmHashString64("cursor");
     static const dmhash_t PROP_PLAYBACK_RATE = dmHashString64("playback_rate");
     static const dmhash_t PROP_MATERIAL = dmHashString64("material");
+    static const dmhash_t PROP_LOD_THRESHOLD_1 = dmHashString64("lod_threshold_1");
+    static const dmhash_t PROP_LOD_THRESHOLD_2 = dmHashString64("lod_threshold_2");
     static const dmhash_t MATERIAL_EXT_HASH = dmHashString64("materialc");
+    static const dmhash_t SKINNING_BONE_TRANSFORMS = dmHashString64("bone_transforms");
+    static const dmhash_t SKINNING_SLOT_COLORS = dmHashString64("slot_colors");
 
     static const uint32_t INVALID_ANIMATION_INDEX = 0xFFFFFFFF;
+    static const uint32_t INVALID_WORLD_VERTEX_OFFSET = 0xFFFFFFFF;
+    // Smallest number of components handed to an update worker at a time
+    static const uint32_t UPDATE_JOB_MIN_CHUNK_SIZE = 16;
+    // The persistent vertex buffers are rebuilt when less than half of them is in use, above this size
+    static const uint32_t VERTEX_RANGES_MIN_COMPACT_COUNT = 4096;
+    // The vertex buffers are split in segments (see VERTEX_SEGMENT_SIZE) with a graphics buffer each, so that all geometry
+    // is drawn with 16 bit indices. The vertices of a component never cross a segment boundary, unless it has more
+    // vertices than a segment. Those start at a segment, and are drawn per segment (see SpineModelComponent::m_IndexSegments)
     // 1 << 5 gives 32 render objects per overflow block. Keeping the block size
     // a power of two lets us map an overflow index with a shift and a mask.
     static const uint32_t RENDER_OBJECT_OVERFLOW_BLOCK_SHIFT = 5;
@@ -79,27 +113,79 @@ namespace dmSpine
 
     static void ResourceReloadedCallback(const dmResource::ResourceReloadedParams* params);
     static void DestroyComponent(struct SpineModelWorld* world, uint32_t index);
+    static void ReleaseVertexRange(struct SpineModelWorld* world, SpineModelComponent* component);
     static void SpineEventListener(spAnimationState* state, spEventType type, spTrackEntry* entry, spEvent* event);
 
+    // Each CPU skinned component owns a range of one of the vertex buffers, which is kept between frames and
+    // only rewritten when the component's geometry changes. Ranges that outgrow their place are moved to the end.
+    // The dynamic vertices of the GPU skinned components are regenerated every frame, and are all dirty
+    struct SpineVertexRanges
+    {
+        dmArray<dmGraphics::HVertexBuffer>      m_SegmentBuffers;
+        dmArray<uint32_t>                       m_UploadedCounts;   // The size of each segment's graphics buffer, in vertices
+        uint32_t                                m_LiveCount;        // Vertices owned by components, the rest are left by moved ranges
+        uint32_t                                m_DirtyStart;       // The vertices changed since the last upload
+        uint32_t                                m_DirtyEnd;
+    };
+
+    // The render object state that only changes with the batch (see FillRenderObject)
+    struct SpineRenderObjectKey
+    {
+        dmGraphics::HVertexDeclaration          m_VertexDeclaration;
+        dmGraphics::HVertexBuffer               m_VertexBuffer;
+        dmGraphics::HTexture                    m_Texture;
+        dmRender::HMaterial                     m_Material;
+        dmGameSystem::HComponentRenderConstants m_Constants;
+        uint32_t                                m_BatchKey;         // The m_MixedHash of the first component
+        uint32_t                                m_BlendMode;
+    };
+
+    // The high-water marks of the geometry that is rebuilt every frame: the attachment vertices, the indices and the
+    // dynamic vertices of the GPU skinned components. The arrays are reserved from them before they're filled
+    // (see ReserveFrameGeometry), so that they don't have to grow while rendering once the usage is stable
+    struct SpineFrameGeometry
+    {
+        uint32_t                                m_WorldVertexCount;
+        uint32_t                                m_IndexCount;
+        uint32_t                                m_SkinnedVertexCount;
+        uint32_t                                m_ReservedSize;     // Bytes, when the arrays were last reserved
+        uint32_t                                m_PeakSize;         // Bytes
+        uint32_t                                m_AverageSize;      // Bytes, a moving average over the recent frames
+    };
+
     struct SpineModelWorld
     {
         dmObjectPool<SpineModelComponent*>      m_Components;
         dmArray<dmRender::RenderObject>         m_RenderObjects;
         dmArray<dmRender::RenderObject*>        m_RenderObjectOverflowBlocks;
+        dmArray<SpineRenderObjectKey>           m_RenderObjectKeys;     // Per render object (also the overflow), as last filled
         dmArray<dmSpine::SpineModelBounds>      m_BoundingBoxes;
+        dmArray<uint32_t>                       m_WorldVertexOffsets;   // Per component offset into m_WorldVertices
+        dmArray<float>                          m_WorldVertices;        // The attachment vertices of this frame, shared by the culling and the geometry
         dmArray<float>                           m_GeometryScratch;
         dmGraphics::HVertexDeclaration          m_VertexDeclaration;
-        dmGraphics::HVertexBuffer               m_VertexBuffer;
+        dmGraphics::HVertexDeclaration          m_CompactVertexDeclaration;
+        dmGraphics::HVertexDeclaration          m_SkinnedVertexDeclaration;
         dmGraphics::HIndexBuffer                m_IndexBuffer;
         dmArray<dmSpine::SpineVertex>           m_VertexBufferData;
-        dmArray<uint32_t>                       m_IndexBufferData;
-        dmArray<uint8_t>                        m_PackedIndexBufferData;
+        dmArray<dmSpine::SpineCompactVertex>    m_CompactVertexBufferData;
+        dmArray<dmSpine::SpineSkinnedVertex>    m_SkinnedVertexBufferData;  // The CPU fallback of the GPU skinned components
+        SpineVertexRanges                       m_VertexRanges;
+        SpineVertexRanges                       m_CompactVertexRanges;
+        SpineVertexRanges                       m_SkinnedVertexRanges;
+        dmArray<Vector4>                        m_SkinningConstants;
+        dmArray<uint16_t>                       m_IndexBufferData;          // Relative to the vertex segment of each render object
         dmArray<SpineIndexedDrawDesc>           m_DrawDescBuffer;
         dmArray<SpineIndexedDrawDesc>           m_MergedDrawDescBuffer;
+        dmArray<SpineSkinnedDrawDesc>           m_SkinnedDrawDescBuffer;
+        dmArray<SpineModelComponent*>           m_UpdateList;
+        dmArray<SpinePose*>                     m_PoseEvalList;
         dmResource::HFactory                    m_Factory;
+        dmGraphics::HContext                    m_GraphicsContext;
         spSkeletonClipping*                     m_SkeletonClipper;
+        SpineFrameGeometry                      m_FrameGeometry;
         uint32_t                                m_RenderObjectsInUse;
-        uint8_t                                 m_Is16BitIndex : 1;
+        uint8_t                                 m_ReuseRenderObjects:1; // See FillRenderObject
     };
 
     struct SpineModelContext
@@ -111,7 +197,12 @@ namespace dmSpine
         dmResource::HFactory        m_Factory;
         dmRender::HRenderContext    m_RenderContext;
         dmGraphics::HContext        m_GraphicsContext;
+        HJobPool                    m_UpdateJobPool;
         uint32_t                    m_MaxSpineModelCount;
+        uint32_t                    m_CulledUpdateInterval;
+        float                       m_BatchDepthTolerance;
+        uint32_t                    m_LodUpdateIntervals[SPINE_LOD_COUNT - 1];
+        uint8_t                     m_ReuseRenderObjects:1;
     };
 
     dmGameObject::CreateResult CompSpineModelNewWorld(const dmGameObject::ComponentNewWorldParams& params)
@@ -120,6 +211,7 @@ namespace dmSpine
         //dmRender::HRenderContext render_context = context->m_RenderContext;
         SpineModelWorld* world = new SpineModelWorld();
         world->m_Factory = context->m_Factory;
+        world->m_GraphicsContext = context->m_GraphicsContext;
 
         uint32_t comp_count = dmMath::Min(params.m_MaxComponentInstances, context->m_MaxSpineModelCount);
 
@@ -130,7 +222,10 @@ namespace dmSpine
         world->m_RenderObjects.SetCapacity(comp_count);
         world->m_BoundingBoxes.SetCapacity(comp_count);
         world->m_BoundingBoxes.SetSize(comp_count);
+        world->m_WorldVertexOffsets.SetCapacity(comp_count);
+        world->m_WorldVertexOffsets.SetSize(comp_count);
         world->m_RenderObjectsInUse = 0;
+        world->m_ReuseRenderObjects = context->m_ReuseRenderObjects;
 
         dmGraphics::HVertexStreamDeclaration stream_declaration = dmGraphics::NewVertexStreamDeclaration(context->m_GraphicsContext);
         dmGraphics::AddVertexStream(stream_declaration, "position", 3, dmGraphics::TYPE_FLOAT, false);
@@ -138,10 +233,33 @@ namespace dmSpine
         dmGraphics::AddVertexStream(stream_declaration, "color", 4, dmGraphics::TYPE_FLOAT, true);
         dmGraphics::AddVertexStream(stream_declaration, "page_index", 1, dmGraphics::TYPE_FLOAT, false);
 
+        // The vertex buffers are created per segment, when needed (see GetSegmentVertexBuffer)
         world->m_VertexDeclaration = dmGraphics::NewVertexDeclaration(context->m_GraphicsContext, stream_declaration);
-        world->m_VertexBuffer = dmGraphics::NewVertexBuffer(context->m_GraphicsContext, 0, 0, dmGraphics::BUFFER_USAGE_DYNAMIC_DRAW);
         world->m_IndexBuffer = dmGraphics::NewIndexBuffer(context->m_GraphicsContext, 0, 0, dmGraphics::BUFFER_USAGE_DYNAMIC_DRAW);
-        world->m_Is16BitIndex = 1;
+
+        dmGraphics::DeleteVertexStreamDeclaration(stream_declaration);
+
+        // The same attributes as above, in the SpineCompactVertex layout
+        stream_declaration = dmGraphics::NewVertexStreamDeclaration(context->m_GraphicsContext);
+        dmGraphics::AddVertexStream(stream_declaration, "position", 3, dmGraphics::TYPE_FLOAT, false);
+        dmGraphics::AddVertexStream(stream_declaration, "texcoord0", 2, dmGraphics::TYPE_UNSIGNED_SHORT, true);
+        dmGraphics::AddVertexStream(stream_declaration, "color", 4, dmGraphics::TYPE_UNSIGNED_BYTE, true);
+
+        world->m_CompactVertexDeclaration = dmGraphics::NewVertexDeclaration(context->m_GraphicsContext, stream_declaration);
+
+        dmGraphics::DeleteVertexStreamDeclaration(stream_declaration);
+
+        // The SpineSkinnedVertex layout, used with the skinning shader (spine_skinned.vp)
+        stream_declaration = dmGraphics::NewVertexStreamDeclaration(context->m_GraphicsContext);
+        dmGraphics::AddVertexStream(stream_declaration, "position0", 4, dmGraphics::TYPE_FLOAT, false);
+        dmGraphics::AddVertexStream(stream_declaration, "position1", 4, dmGraphics::TYPE_FLOAT, false);
+        dmGraphics::AddVertexStream(stream_declaration, "weights", 4, dmGraphics::TYPE_FLOAT, false);
+        dmGraphics::AddVertexStream(stream_declaration, "bone_indices", 4, dmGraphics::TYPE_UNSIGNED_BYTE, false);
+        dmGraphics::AddVertexStream(stream_declaration, "texcoord0", 2, dmGraphics::TYPE_FLOAT, false);
+        dmGraphics::AddVertexStream(stream_declaration, "color", 4, dmGraphics::TYPE_UNSIGNED_BYTE, true);
+        dmGraphics::AddVertexStream(stream_declaration, "slot_index", 1, dmGraphics::TYPE_FLOAT, false);
+
+        world->m_SkinnedVertexDeclaration = dmGraphics::NewVertexDeclaration(context->m_GraphicsContext, stream_declaration);
 
         dmGraphics::DeleteVertexStreamDeclaration(stream_declaration);
 
@@ -154,6 +272,16 @@ namespace dmSpine
         return dmGameObject::CREATE_RESULT_OK;
     }
 
+    static void DeleteSegmentVertexBuffers(SpineVertexRanges& ranges)
+    {
+        for (uint32_t i = 0; i < ranges.m_SegmentBuffers.Size(); ++i)
+        {
+            dmGraphics::DeleteVertexBuffer(ranges.m_SegmentBuffers[i]);
+        }
+        ranges.m_SegmentBuffers.SetSize(0);
+        ranges.m_UploadedCounts.SetSize(0);
+    }
+
     dmGameObject::CreateResult CompSpineModelDeleteWorld(const dmGameObject::ComponentDeleteWorldParams& params)
     {
         SpineModelWorld* world = (SpineModelWorld*)params.m_World;
@@ -162,7 +290,11 @@ namespace dmSpine
             delete[] world->m_RenderObjectOverflowBlocks[i];
         }
         dmGraphics::DeleteVertexDeclaration(world->m_VertexDeclaration);
-        dmGraphics::DeleteVertexBuffer(world->m_VertexBuffer);
+        dmGraphics::DeleteVertexDeclaration(world->m_CompactVertexDeclaration);
+        dmGraphics::DeleteVertexDeclaration(world->m_SkinnedVertexDeclaration);
+        DeleteSegmentVertexBuffers(world->m_VertexRanges);
+        DeleteSegmentVertexBuffers(world->m_CompactVertexRanges);
+        DeleteSegmentVertexBuffers(world->m_SkinnedVertexRanges);
         dmGraphics::DeleteIndexBuffer(world->m_IndexBuffer);
 
         dmResource::UnregisterResourceReloadedCallback(((SpineModelContext*)params.m_Context)->m_Factory, ResourceReloadedCallback, world);
@@ -184,6 +316,83 @@ namespace dmSpine
         return component->m_SpineScene ? component->m_SpineScene : component->m_Resource->m_SpineScene;
     }
 
+    // The skeleton to render, which is the shared pose if the instance uses one
+    static inline spSkeleton* GetRenderSkeleton(const SpineModelComponent* component) {
+        // The pose is gone if the cache was reset after the last update
+        if (component->m_Pose && component->m_PoseGeneration == GetSpineScene(component)->m_PoseCacheGeneration)
+            return component->m_Pose->m_Skeleton;
+        return component->m_SkeletonInstance;
+    }
+
+    static void ReleaseSharedPose(SpineModelComponent* component, bool copy_pose)
+    {
+        if (!component->m_Pose)
+            return;
+
+        SpineSceneResource* spine_scene = GetSpineScene(component);
+        // If the cache has been reset since, the pose is already gone
+        if (component->m_PoseGeneration == spine_scene->m_PoseCacheGeneration)
+        {
+            // Our own skeleton hasn't been posed while sharing, so continue from the shared pose
+            if (copy_pose)
+                CopyPose(component->m_Pose->m_Skeleton, component->m_SkeletonInstance);
+            ReleasePose(spine_scene, component->m_Pose);
+        }
+        component->m_Pose = 0;
+    }
+
+    // Called before modifying the skeleton instance in ways that the shared poses don't know about
+    static void MakePoseUnique(SpineModelComponent* component)
+    {
+        ReleaseSharedPose(component, true);
+        component->m_PoseOverridden = 1;
+    }
+
+    static bool CanSharePose(SpineModelComponent* component)
+    {
+        return component->m_Resource->m_Ddf->m_PoseCacheStep > 0.0f
+            && !component->m_PoseOverridden
+            && component->m_IKTargets.Empty()
+            && component->m_IKTargetPositions.Empty()
+            // The bone game objects (and spine.get_go) follow the skeleton instance, which isn't posed while sharing
+            && !component->m_Resource->m_CreateGoBones
+            && component->m_BoneInstances.Empty()
+            && component->m_SkeletonInstance->physicsConstraintsCount == 0;
+    }
+
+    static inline bool UseGpuSkinning(const SpineModelComponent* component) {
+        return component->m_Resource->m_Ddf->m_Skinning == dmGameSystemDDF::SpineModelDesc::SKINNING_GPU;
+    }
+
+    // Scenes built before the animation bounds were added to the .spinescenec fall back to the pose bounds
+    static inline bool UseAnimationBounds(const SpineModelComponent* component) {
+        return component->m_Resource->m_Ddf->m_CullingBounds == dmGameSystemDDF::SpineModelDesc::CULLING_BOUNDS_ANIMATION
+            && GetSpineScene(component)->m_AnimationBounds != 0;
+    }
+
+    // The union of the bounds of the animations on the tracks (also those being mixed out), and of the setup pose,
+    // which covers the empty animations and the bones that aren't keyed
+    static void GetAnimationStateBounds(SpineModelComponent* component, SpineModelBounds& bounds)
+    {
+        const SpineAnimationBounds* animation_bounds = GetSpineScene(component)->m_AnimationBounds;
+        bounds = animation_bounds->m_SetupPose;
+
+        const spAnimationState* state = component->m_AnimationStateInstance;
+        for (int t = 0; t < state->tracksCount; ++t)
+        {
+            for (const spTrackEntry* entry = state->tracks[t]; entry; entry = entry->mixingFrom)
+            {
+                const SpineModelBounds* track_bounds = animation_bounds->m_AnimationToBounds.Get((uintptr_t)entry->animation);
+                if (!track_bounds)
+                    continue;
+                bounds.minX = dmMath::Min(bounds.minX, track_bounds->minX);
+                bounds.minY = dmMath::Min(bounds.minY, track_bounds->minY);
+                bounds.maxX = dmMath::Max(bounds.maxX, track_bounds->maxX);
+                bounds.maxY = dmMath::Max(bounds.maxY, track_bounds->maxY);
+            }
+        }
+    }
+
     static void ReHash(SpineModelComponent* component)
     {
         // material, texture set, blend mode and render constants
@@ -198,8 +407,13 @@ namespace dmSpine
         dmHashUpdateBuffer32(&state, &material, sizeof(material));
         dmHashUpdateBuffer32(&state, &texture_set, sizeof(texture_set));
         dmHashUpdateBuffer32(&state, &ddf->m_BlendMode, sizeof(ddf->m_BlendMode));
+        dmHashUpdateBuffer32(&state, &ddf->m_VertexFormat, sizeof(ddf->m_VertexFormat));
+        dmHashUpdateBuffer32(&state, &ddf->m_DrawOrder, sizeof(ddf->m_DrawOrder));
         if (component->m_RenderConstants)
             dmGameSystem::HashRenderConstants(component->m_RenderConstants, &state);
+        // Each instance has its own bone transforms, so it can't be batched with others
+        if (UseGpuSkinning(component))
+            dmHashUpdateBuffer32(&state, &component, sizeof(component));
         component->m_MixedHash = dmHashFinal32(&state);
         component->m_ReHash = 0;
     }
@@ -466,6 +680,7 @@ namespace dmSpine
         ClearCompletionCallback(component, &track);
 
         track.m_AnimationId = animation_id;
+        AccountScope account_scope(&spine_scene->m_InstanceAccount);
         track.m_AnimationInstance = spAnimationState_setAnimation(component->m_AnimationStateInstance, track_index, animation, loop);
 
         track.m_Playback = playback;
@@ -484,6 +699,8 @@ namespace dmSpine
 
     static bool SetupComponentFromScene(SpineModelWorld* world, SpineModelComponent* component, SpineSceneResource* spine_scene, bool create_bones, bool play_default_animation)
     {
+        // The instances are charged to the scene, see spine.get_memory_stats()
+        AccountScope account_scope(&spine_scene->m_InstanceAccount);
         component->m_SkeletonInstance = spSkeleton_create(spine_scene->m_Skeleton);
         if (!component->m_SkeletonInstance)
         {
@@ -496,6 +713,10 @@ namespace dmSpine
             spSkeleton_setSkin(component->m_SkeletonInstance, spine_scene->m_Skeleton->defaultSkin);
         }
         spSkeleton_setSlotsToSetupPose(component->m_SkeletonInstance);
+        component->m_PoseOverridden = 0;
+        component->m_VisibilityTested = 0; // Make sure the new skeleton is posed at least once
+        component->m_BoundsValid = 0;
+        component->m_GeometryValid = 0;
 
         component->m_AnimationStateInstance = spAnimationState_create(spine_scene->m_AnimationStateData);
         if (!component->m_AnimationStateInstance)
@@ -542,6 +763,7 @@ namespace dmSpine
         if (!track || !track->m_AnimationInstance)
             return;
 
+        AccountScope account_scope(&GetSpineScene(component)->m_InstanceAccount);
         spAnimationState_clearTrack(component->m_AnimationStateInstance, track->m_AnimationInstance->trackIndex);
 
         ClearCompletionCallback(component, track);
@@ -572,9 +794,9 @@ namespace dmSpine
         return false;
     }
 
-    static void SendAnimationDone(SpineModelComponent* component, const spAnimationState* state, const spTrackEntry* entry, const spEvent* event)
+    static void SendAnimationDone(SpineModelComponent* component, int track_index, const spAnimation* animation)
     {
-        SpineAnimationTrack& track = component->m_AnimationTracks[entry->trackIndex];
+        SpineAnimationTrack& track = component->m_AnimationTracks[track_index];
 
         dmMessage::URL sender;
         dmMessage::URL receiver = track.m_Listener;
@@ -586,9 +808,9 @@ namespace dmSpine
         }
 
         dmGameSystemDDF::SpineAnimationDone message;
-        message.m_AnimationId = dmHashString64(entry->animation->name);
+        message.m_AnimationId = dmHashString64(animation->name);
         message.m_Playback    = track.m_Playback;
-        message.m_Track       = entry->trackIndex + 1;
+        message.m_Track       = track_index + 1;
 
         if (track.m_CallbackInfo)
         {
@@ -614,9 +836,9 @@ namespace dmSpine
         }
     }
 
-    static void SendSpineEvent(SpineModelComponent* component, const spAnimationState* state, const spTrackEntry* entry, const spEvent* event)
+    static void SendSpineEvent(SpineModelComponent* component, int track_index, const spAnimation* animation, const spEvent* event)
     {
-        SpineAnimationTrack& track = component->m_AnimationTracks[entry->trackIndex];
+        SpineAnimationTrack& track = component->m_AnimationTracks[track_index];
 
         dmMessage::URL sender;
         dmMessage::URL receiver = track.m_Listener;
@@ -634,7 +856,7 @@ namespace dmSpine
         }
 
         dmGameSystemDDF::SpineEvent message;
-        message.m_AnimationId = dmHashString64(entry->animation->name);
+        message.m_AnimationId = dmHashString64(animation->name);
         message.m_EventId     = dmHashString64(event->data->name);
         message.m_BlendWeight = 0.0f;//keyframe_event->m_BlendWeight;
         message.m_T           = event->time;
@@ -643,7 +865,7 @@ namespace dmSpine
         message.m_String      = dmHashString64(event->stringValue?event->stringValue:"");
         message.m_Node.m_Ref  = 0;
         message.m_Node.m_ContextTableRef = 0;
-        message.m_Track       = entry->trackIndex + 1;
+        message.m_Track       = track_index + 1;
 
         if (track.m_CallbackInfo)
         {
@@ -654,15 +876,111 @@ namespace dmSpine
             dmGameObject::Result result = dmGameObject::PostDDF(&message, &sender, &receiver, 0, false);
             if (result != dmGameObject::RESULT_OK)
             {
-                dmLogError("Could not send animation event '%s' from animation '%s' to listener: %d", entry->animation->name, event->data->name, result);
+                dmLogError("Could not send animation event '%s' from animation '%s' to listener: %d", animation->name, event->data->name, result);
+            }
+        }
+    }
+
+    static void OnAnimationComplete(SpineModelComponent* component, int track_index, const spAnimation* animation)
+    {
+        SpineAnimationTrack& track = component->m_AnimationTracks[track_index];
+
+        // Should we look at the looping state?
+        if (!IsLooping(track.m_Playback))
+        {
+            // We only send the event if it's not looping (same behavior as before)
+            SendAnimationDone(component, track_index, animation);
+        }
+
+        if (IsPingPong(track.m_Playback) && track.m_AnimationInstance)
+        {
+            track.m_AnimationInstance->reverse = !track.m_AnimationInstance->reverse;
+        }
+    }
+
+    // Called from an update worker thread. We may only touch the component itself here,
+    // anything involving messages, Lua or other game objects is done in DispatchDeferredEvents()
+    static void DeferSpineEvent(SpineModelComponent* component, spEventType type, spTrackEntry* entry, spEvent* event)
+    {
+        SpineDeferredEvent deferred;
+        deferred.m_Animation = entry->animation;
+        deferred.m_Event = event;
+        deferred.m_Type = type;
+        deferred.m_TrackIndex = entry->trackIndex;
+        deferred.m_CallbackId = 0;
+
+        switch (type)
+        {
+            case SP_ANIMATION_COMPLETE:
+                // See SpineEventListener()
+                if (entry->mixingTo != 0)
+                    return;
+                break;
+            case SP_ANIMATION_DISPOSE:
+            {
+                // The entry is disposed (and may be reused) as soon as we return, so the track is detached right away.
+                // The callback itself is released on the main thread.
+                SpineAnimationTrack* track = GetTrackFromIndex(component, entry->trackIndex);
+                if (!track || track->m_AnimationInstance != entry)
+                    return;
+                track->m_AnimationInstance = nullptr;
+                deferred.m_CallbackId = track->m_CallbackId;
+                break;
+            }
+            case SP_ANIMATION_EVENT:
+                break;
+            default:
+                return;
+        }
+
+        if (component->m_DeferredEvents.Full())
+        {
+            component->m_DeferredEvents.OffsetCapacity(dmMath::Max(8U, component->m_DeferredEvents.Capacity()));
+        }
+        component->m_DeferredEvents.Push(deferred);
+    }
+
+    static void DispatchDeferredEvents(SpineModelComponent* component)
+    {
+        // Note that the callbacks may play new animations, which in turn may add new events
+        for (uint32_t i = 0; i < component->m_DeferredEvents.Size(); ++i)
+        {
+            SpineDeferredEvent deferred = component->m_DeferredEvents[i];
+            switch (deferred.m_Type)
+            {
+                case SP_ANIMATION_COMPLETE:
+                    OnAnimationComplete(component, deferred.m_TrackIndex, deferred.m_Animation);
+                    break;
+                case SP_ANIMATION_DISPOSE:
+                {
+                    // Unless a callback has already started a new animation on this track
+                    SpineAnimationTrack* track = GetTrackFromIndex(component, deferred.m_TrackIndex);
+                    if (track && !track->m_AnimationInstance && track->m_CallbackId == deferred.m_CallbackId)
+                    {
+                        ClearCompletionCallback(component, track);
+                    }
+                    break;
+                }
+                case SP_ANIMATION_EVENT:
+                    SendSpineEvent(component, deferred.m_TrackIndex, deferred.m_Animation, deferred.m_Event);
+                    break;
+                default:
+                    break;
             }
         }
+        component->m_DeferredEvents.SetSize(0);
     }
 
     static void SpineEventListener(spAnimationState* state, spEventType type, spTrackEntry* entry, spEvent* event)
     {
         SpineModelComponent* component = (SpineModelComponent*)state->userData;
 
+        if (component->m_DeferEvents)
+        {
+            DeferSpineEvent(component, type, entry, event);
+            return;
+        }
+
         // Events are explained here: http://esotericsoftware.com/spine-api-reference#AnimationStateListener
         switch (type)
         {
@@ -691,19 +1009,7 @@ namespace dmSpine
                     return;
                 }
 
-                SpineAnimationTrack& track = component->m_AnimationTracks[entry->trackIndex];
-
-                // Should we look at the looping state?
-                if (!IsLooping(track.m_Playback))
-                {
-                    // We only send the event if it's not looping (same behavior as before)
-                    SendAnimationDone(component, state, entry, event);
-                }
-
-                if (IsPingPong(track.m_Playback))
-                {
-                    track.m_AnimationInstance->reverse = !track.m_AnimationInstance->reverse;
-                }
+                OnAnimationComplete(component, entry->trackIndex, entry->animation);
                 break;
             }
             case SP_ANIMATION_DISPOSE:
@@ -717,7 +1023,7 @@ namespace dmSpine
                 break;
             }
             case SP_ANIMATION_EVENT:
-                SendSpineEvent(component, state, entry, event);
+                SendSpineEvent(component, entry->trackIndex, entry->animation, event);
                 break;
             default:
                 break;
@@ -750,6 +1056,8 @@ namespace dmSpine
         component->m_World = Matrix4::identity();
         component->m_DoRender = 0;
         component->m_RenderConstants = 0;
+        component->m_LodThresholds[0] = spine_model->m_Ddf->m_LodThreshold1;
+        component->m_LodThresholds[1] = spine_model->m_Ddf->m_LodThreshold2;
 
         if (!SetupComponentFromScene(world, component, spine_scene, spine_model->m_CreateGoBones, true))
         {
@@ -775,6 +1083,12 @@ namespace dmSpine
         component->m_BoneInstances.SetCapacity(0);
         component->m_AnimationTracks.SetCapacity(0);
         component->m_DeferredCallbacks.SetCapacity(0);
+        component->m_DeferredEvents.SetCapacity(0);
+        component->m_Indices.SetCapacity(0);
+        component->m_DrawDescs.SetCapacity(0);
+        component->m_IndexSegments.SetCapacity(0);
+        ReleaseVertexRange(world, component);
+        ReleaseSharedPose(component, false);
         if (component->m_Material)
         {
             dmResource::Release(world->m_Factory, (void*)component->m_Material);
@@ -787,6 +1101,10 @@ namespace dmSpine
         {
             dmGameSystem::DestroyRenderConstants(component->m_RenderConstants);
         }
+        if (component->m_SkinningConstants)
+        {
+            dmRender::DeleteNamedConstantBuffer(component->m_SkinningConstants);
+        }
 
         if (component->m_AnimationStateInstance)
             spAnimationState_dispose(component->m_AnimationStateInstance);
@@ -833,7 +1151,8 @@ namespace dmSpine
         return dmGameObject::CREATE_RESULT_OK;
     }
 
-    static void ApplyIKTargets(SpineModelComponent* component)
+    // Converts the IK target positions into model space. Reads game object transforms, so it must run on the main thread
+    static void PrepareIKTargets(SpineModelComponent* component)
     {
         uint32_t count = component->m_IKTargetPositions.Size();
         uint32_t instance_count = component->m_IKTargets.Size();
@@ -845,301 +1164,1257 @@ namespace dmSpine
 
         for (uint32_t i = 0; i < count; ++i)
         {
-            const IKTarget& target = component->m_IKTargetPositions[i];
-            dmVMath::Vector3 model_pos = (dmVMath::Vector3)dmTransform::Apply(world_to_model, target.m_Position);
+            IKTarget& target = component->m_IKTargetPositions[i];
+            target.m_Position = dmTransform::Apply(world_to_model, target.m_Position);
+        }
+
+        for (uint32_t i = 0; i < instance_count; ++i)
+        {
+            IKTarget& target = component->m_IKTargets[i];
+            target.m_Position = dmTransform::Apply(world_to_model, dmGameObject::GetWorldPosition(target.m_Target));
+        }
+    }
 
-            target.m_Constraint->target->x = model_pos.getX();
-            target.m_Constraint->target->y = model_pos.getY();
+    // Expects the positions to have been converted by PrepareIKTargets()
+    static void ApplyIKTargets(SpineModelComponent* component)
+    {
+        uint32_t count = component->m_IKTargetPositions.Size();
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            const IKTarget& target = component->m_IKTargetPositions[i];
+            target.m_Constraint->target->x = target.m_Position.getX();
+            target.m_Constraint->target->y = target.m_Position.getY();
         }
         component->m_IKTargetPositions.SetSize(0);
 
+        uint32_t instance_count = component->m_IKTargets.Size();
         for (uint32_t i = 0; i < instance_count; ++i)
         {
             const IKTarget& target = component->m_IKTargets[i];
+            target.m_Constraint->target->x = target.m_Position.getX();
+            target.m_Constraint->target->y = target.m_Position.getY();
+        }
+    }
 
-            dmVMath::Vector3 model_pos = (dmVMath::Vector3)dmTransform::Apply(world_to_model, dmGameObject::GetWorldPosition(target.m_Target));
+    // Uses the visibility from the last rendered frame
+    static bool ShouldSkipPose(SpineModelComponent* component, uint32_t culled_update_interval)
+    {
+        bool culled = component->m_VisibilityTested && !component->m_Visible;
+        if (!culled)
+        {
+            component->m_CulledFrameCount = 0;
+            return false;
+        }
 
-            target.m_Constraint->target->x = model_pos.getX();
-            target.m_Constraint->target->y = model_pos.getY();
+        switch (component->m_Resource->m_Ddf->m_CulledUpdate)
+        {
+        case dmGameSystemDDF::SpineModelDesc::CULLED_UPDATE_EVENTS_ONLY:
+            return true;
+        case dmGameSystemDDF::SpineModelDesc::CULLED_UPDATE_REDUCED_RATE:
+            return (component->m_CulledFrameCount++ % culled_update_interval) != 0;
+        default:
+            return false;
         }
     }
 
+    // Picks the LOD from the screen size in the last rendered frame, and accumulates the time of the skipped frames.
+    // The size is measured by the frustum culling, so the model stays at full detail if it's drawn without a frustum.
+    // Returns false if the skeleton isn't updated this frame
+    static bool UpdateLod(SpineModelContext* context, SpineModelComponent* component, float dt)
+    {
+        uint32_t lod = 0;
+        if (component->m_Visible) // Culled components are handled by the culled_update policy
+        {
+            if (component->m_ScreenSize < component->m_LodThresholds[1])
+                lod = 2;
+            else if (component->m_ScreenSize < component->m_LodThresholds[0])
+                lod = 1;
+        }
+        else if (!component->m_VisibilityTested && component->m_ScreenSize < 0.0f
+                 && (component->m_LodThresholds[0] > 0.0f || component->m_LodThresholds[1] > 0.0f))
+        {
+            static bool warned = false;
+            if (!warned)
+            {
+                dmLogWarning("A spine model with lod thresholds is drawn without a frustum, so its screen size is unknown and the lod isn't used. "
+                             "Pass a frustum to render.draw() (e.g. { frustum = proj * view }) to enable it.");
+                warned = true;
+            }
+        }
 
-    dmGameObject::UpdateResult CompSpineModelLateUpdate(const dmGameObject::ComponentsUpdateParams& params, dmGameObject::ComponentsUpdateResult& update_result)
+        if (lod != component->m_Lod)
+        {
+            component->m_Lod = lod;
+            component->m_LodFrameCount = 0;
+        }
+
+        component->m_LodTime += dt;
+        component->m_SkipConstraints = lod != 0 && component->m_Resource->m_Ddf->m_LodDisableConstraints;
+
+        uint32_t interval = lod == 0 ? 1 : context->m_LodUpdateIntervals[lod - 1];
+        if ((component->m_LodFrameCount++ % interval) != 0)
+            return false;
+
+        component->m_UpdateDT = component->m_LodTime;
+        component->m_LodTime = 0.0f;
+        return true;
+    }
+
+    // The functions below only touch the component's own spine data, which makes them safe to call from an update worker
+
+    // Plays back the bone transforms from the baked data, if there is a single unmixed animation playing.
+    // Returns false if the animation state must be applied as usual
+    static bool ApplyBakedAnimationState(SpineModelComponent* component)
     {
-        SpineModelWorld* world = (SpineModelWorld*)params.m_World;
+        SpineSceneResource* spine_scene = GetSpineScene(component);
+        if (!spine_scene->m_BakedAnimations || component->m_AnimationTracks.Empty())
+            return false;
 
-        float dt = params.m_UpdateContext->m_DT;
+        spAnimationState* state = component->m_AnimationStateInstance;
+        const SpineAnimationTrack& track = component->m_AnimationTracks[0];
+        spTrackEntry* entry = track.m_AnimationInstance;
+        if (!entry || state->tracksCount == 0 || state->tracks[0] != entry)
+            return false;
 
-        dmArray<SpineModelComponent*>& components = world->m_Components.GetRawObjects();
-        const uint32_t count = components.Size();
-        DM_PROPERTY_ADD_U32(rmtp_SpineComponents, count);
-        bool transforms_updated = false;
-        for (uint32_t i = 0; i < count; ++i)
+        const BakedAnimation** baked = spine_scene->m_BakedAnimationNameToData.Get(track.m_AnimationId);
+        if (!baked)
+            return false;
+
+        // The listeners may change the track while the events are dispatched
+        float time = spTrackEntry_getAnimationTime(entry);
+        if (entry->reverse)
+            time = entry->animation->duration - time;
+
+        // Applies the remaining timelines (and events), unless the track is mixed
+        if (!spAnimationState_applyWithoutBoneTransforms(state, component->m_SkeletonInstance))
+            return false;
+
+        ApplyBakedAnimation(spine_scene->m_BakedAnimations, *baked, component->m_SkeletonInstance, time);
+        return true;
+    }
+
+    static void PoseSkeleton(SpineModelComponent* component, float dt)
+    {
+        if (!ApplyBakedAnimationState(component))
+            spAnimationState_apply(component->m_AnimationStateInstance, component->m_SkeletonInstance);
+
+        ApplyIKTargets(component);
+
+        spSkeleton_update(component->m_SkeletonInstance, dt);
+        if (component->m_SkipConstraints)
+            spSkeleton_updateWorldTransformWithoutConstraints(component->m_SkeletonInstance);
+        else
+            spSkeleton_updateWorldTransform(component->m_SkeletonInstance, SP_PHYSICS_UPDATE);
+    }
+
+    // Fires the events of the current frame, but leaves the skeleton in its last pose.
+    // Returns false if the skeleton needs to be posed anyway (e.g. while mixing)
+    static bool SkipPose(SpineModelComponent* component, float dt)
+    {
+        if (!spAnimationState_applyEvents(component->m_AnimationStateInstance))
         {
-            SpineModelComponent& component = *components[i];
-            component.m_DoRender = 0;
+            component->m_SkipPose = 0;
+            return false;
+        }
+        spSkeleton_update(component->m_SkeletonInstance, dt);
+        return true;
+    }
 
-            if (!component.m_SkeletonInstance || !component.m_AnimationStateInstance)
-            {
-                component.m_Enabled = false;
-            }
+    static void EvaluateSkeleton(SpineModelComponent* component, float dt)
+    {
+        AccountScope account_scope(&GetSpineScene(component)->m_InstanceAccount);
+        // docs: http://esotericsoftware.com/spine-runtime-skeletons
+        spAnimationState_update(component->m_AnimationStateInstance, dt);
+        if (component->m_SkipPose && SkipPose(component, dt))
+            return;
+        PoseSkeleton(component, dt);
+    }
 
-            if (!component.m_Enabled || !component.m_AddedToUpdate)
-                continue;
+    // Advances the animation state, and checks if the resulting pose can be shared with other instances.
+    // If it can't, the skeleton is evaluated as usual
+    static void EvaluateSharedSkeleton(SpineModelComponent* component, float dt)
+    {
+        AccountScope account_scope(&GetSpineScene(component)->m_InstanceAccount);
+        spAnimationState_update(component->m_AnimationStateInstance, dt);
 
-            const Matrix4& go_world = dmGameObject::GetWorldMatrix(component.m_Instance);
-            const Matrix4 local = dmTransform::ToMatrix4(component.m_Transform);
-            component.m_World = go_world * local;
+        // Keeps the current shared pose
+        if (component->m_SkipPose && SkipPose(component, dt))
+            return;
+
+        float time_step = component->m_Resource->m_Ddf->m_PoseCacheStep;
+        if (MakePoseDesc(component->m_AnimationStateInstance, component->m_SkeletonInstance->skin, time_step, &component->m_PoseDesc))
+        {
+            component->m_PoseCandidate = 1;
+            return;
+        }
 
-            // docs: http://esotericsoftware.com/spine-runtime-skeletons
-            spAnimationState_update(component.m_AnimationStateInstance, dt);
-            spAnimationState_apply(component.m_AnimationStateInstance, component.m_SkeletonInstance);
+        // The shared poses are not modified during this pass
+        if (component->m_Pose)
+            CopyPose(component->m_Pose->m_Skeleton, component->m_SkeletonInstance);
+        PoseSkeleton(component, dt);
+    }
 
-            ApplyIKTargets(&component);
+    struct EvaluateSkeletonsJobContext
+    {
+        SpineModelComponent** m_Components;
+    };
 
-            spSkeleton_update(component.m_SkeletonInstance, dt);
-            spSkeleton_updateWorldTransform(component.m_SkeletonInstance, SP_PHYSICS_UPDATE);
+    static void EvaluateSkeletonsJob(void* _context, uint32_t begin, uint32_t end)
+    {
+        EvaluateSkeletonsJobContext* context = (EvaluateSkeletonsJobContext*)_context;
+        for (uint32_t i = begin; i < end; ++i)
+        {
+            SpineModelComponent* component = context->m_Components[i];
+            if (component->m_UsePoseCache)
+                EvaluateSharedSkeleton(component, component->m_UpdateDT);
+            else
+                EvaluateSkeleton(component, component->m_UpdateDT);
+        }
+    }
 
-            // Update the game world objects
-            transforms_updated |= UpdateBones(&component);
+    static void EvaluatePosesJob(void* _context, uint32_t begin, uint32_t end)
+    {
+        SpinePose** poses = (SpinePose**)_context;
+        for (uint32_t i = begin; i < end; ++i)
+        {
+            EvaluatePose(poses[i]);
+        }
+    }
 
-            if (component.m_ReHash || (component.m_RenderConstants && dmGameSystem::AreRenderConstantsUpdated(component.m_RenderConstants)))
+    static void FinishSharedSkeletonsJob(void* _context, uint32_t begin, uint32_t end)
+    {
+        EvaluateSkeletonsJobContext* context = (EvaluateSkeletonsJobContext*)_context;
+        for (uint32_t i = begin; i < end; ++i)
+        {
+            SpineModelComponent* component = context->m_Components[i];
+            AccountScope account_scope(&GetSpineScene(component)->m_InstanceAccount);
+            if (component->m_PoseCandidate)
             {
-                ReHash(&component);
+                // The instance is posed from the cache, but still needs its own events
+                spAnimationState_applyEvents(component->m_AnimationStateInstance);
+            }
+            else if (component->m_PoseFallback)
+            {
+                PoseSkeleton(component, component->m_UpdateDT);
             }
-
-            component.m_DoRender = 1;
         }
-
-        // Since we've moved the child game objects (bones), we need to sync back the transforms
-        update_result.m_TransformsUpdated = transforms_updated;
-        return dmGameObject::UPDATE_RESULT_OK;
     }
 
-    dmGameObject::UpdateResult CompSpineModelPostUpdate(const dmGameObject::ComponentsPostUpdateParams& params)
+    // Matches the pose candidates with the cached poses, and collects the new poses that needs evaluating
+    static void ResolveSharedPoses(SpineModelWorld* world)
     {
-        SpineModelWorld* world = (SpineModelWorld*)params.m_World;
-        dmArray<SpineModelComponent*>& components = world->m_Components.GetRawObjects();
-        const uint32_t count = components.Size();
-        for (uint32_t i = 0; i < count; ++i)
+        world->m_PoseEvalList.SetSize(0);
+
+        dmArray<SpineModelComponent*>& update_list = world->m_UpdateList;
+        for (uint32_t i = 0; i < update_list.Size(); ++i)
         {
-            SpineModelComponent* component = components[i];
-            if (!component || !component->m_RebuildBonesPending)
+            SpineModelComponent* component = update_list[i];
+            if (component->m_SkipPose)
                 continue;
 
-            component->m_RebuildBonesPending = 0;
-            if (component->m_Resource->m_CreateGoBones)
+            if (!component->m_PoseCandidate)
             {
-                if (!CreateGOBones(world, component))
+                // Already continued from the shared pose in EvaluateSharedSkeleton()
+                ReleaseSharedPose(component, false);
+                continue;
+            }
+
+            if (component->m_Pose && component->m_Pose->m_Desc.m_Key == component->m_PoseDesc.m_Key)
+                continue;
+
+            SpineSceneResource* spine_scene = GetSpineScene(component);
+            bool created = false;
+            SpinePose* pose = AcquirePose(spine_scene, component->m_PoseDesc, &created);
+            if (!pose)
+            {
+                // The cache is full, so we evaluate this instance on its own
+                ReleaseSharedPose(component, true);
+                component->m_PoseCandidate = 0;
+                component->m_PoseFallback = 1;
+                continue;
+            }
+
+            ReleaseSharedPose(component, false);
+            component->m_Pose = pose;
+            component->m_PoseGeneration = spine_scene->m_PoseCacheGeneration;
+
+            if (created)
+            {
+                if (world->m_PoseEvalList.Full())
                 {
-                    dmLogError("Failed to create game objects for bones in spine model. Consider increasing collection max instances (collection.max_instances).");
+                    world->m_PoseEvalList.OffsetCapacity(dmMath::Max(16U, world->m_PoseEvalList.Capacity()));
                 }
+                world->m_PoseEvalList.Push(pose);
             }
         }
-        return dmGameObject::UPDATE_RESULT_OK;
     }
 
-    static inline dmGameSystemDDF::SpineModelDesc::BlendMode SpineBlendModeToRenderBlendMode(spBlendMode sp_blend_mode)
+    static bool FinishComponentUpdate(SpineModelComponent* component)
     {
-        switch(sp_blend_mode)
+        // Update the game world objects
+        bool transforms_updated = UpdateBones(component);
+
+        if (component->m_ReHash || (component->m_RenderConstants && dmGameSystem::AreRenderConstantsUpdated(component->m_RenderConstants)))
         {
-            case SP_BLEND_MODE_NORMAL:
-                return dmGameSystemDDF::SpineModelDesc::BLEND_MODE_ALPHA;
-            case SP_BLEND_MODE_ADDITIVE:
-                return dmGameSystemDDF::SpineModelDesc::BLEND_MODE_ADD;
-            case SP_BLEND_MODE_MULTIPLY:
-                return dmGameSystemDDF::SpineModelDesc::BLEND_MODE_MULT;
-            case SP_BLEND_MODE_SCREEN:
-                return dmGameSystemDDF::SpineModelDesc::BLEND_MODE_SCREEN;
+            ReHash(component);
+        }
+
+        component->m_DoRender = 1;
+        return transforms_updated;
+    }
+
+    // The skeletons are evaluated in parallel (if there is a job pool), while everything that may run Lua code or touch
+    // other game objects (listener events, callbacks, bone game objects) is done on the main thread,
+    // in component order, once all skeletons are done.
+    static bool UpdateComponentsDeferred(SpineModelWorld* world, HJobPool job_pool, bool use_pose_cache)
+    {
+        dmArray<SpineModelComponent*>& update_list = world->m_UpdateList;
+        uint32_t count = update_list.Size();
+        if (count == 0)
+            return false;
+
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            update_list[i]->m_DeferEvents = 1;
+        }
+
+        EvaluateSkeletonsJobContext job_context;
+        job_context.m_Components = update_list.Begin();
+
+        uint32_t thread_count = GetJobPoolThreadCount(job_pool) + 1;
+        uint32_t chunk_size = dmMath::Max(UPDATE_JOB_MIN_CHUNK_SIZE, count / (thread_count * 4));
+        {
+            DM_PROFILE("EvaluateSkeletons");
+            RunJob(job_pool, EvaluateSkeletonsJob, &job_context, count, chunk_size);
+        }
+
+        if (use_pose_cache)
+        {
+            DM_PROFILE("SharedPoses");
+            ResolveSharedPoses(world);
+            RunJob(job_pool, EvaluatePosesJob, world->m_PoseEvalList.Begin(), world->m_PoseEvalList.Size(), 1);
+            RunJob(job_pool, FinishSharedSkeletonsJob, &job_context, count, chunk_size);
+        }
+
+        bool transforms_updated = false;
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            SpineModelComponent* component = update_list[i];
+            component->m_DeferEvents = 0;
+            DispatchDeferredEvents(component);
+            transforms_updated |= FinishComponentUpdate(component);
+        }
+        return transforms_updated;
+    }
+
+    dmGameObject::UpdateResult CompSpineModelLateUpdate(const dmGameObject::ComponentsUpdateParams& params, dmGameObject::ComponentsUpdateResult& update_result)
+    {
+        SpineModelContext* context = (SpineModelContext*)params.m_Context;
+        SpineModelWorld* world = (SpineModelWorld*)params.m_World;
+
+        float dt = params.m_UpdateContext->m_DT;
+
+        dmArray<SpineModelComponent*>& components = world->m_Components.GetRawObjects();
+        const uint32_t count = components.Size();
+        DM_PROPERTY_ADD_U32(rmtp_SpineComponents, count);
+
+        // The allocations are shared by all worlds (and the gui)
+        AllocatorStats allocator_stats;
+        GetAllocatorStats(&allocator_stats);
+        DM_PROPERTY_SET_U32(rmtp_SpineDataSize, allocator_stats.m_ArenaSize);
+        DM_PROPERTY_SET_U32(rmtp_SpineDataAllocations, allocator_stats.m_ArenaAllocationCount);
+        DM_PROPERTY_SET_U32(rmtp_SpineInstanceSize, allocator_stats.m_InstanceSize);
+        DM_PROPERTY_SET_U32(rmtp_SpineInstanceAllocations, allocator_stats.m_InstanceAllocationCount);
+        DM_PROPERTY_SET_U32(rmtp_SpinePoolSize, allocator_stats.m_PoolSize);
+
+        HJobPool job_pool = context->m_UpdateJobPool;
+        world->m_UpdateList.SetSize(0);
+        if (world->m_UpdateList.Capacity() < count)
+        {
+            world->m_UpdateList.SetCapacity(count);
+        }
+
+        bool use_pose_cache = false;
+        bool transforms_updated = false;
+        uint32_t lod_counts[SPINE_LOD_COUNT] = {};
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            SpineModelComponent& component = *components[i];
+            component.m_DoRender = 0;
+
+            if (!component.m_SkeletonInstance || !component.m_AnimationStateInstance)
+            {
+                component.m_Enabled = false;
+            }
+
+            if (!component.m_Enabled || !component.m_AddedToUpdate)
+                continue;
+
+            const Matrix4& go_world = dmGameObject::GetWorldMatrix(component.m_Instance);
+            const Matrix4 local = dmTransform::ToMatrix4(component.m_Transform);
+            component.m_World = go_world * local;
+
+            bool update = UpdateLod(context, &component, dt);
+            lod_counts[component.m_Lod]++;
+            if (!update)
+            {
+                // Keep rendering the last pose
+                transforms_updated |= FinishComponentUpdate(&component);
+                continue;
+            }
+
+            PrepareIKTargets(&component);
+
+            component.m_SkipPose = ShouldSkipPose(&component, context->m_CulledUpdateInterval);
+            component.m_UsePoseCache = CanSharePose(&component);
+            component.m_PoseCandidate = 0;
+            component.m_PoseFallback = 0;
+            if (!component.m_UsePoseCache || component.m_PoseGeneration != GetSpineScene(&component)->m_PoseCacheGeneration)
+            {
+                ReleaseSharedPose(&component, true);
+            }
+            use_pose_cache |= component.m_UsePoseCache;
+
+            // Shared poses are resolved once all instances have been advanced
+            if (job_pool || component.m_UsePoseCache)
+            {
+                world->m_UpdateList.Push(&component);
+                continue;
+            }
+
+            EvaluateSkeleton(&component, component.m_UpdateDT);
+            transforms_updated |= FinishComponentUpdate(&component);
+        }
+
+        DM_PROPERTY_ADD_U32(rmtp_SpineLod0, lod_counts[0]);
+        DM_PROPERTY_ADD_U32(rmtp_SpineLod1, lod_counts[1]);
+        DM_PROPERTY_ADD_U32(rmtp_SpineLod2, lod_counts[2]);
+
+        transforms_updated |= UpdateComponentsDeferred(world, job_pool, use_pose_cache);
+
+        // Since we've moved the child game objects (bones), we need to sync back the transforms
+        update_result.m_TransformsUpdated = transforms_updated;
+        return dmGameObject::UPDATE_RESULT_OK;
+    }
+
+    dmGameObject::UpdateResult CompSpineModelPostUpdate(const dmGameObject::ComponentsPostUpdateParams& params)
+    {
+        SpineModelWorld* world = (SpineModelWorld*)params.m_World;
+        dmArray<SpineModelComponent*>& components = world->m_Components.GetRawObjects();
+        const uint32_t count = components.Size();
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            SpineModelComponent* component = components[i];
+            if (!component || !component->m_RebuildBonesPending)
+                continue;
+
+            component->m_RebuildBonesPending = 0;
+            if (component->m_Resource->m_CreateGoBones)
+            {
+                if (!CreateGOBones(world, component))
+                {
+                    dmLogError("Failed to create game objects for bones in spine model. Consider increasing collection max instances (collection.max_instances).");
+                }
+            }
+        }
+        return dmGameObject::UPDATE_RESULT_OK;
+    }
+
+    static inline dmGameSystemDDF::SpineModelDesc::BlendMode SpineBlendModeToRenderBlendMode(spBlendMode sp_blend_mode)
+    {
+        switch(sp_blend_mode)
+        {
+            case SP_BLEND_MODE_NORMAL:
+                return dmGameSystemDDF::SpineModelDesc::BLEND_MODE_ALPHA;
+            case SP_BLEND_MODE_ADDITIVE:
+                return dmGameSystemDDF::SpineModelDesc::BLEND_MODE_ADD;
+            case SP_BLEND_MODE_MULTIPLY:
+                return dmGameSystemDDF::SpineModelDesc::BLEND_MODE_MULT;
+            case SP_BLEND_MODE_SCREEN:
+                return dmGameSystemDDF::SpineModelDesc::BLEND_MODE_SCREEN;
             default:break;
         }
-        return dmGameSystemDDF::SpineModelDesc::BLEND_MODE_ALPHA;
+        return dmGameSystemDDF::SpineModelDesc::BLEND_MODE_ALPHA;
+    }
+
+    // Render object submission and storage:
+    //
+    // Visible geometry is generated during RENDER_LIST_OPERATION_BATCH, after
+    // frustum culling. Render objects must also be submitted during BATCH to
+    // preserve their sorted order relative to sprites and other components.
+    //
+    // Precomputing exact buffer and render-object requirements before BATCH
+    // would require another traversal of the visible Spine geometry. That work
+    // can be expensive, so geometry and draw descriptors are generated only
+    // once, while unpredictable render-object growth is handled by overflow.
+    //
+    // AddToRender retains RenderObject pointers until drawing, so storage must
+    // remain stable during BATCH. The indices are always 16-bit, relative to the
+    // vertex segment of the render object, so the objects are complete once filled.
+    //
+    // m_RenderObjects is the contiguous steady-state storage. It reserves one
+    // entry per possible Spine component before rendering starts and never grows
+    // during BATCH. Inherited slot blend modes can produce more than one render
+    // object per component, so excess objects use stable blocks of 32. On the
+    // next frame's BEGIN, after previous pointers have been consumed, the primary
+    // array grows to the previous high-water mark (rounded to 32), the overflow
+    // blocks are released, and subsequent frames are contiguous again. The
+    // primary array keeps that capacity and repeats this flow only after a new
+    // high-water mark.
+    static dmRender::RenderObject& AcquireRenderObject(SpineModelWorld* world, SpineRenderObjectKey** out_key)
+    {
+        uint32_t render_object_index = world->m_RenderObjectsInUse;
+
+        // A new entry never matches, so the object is filled completely
+        if (render_object_index == world->m_RenderObjectKeys.Size())
+        {
+            if (world->m_RenderObjectKeys.Full())
+            {
+                world->m_RenderObjectKeys.OffsetCapacity(dmMath::Max(32U, world->m_RenderObjectKeys.Capacity()));
+            }
+            world->m_RenderObjectKeys.SetSize(render_object_index + 1);
+            memset(&world->m_RenderObjectKeys[render_object_index], 0, sizeof(SpineRenderObjectKey));
+        }
+        *out_key = &world->m_RenderObjectKeys[render_object_index];
+
+        // SetSize cannot relocate here because it remains within reserved capacity.
+        if (render_object_index < world->m_RenderObjects.Capacity())
+        {
+            if (render_object_index == world->m_RenderObjects.Size())
+            {
+                world->m_RenderObjects.SetSize(render_object_index + 1);
+            }
+
+            ++world->m_RenderObjectsInUse;
+            return world->m_RenderObjects[render_object_index];
+        }
+
+        // Overflow blocks do not move when the block-pointer array grows.
+        uint32_t overflow_index = render_object_index - world->m_RenderObjects.Capacity();
+        uint32_t block_index = overflow_index >> RENDER_OBJECT_OVERFLOW_BLOCK_SHIFT;
+        uint32_t block_offset = overflow_index & RENDER_OBJECT_OVERFLOW_BLOCK_MASK;
+        if (block_index == world->m_RenderObjectOverflowBlocks.Size())
+        {
+            if (world->m_RenderObjectOverflowBlocks.Full())
+            {
+                uint32_t new_capacity = dmMath::Max(4U, world->m_RenderObjectOverflowBlocks.Capacity() * 2);
+                world->m_RenderObjectOverflowBlocks.SetCapacity(new_capacity);
+            }
+            world->m_RenderObjectOverflowBlocks.Push(new dmRender::RenderObject[RENDER_OBJECT_OVERFLOW_BLOCK_SIZE]);
+        }
+
+        ++world->m_RenderObjectsInUse;
+        return world->m_RenderObjectOverflowBlocks[block_index][block_offset];
+    }
+
+    // The render objects are acquired in the same order each frame, so an object that is filled with the same state
+    // as in the previous frame (i.e. its batch is unchanged) only needs its index range updated.
+    // The reuse can be turned off with spine.reuse_render_objects, to compare the RenderBatch profiler scope
+    static dmRender::RenderObject& FillRenderObject(SpineModelWorld*  world,
+        dmRender::HRenderContext                   render_context,
+        const SpineModelComponent*                 component,
+        dmGraphics::HTexture                       texture,
+        dmRender::HMaterial                        material,
+        dmGameSystemDDF::SpineModelDesc::BlendMode blend_mode,
+        dmGraphics::HVertexDeclaration             vertex_declaration,
+        dmGraphics::HVertexBuffer                  vertex_buffer,
+        uint32_t                                   index_start,
+        uint32_t                                   index_count)
+    {
+        SpineRenderObjectKey key;
+        memset(&key, 0, sizeof(key));
+        key.m_VertexDeclaration = vertex_declaration;
+        key.m_VertexBuffer      = vertex_buffer;
+        key.m_Texture           = texture;
+        key.m_Material          = material;
+        key.m_Constants         = component->m_RenderConstants;
+        key.m_BatchKey          = component->m_MixedHash;
+        key.m_BlendMode         = blend_mode;
+
+        SpineRenderObjectKey* last_key;
+        dmRender::RenderObject& ro = AcquireRenderObject(world, &last_key);
+        if (world->m_ReuseRenderObjects && memcmp(last_key, &key, sizeof(key)) == 0)
+        {
+            ro.m_VertexStart = index_start * sizeof(uint16_t); // byte offset
+            ro.m_VertexCount = index_count;
+            dmRender::AddToRender(render_context, &ro);
+            DM_PROPERTY_ADD_U32(rmtp_SpineRenderObjects, 1);
+            DM_PROPERTY_ADD_U32(rmtp_SpineRenderObjectsReused, 1);
+            return ro;
+        }
+        *last_key = key;
+
+        ro.Init();
+        ro.m_VertexDeclaration = vertex_declaration;
+        ro.m_VertexBuffer      = vertex_buffer;
+        ro.m_IndexBuffer       = world->m_IndexBuffer;
+        ro.m_IndexType         = dmGraphics::TYPE_UNSIGNED_SHORT;
+        ro.m_PrimitiveType     = dmGraphics::PRIMITIVE_TRIANGLES;
+        ro.m_VertexStart       = index_start * sizeof(uint16_t); // byte offset
+        ro.m_VertexCount       = index_count;
+        ro.m_Textures[0]       = texture;
+        ro.m_Material          = material;
+
+        if (component->m_RenderConstants)
+        {
+            dmGameSystem::EnableRenderObjectConstants(&ro, component->m_RenderConstants);
+        }
+
+        ro.m_SetBlendFactors = 1;
+
+        switch (blend_mode)
+         {
+            case dmGameSystemDDF::SpineModelDesc::BLEND_MODE_ALPHA:
+                ro.m_SourceBlendFactor = dmGraphics::BLEND_FACTOR_ONE;
+                ro.m_DestinationBlendFactor = dmGraphics::BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+            break;
+
+            case dmGameSystemDDF::SpineModelDesc::BLEND_MODE_ADD:
+                ro.m_SourceBlendFactor = dmGraphics::BLEND_FACTOR_ONE;
+                ro.m_DestinationBlendFactor = dmGraphics::BLEND_FACTOR_ONE;
+            break;
+
+            case dmGameSystemDDF::SpineModelDesc::BLEND_MODE_MULT:
+                ro.m_SourceBlendFactor = dmGraphics::BLEND_FACTOR_DST_COLOR;
+                ro.m_DestinationBlendFactor = dmGraphics::BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+            break;
+
+            case dmGameSystemDDF::SpineModelDesc::BLEND_MODE_SCREEN:
+                ro.m_SourceBlendFactor = dmGraphics::BLEND_FACTOR_ONE_MINUS_DST_COLOR;
+                ro.m_DestinationBlendFactor = dmGraphics::BLEND_FACTOR_ONE;
+            break;
+
+            default:
+                dmLogError("Unknown blend mode: %d\n", blend_mode);
+                assert(0);
+            break;
+        }
+
+        // Submit in BATCH for correct sorting; END uploads the buffers before drawing.
+        dmRender::AddToRender(render_context, &ro);
+        DM_PROPERTY_ADD_U32(rmtp_SpineRenderObjects, 1);
+        return ro;
+    }
+
+    // Grows the array to the high-water mark (with some slack for the next peak), and is a no-op in the steady state
+    template <typename T>
+    static void ReserveHighWaterMark(dmArray<T>& array, uint32_t high_water_mark)
+    {
+        if (array.Capacity() < high_water_mark)
+        {
+            array.SetCapacity(high_water_mark + high_water_mark / 8);
+        }
+    }
+
+    static uint32_t GetFrameGeometryCapacity(const SpineModelWorld* world)
+    {
+        return sizeof(float) * world->m_WorldVertices.Capacity()
+             + sizeof(uint16_t) * world->m_IndexBufferData.Capacity()
+             + sizeof(SpineSkinnedVertex) * world->m_SkinnedVertexBufferData.Capacity();
+    }
+
+    // Called before the attachment vertices are computed, which is the first of the per frame geometry
+    static void ReserveFrameGeometry(SpineModelWorld* world)
+    {
+        SpineFrameGeometry& frame = world->m_FrameGeometry;
+        ReserveHighWaterMark(world->m_WorldVertices, frame.m_WorldVertexCount);
+        ReserveHighWaterMark(world->m_IndexBufferData, frame.m_IndexCount);
+        ReserveHighWaterMark(world->m_SkinnedVertexBufferData, frame.m_SkinnedVertexCount);
+        frame.m_ReservedSize = GetFrameGeometryCapacity(world);
+    }
+
+    // Called once the geometry of the frame is complete (at END)
+    static void UpdateFrameGeometryStats(SpineModelWorld* world)
+    {
+        SpineFrameGeometry& frame = world->m_FrameGeometry;
+        frame.m_WorldVertexCount = dmMath::Max(frame.m_WorldVertexCount, world->m_WorldVertices.Size());
+        frame.m_IndexCount = dmMath::Max(frame.m_IndexCount, world->m_IndexBufferData.Size());
+        frame.m_SkinnedVertexCount = dmMath::Max(frame.m_SkinnedVertexCount, world->m_SkinnedVertexBufferData.Size());
+
+        uint32_t size = sizeof(float) * world->m_WorldVertices.Size()
+                      + sizeof(uint16_t) * world->m_IndexBufferData.Size()
+                      + sizeof(SpineSkinnedVertex) * world->m_SkinnedVertexBufferData.Size();
+        frame.m_PeakSize = dmMath::Max(frame.m_PeakSize, size);
+        frame.m_AverageSize = frame.m_AverageSize ? frame.m_AverageSize - frame.m_AverageSize / 16 + size / 16 : size;
+
+        uint32_t capacity = GetFrameGeometryCapacity(world);
+        if (capacity != frame.m_ReservedSize)
+        {
+            DM_PROPERTY_ADD_U32(rmtp_SpineFrameGeometryGrowth, 1);
+            frame.m_ReservedSize = capacity;
+        }
+
+        DM_PROPERTY_ADD_U32(rmtp_SpineFrameGeometrySize, size);
+        DM_PROPERTY_ADD_U32(rmtp_SpineFrameGeometryPeak, frame.m_PeakSize);
+        DM_PROPERTY_ADD_U32(rmtp_SpineFrameGeometryAverage, frame.m_AverageSize);
+    }
+
+    static void PrepareRenderObjectsForFrame(SpineModelWorld* world)
+    {
+        // BEGIN is the safe relocation point described above. Absorb the previous
+        // high-water mark so overflow storage remains a one-frame spike path.
+        if (world->m_RenderObjectsInUse > world->m_RenderObjects.Capacity())
+        {
+            uint32_t new_capacity = (world->m_RenderObjectsInUse + RENDER_OBJECT_OVERFLOW_BLOCK_MASK) & ~RENDER_OBJECT_OVERFLOW_BLOCK_MASK;
+            world->m_RenderObjects.SetCapacity(new_capacity);
+
+            for (uint32_t i = 0; i < world->m_RenderObjectOverflowBlocks.Size(); ++i)
+            {
+                delete[] world->m_RenderObjectOverflowBlocks[i];
+            }
+            world->m_RenderObjectOverflowBlocks.SetSize(0);
+
+            // The objects past the primary array are gone
+            world->m_RenderObjectKeys.SetSize(world->m_RenderObjects.Size());
+        }
+
+        world->m_RenderObjectsInUse = 0;
+    }
+
+    static inline const float* GetWorldVertices(const SpineModelWorld* world, uint32_t component_index)
+    {
+        uint32_t offset = world->m_WorldVertexOffsets[component_index];
+        return offset != INVALID_WORLD_VERTEX_OFFSET ? world->m_WorldVertices.Begin() + offset : 0;
+    }
+
+    // Hash of everything in the skeleton that the geometry depends on: the bone transforms, the draw order,
+    // and the slot colors, attachments and deforms
+    static uint64_t CalcPoseKey(const spSkeleton* skeleton)
+    {
+        HashState64 state;
+        dmHashInit64(&state, false);
+        dmHashUpdateBuffer64(&state, &skeleton->color, sizeof(skeleton->color));
+
+        for (int i = 0; i < skeleton->bonesCount; ++i)
+        {
+            const spBone* bone = skeleton->bones[i];
+            dmHashUpdateBuffer64(&state, &bone->a, sizeof(float) * 6); // a, b, worldX, c, d, worldY
+            dmHashUpdateBuffer64(&state, &bone->active, sizeof(bone->active));
+        }
+
+        for (int i = 0; i < skeleton->slotsCount; ++i)
+        {
+            const spSlot* slot = skeleton->drawOrder[i];
+            dmHashUpdateBuffer64(&state, &slot->data->index, sizeof(slot->data->index));
+            dmHashUpdateBuffer64(&state, &slot->color, sizeof(slot->color));
+            dmHashUpdateBuffer64(&state, &slot->attachment, sizeof(slot->attachment));
+            dmHashUpdateBuffer64(&state, &slot->sequenceIndex, sizeof(slot->sequenceIndex));
+            if (slot->deformCount > 0)
+            {
+                dmHashUpdateBuffer64(&state, slot->deform, sizeof(float) * slot->deformCount);
+            }
+        }
+        return dmHashFinal64(&state);
+    }
+
+    static uint64_t CalcGeometryKey(const SpineModelComponent* component, bool compact_vertices, bool use_inherit_blend)
+    {
+        HashState64 state;
+        dmHashInit64(&state, false);
+        dmHashUpdateBuffer64(&state, &component->m_PoseKey, sizeof(component->m_PoseKey));
+        dmHashUpdateBuffer64(&state, &component->m_World, sizeof(component->m_World));
+        uint32_t flags = (compact_vertices ? 1 : 0) | (use_inherit_blend ? 2 : 0);
+        dmHashUpdateBuffer64(&state, &flags, sizeof(flags));
+        return dmHashFinal64(&state);
+    }
+
+    static inline void MarkVerticesDirty(SpineVertexRanges& ranges, uint32_t start, uint32_t end)
+    {
+        if (start == end)
+            return;
+        if (ranges.m_DirtyStart == ranges.m_DirtyEnd)
+        {
+            ranges.m_DirtyStart = start;
+            ranges.m_DirtyEnd = end;
+        }
+        else
+        {
+            ranges.m_DirtyStart = dmMath::Min(ranges.m_DirtyStart, start);
+            ranges.m_DirtyEnd = dmMath::Max(ranges.m_DirtyEnd, end);
+        }
+    }
+
+    static inline bool CrossesVertexSegment(uint32_t start, uint32_t end)
+    {
+        return end > start && (start >> VERTEX_SEGMENT_SHIFT) != ((end - 1) >> VERTEX_SEGMENT_SHIFT);
+    }
+
+    // The start of the next segment, with the vertices in between unused
+    template <typename TVertex>
+    static uint32_t PadToNextVertexSegment(dmArray<TVertex>& vertex_buffer)
+    {
+        uint32_t start = (vertex_buffer.Size() + VERTEX_SEGMENT_SIZE - 1) & ~(VERTEX_SEGMENT_SIZE - 1);
+        if (vertex_buffer.Capacity() < start)
+        {
+            vertex_buffer.SetCapacity(start);
+        }
+        vertex_buffer.SetSize(start);
+        return start;
+    }
+
+    static dmGraphics::HVertexBuffer GetSegmentVertexBuffer(SpineModelWorld* world, SpineVertexRanges& ranges, uint32_t vertex_start)
+    {
+        uint32_t segment = vertex_start >> VERTEX_SEGMENT_SHIFT;
+        if (segment >= ranges.m_SegmentBuffers.Size())
+        {
+            ranges.m_SegmentBuffers.SetCapacity(segment + 1);
+            ranges.m_UploadedCounts.SetCapacity(segment + 1);
+            while (ranges.m_SegmentBuffers.Size() <= segment)
+            {
+                ranges.m_SegmentBuffers.Push(dmGraphics::NewVertexBuffer(world->m_GraphicsContext, 0, 0, dmGraphics::BUFFER_USAGE_DYNAMIC_DRAW));
+                ranges.m_UploadedCounts.Push(0);
+            }
+        }
+        return ranges.m_SegmentBuffers[segment];
+    }
+
+    static void ReleaseVertexRange(SpineModelWorld* world, SpineModelComponent* component)
+    {
+        SpineVertexRanges& ranges = component->m_CompactVertexRange ? world->m_CompactVertexRanges : world->m_VertexRanges;
+        ranges.m_LiveCount -= component->m_VertexCapacity;
+        component->m_VertexStart = 0;
+        component->m_VertexCapacity = 0;
+        component->m_GeometryValid = 0;
+    }
+
+    // Once the ranges left behind by moved ones dominate, all ranges are released, and the components
+    // regenerate their vertices the next time they're drawn
+    template <typename TVertex>
+    static void ReleaseFragmentedVertexRanges(SpineModelWorld* world, dmArray<TVertex>& vertex_buffer, SpineVertexRanges& ranges, bool compact_vertices)
+    {
+        if (vertex_buffer.Size() < VERTEX_RANGES_MIN_COMPACT_COUNT || ranges.m_LiveCount * 2 >= vertex_buffer.Size())
+        {
+            return;
+        }
+
+        dmArray<SpineModelComponent*>& components = world->m_Components.GetRawObjects();
+        for (uint32_t i = 0; i < components.Size(); ++i)
+        {
+            SpineModelComponent* component = components[i];
+            if (component->m_VertexCapacity && component->m_CompactVertexRange == compact_vertices)
+            {
+                ReleaseVertexRange(world, component);
+            }
+        }
+        vertex_buffer.SetSize(0);
+        ranges.m_DirtyStart = 0;
+        ranges.m_DirtyEnd = 0;
+    }
+
+    // The components with more vertices than a segment are split per segment, and their ranges start at a segment
+    template <typename TVertex>
+    static void GenerateComponentGeometry(SpineModelWorld* world, SpineModelComponent* component, dmArray<TVertex>& vertex_buffer,
+                                          const float* world_vertices, bool use_inherit_blend, bool segmented)
+    {
+        const spSkeleton* skeleton = GetRenderSkeleton(component);
+        dmArray<SpineIndexedDrawDesc>* draw_descs = use_inherit_blend ? &component->m_DrawDescs : 0;
+        if (segmented)
+        {
+            dmSpine::GenerateSegmentedVertexData(vertex_buffer, component->m_Indices, skeleton, world->m_SkeletonClipper, component->m_World, Vector4(1.0f),
+                                                 draw_descs, world->m_GeometryScratch, world_vertices, component->m_IndexSegments);
+        }
+        else
+        {
+            dmSpine::GenerateIndexedVertexData(vertex_buffer, component->m_Indices, skeleton, world->m_SkeletonClipper, component->m_World, Vector4(1.0f),
+                                               draw_descs, world->m_GeometryScratch, world_vertices);
+        }
+    }
+
+    // Regenerates the vertices of the component if its pose, transform or vertex format has changed since the last time.
+    // They're written to the range the component owns in the vertex buffer, or to a new range at the end if they don't fit
+    template <typename TVertex>
+    static void UpdateComponentGeometry(SpineModelWorld* world, SpineModelComponent* component, uint32_t component_index,
+                                        dmArray<TVertex>& vertex_buffer, SpineVertexRanges& ranges, bool compact_vertices, bool use_inherit_blend)
+    {
+        uint64_t geometry_key = CalcGeometryKey(component, compact_vertices, use_inherit_blend);
+        if (component->m_GeometryValid && component->m_GeometryKey == geometry_key)
+        {
+            DM_PROPERTY_ADD_U32(rmtp_SpineGeometryReused, 1);
+            return;
+        }
+
+        if (component->m_VertexCapacity && component->m_CompactVertexRange != compact_vertices)
+        {
+            ReleaseVertexRange(world, component);
+        }
+
+        const spSkeleton* skeleton = GetRenderSkeleton(component);
+        component->m_Indices.SetSize(0);
+        component->m_DrawDescs.SetSize(0);
+        component->m_IndexSegments.SetSize(0);
+        if (use_inherit_blend && component->m_DrawDescs.Capacity() < (uint32_t)skeleton->slotsCount)
+        {
+            component->m_DrawDescs.SetCapacity((uint32_t)skeleton->slotsCount);
+        }
+
+        // While the same attachments are drawn, and nothing is clipped, the size of the last geometry is exact.
+        // The vertices are then written straight into the range of the component, if they fit
+        SpineGeometrySizeCache& size_cache = component->m_GeometrySize;
+        bool size_known = dmSpine::CheckGeometrySizeCache(size_cache, skeleton);
+        if (size_known && component->m_Indices.Capacity() < size_cache.m_IndexCount)
+        {
+            component->m_Indices.SetCapacity(size_cache.m_IndexCount);
+        }
+
+        const float* world_vertices = GetWorldVertices(world, component_index);
+        bool segmented = component->m_VertexCapacity > VERTEX_SEGMENT_SIZE;
+        if (size_known && !size_cache.m_Clipped && size_cache.m_VertexCount <= component->m_VertexCapacity)
+        {
+            // Can't grow, which the exact size guarantees. The indices are relative to the start of the range
+            dmArray<TVertex> range(vertex_buffer.Begin() + component->m_VertexStart, 0, component->m_VertexCapacity);
+            GenerateComponentGeometry(world, component, range, world_vertices, use_inherit_blend, segmented);
+
+            MarkVerticesDirty(ranges, component->m_VertexStart, component->m_VertexStart + range.Size());
+            component->m_GeometryKey = geometry_key;
+            component->m_GeometryValid = 1;
+            return;
+        }
+
+        // Reserved once for the component, from the size of its last geometry, so that the attachments don't grow the buffer one by one
+        uint32_t expected_vertex_count = size_known ? size_cache.m_VertexCount : component->m_VertexCapacity;
+        if (vertex_buffer.Remaining() < expected_vertex_count)
+        {
+            vertex_buffer.OffsetCapacity(dmMath::Max(expected_vertex_count, vertex_buffer.Capacity() / 2));
+        }
+
+        // Generated at the end of the buffer, and then moved to the range of the component if it fits
+        uint32_t buffer_end = vertex_buffer.Size();
+        uint32_t base = segmented ? PadToNextVertexSegment(vertex_buffer) : buffer_end;
+        GenerateComponentGeometry(world, component, vertex_buffer, world_vertices, use_inherit_blend, segmented);
+        uint32_t vertex_count = vertex_buffer.Size() - base;
+        if (!segmented && vertex_count > VERTEX_SEGMENT_SIZE)
+        {
+            vertex_buffer.SetSize(buffer_end);
+            component->m_Indices.SetSize(0);
+            component->m_DrawDescs.SetSize(0);
+            segmented = true;
+            base = PadToNextVertexSegment(vertex_buffer);
+            GenerateComponentGeometry(world, component, vertex_buffer, world_vertices, use_inherit_blend, segmented);
+            vertex_count = vertex_buffer.Size() - base;
+        }
+        size_cache.m_VertexCount = vertex_count;
+        size_cache.m_IndexCount = component->m_Indices.Size();
+
+        // The 16 bit indices wrap around, so they're relative to the base once it's subtracted
+        uint32_t index_count = component->m_Indices.Size();
+        uint16_t* indices = component->m_Indices.Begin();
+        for (uint32_t i = 0; i < index_count; ++i)
+        {
+            indices[i] = (uint16_t)(indices[i] - base);
+        }
+
+        if (vertex_count <= component->m_VertexCapacity)
+        {
+            // Both start at a segment if the geometry is segmented
+            memcpy(vertex_buffer.Begin() + component->m_VertexStart, vertex_buffer.Begin() + base, sizeof(TVertex) * vertex_count);
+            vertex_buffer.SetSize(buffer_end);
+        }
+        else
+        {
+            ReleaseVertexRange(world, component);
+
+            // Leave some room for attachment changes, so that the range doesn't have to move again
+            uint32_t capacity = vertex_count + vertex_count / 4;
+            if (!segmented)
+                capacity = dmMath::Min(capacity, VERTEX_SEGMENT_SIZE);
+            uint32_t vertex_start = base;
+            if (!segmented && CrossesVertexSegment(base, base + capacity))
+            {
+                vertex_buffer.SetSize(base);
+                vertex_start = PadToNextVertexSegment(vertex_buffer);
+            }
+            if (vertex_buffer.Capacity() < vertex_start + capacity)
+            {
+                vertex_buffer.SetCapacity(vertex_start + capacity);
+            }
+            vertex_buffer.SetSize(vertex_start + capacity);
+            if (vertex_start != base)
+            {
+                memmove(vertex_buffer.Begin() + vertex_start, vertex_buffer.Begin() + base, sizeof(TVertex) * vertex_count);
+            }
+            component->m_VertexStart = vertex_start;
+            component->m_VertexCapacity = capacity;
+            component->m_CompactVertexRange = compact_vertices;
+            ranges.m_LiveCount += capacity;
+        }
+
+        MarkVerticesDirty(ranges, component->m_VertexStart, component->m_VertexStart + vertex_count);
+        component->m_GeometryKey = geometry_key;
+        component->m_GeometryValid = 1;
     }
 
-    static inline uint32_t GetIndexTypeSize(const SpineModelWorld* world)
+    // Uploads the segments that have changed size as a whole, and otherwise only the vertices that have changed.
+    // Returns the number of bytes uploaded
+    template <typename TVertex>
+    static uint32_t UploadVertexRanges(SpineModelWorld* world, const dmArray<TVertex>& vertex_buffer_data, SpineVertexRanges& ranges)
     {
-        return world->m_Is16BitIndex ? sizeof(uint16_t) : sizeof(uint32_t);
+        uint32_t upload_size = 0;
+        uint32_t vertex_count = vertex_buffer_data.Size();
+        for (uint32_t segment_start = 0; segment_start < vertex_count; segment_start += VERTEX_SEGMENT_SIZE)
+        {
+            dmGraphics::HVertexBuffer vertex_buffer = GetSegmentVertexBuffer(world, ranges, segment_start);
+            uint32_t& uploaded_count = ranges.m_UploadedCounts[segment_start >> VERTEX_SEGMENT_SHIFT];
+            uint32_t segment_count = dmMath::Min(vertex_count - segment_start, VERTEX_SEGMENT_SIZE);
+            if (uploaded_count != segment_count)
+            {
+                uint32_t size = sizeof(TVertex) * segment_count;
+                dmGraphics::SetVertexBufferData(vertex_buffer, size, vertex_buffer_data.Begin() + segment_start, dmGraphics::BUFFER_USAGE_DYNAMIC_DRAW);
+                uploaded_count = segment_count;
+                upload_size += size;
+                continue;
+            }
+
+            uint32_t dirty_start = dmMath::Max(ranges.m_DirtyStart, segment_start);
+            uint32_t dirty_end = dmMath::Min(ranges.m_DirtyEnd, segment_start + segment_count);
+            if (dirty_start < dirty_end)
+            {
+                uint32_t size = sizeof(TVertex) * (dirty_end - dirty_start);
+                dmGraphics::SetVertexBufferSubData(vertex_buffer, sizeof(TVertex) * (dirty_start - segment_start), size, vertex_buffer_data.Begin() + dirty_start);
+                upload_size += size;
+            }
+        }
+
+        // Segments past the end are no longer drawn from, and are uploaded as a whole when used again
+        for (uint32_t i = (vertex_count + VERTEX_SEGMENT_SIZE - 1) >> VERTEX_SEGMENT_SHIFT; i < ranges.m_UploadedCounts.Size(); ++i)
+        {
+            ranges.m_UploadedCounts[i] = 0;
+        }
+        ranges.m_DirtyStart = 0;
+        ranges.m_DirtyEnd = 0;
+        return upload_size;
     }
 
-    static inline dmGraphics::Type GetIndexType(const SpineModelWorld* world)
+    static void SetSkinningConstants(SpineModelWorld* world, SpineModelComponent* component, const spSkeleton* skeleton)
     {
-        return world->m_Is16BitIndex ? dmGraphics::TYPE_UNSIGNED_SHORT : dmGraphics::TYPE_UNSIGNED_INT;
+        uint32_t bone_count = (uint32_t)skeleton->bonesCount + 1;
+        uint32_t slot_count = (uint32_t)skeleton->slotsCount + 1;
+        uint32_t bone_vector_count = GetBoneTransformVectorCount(bone_count);
+        uint32_t constant_count = bone_vector_count + slot_count;
+        if (world->m_SkinningConstants.Capacity() < constant_count)
+            world->m_SkinningConstants.SetCapacity(constant_count);
+        world->m_SkinningConstants.SetSize(constant_count);
+
+        Vector4* bone_transforms = world->m_SkinningConstants.Begin();
+        Vector4* slot_colors = bone_transforms + bone_vector_count;
+        GetSkinningConstants(skeleton, bone_transforms, slot_colors);
+
+        if (!component->m_SkinningConstants)
+            component->m_SkinningConstants = dmRender::NewNamedConstantBuffer();
+
+        // Skeletons that don't fit are drawn with the CPU fallback, which only uses the first entries
+        dmRender::SetNamedConstant(component->m_SkinningConstants, SKINNING_BONE_TRANSFORMS, bone_transforms, GetBoneTransformVectorCount(dmMath::Min(bone_count, SKINNING_MAX_BONES)));
+        dmRender::SetNamedConstant(component->m_SkinningConstants, SKINNING_SLOT_COLORS, slot_colors, dmMath::Min(slot_count, SKINNING_MAX_SLOTS));
     }
 
-    static void PackIndexBufferData(SpineModelWorld* world)
+    // Appends the indices of the component, and the vertices that are transformed on the CPU.
+    // Returns true if the static geometry is used
+    static bool GenerateSkinnedComponentGeometry(SpineModelWorld* world, const SpineModelComponent* component, uint32_t component_index,
+                                                 const SpineSkinnedGeometry* geometry, bool use_inherit_blend, dmArray<SpineSkinnedDrawDesc>& draw_descs)
     {
-        uint32_t index_count = world->m_IndexBufferData.Size();
-        uint32_t index_data_size = index_count * GetIndexTypeSize(world);
-        if (world->m_PackedIndexBufferData.Capacity() < index_data_size)
+        const spSkeleton* skeleton = GetRenderSkeleton(component);
+        if (geometry && GenerateSkinnedIndices(geometry, skeleton, use_inherit_blend, world->m_IndexBufferData, world->m_SkinnedVertexBufferData, world->m_GeometryScratch, draw_descs))
         {
-            uint32_t new_capacity = dmMath::Max(index_data_size, dmMath::Max(64U, world->m_PackedIndexBufferData.Capacity() * 2));
-            world->m_PackedIndexBufferData.SetCapacity(new_capacity);
+            return true;
         }
-        world->m_PackedIndexBufferData.SetSize(index_data_size);
-
-        if (index_data_size == 0)
+        else
         {
-            return;
-        }
+            // In skeleton space, since the model transform is applied by the shader
+            uint32_t index_start = world->m_IndexBufferData.Size();
+            world->m_DrawDescBuffer.SetSize(0);
+            if (use_inherit_blend && world->m_DrawDescBuffer.Capacity() < (uint32_t)skeleton->slotsCount)
+            {
+                world->m_DrawDescBuffer.SetCapacity(dmMath::Max((uint32_t)skeleton->slotsCount, dmMath::Max(32U, world->m_DrawDescBuffer.Capacity() * 2)));
+            }
+            dmSpine::GenerateIndexedVertexData(world->m_SkinnedVertexBufferData, world->m_IndexBufferData, skeleton, world->m_SkeletonClipper, Matrix4::identity(), Vector4(1.0f),
+                                               use_inherit_blend ? &world->m_DrawDescBuffer : 0, world->m_GeometryScratch, GetWorldVertices(world, component_index));
 
-        if (world->m_Is16BitIndex)
-        {
-            uint16_t* packed_indices = (uint16_t*)world->m_PackedIndexBufferData.Begin();
-            for (uint32_t i = 0; i < index_count; ++i)
+            SpineIndexedDrawDesc all = { index_start, world->m_IndexBufferData.Size() - index_start, 0 };
+            const SpineIndexedDrawDesc* descs = &all;
+            uint32_t desc_count = all.m_IndexCount ? 1 : 0;
+            if (use_inherit_blend)
             {
-                assert(world->m_IndexBufferData[i] <= 0xFFFF);
-                packed_indices[i] = (uint16_t)world->m_IndexBufferData[i];
+                MergeIndexedDrawDescs(world->m_DrawDescBuffer, world->m_MergedDrawDescBuffer);
+                descs = world->m_MergedDrawDescBuffer.Begin();
+                desc_count = world->m_MergedDrawDescBuffer.Size();
             }
-        }
-        else
-        {
-            memcpy(world->m_PackedIndexBufferData.Begin(), world->m_IndexBufferData.Begin(), index_data_size);
+
+            if (draw_descs.Capacity() < desc_count)
+                draw_descs.SetCapacity(desc_count);
+            for (uint32_t i = 0; i < desc_count; ++i)
+            {
+                SpineSkinnedDrawDesc desc = { descs[i].m_IndexStart, descs[i].m_IndexCount, descs[i].m_BlendMode, 1 };
+                draw_descs.Push(desc);
+            }
+            return false;
         }
     }
 
-    // Render object submission and storage:
-    //
-    // Visible geometry is generated during RENDER_LIST_OPERATION_BATCH, after
-    // frustum culling. Render objects must also be submitted during BATCH to
-    // preserve their sorted order relative to sprites and other components.
-    //
-    // Precomputing exact buffer and render-object requirements before BATCH
-    // would require another traversal of the visible Spine geometry. That work
-    // can be expensive, so geometry and draw descriptors are generated only
-    // once, while unpredictable render-object growth is handled by overflow.
-    //
-    // AddToRender retains RenderObject pointers until drawing, while the final
-    // 16/32-bit index type is only known after all visible batches are complete.
-    // Storage must therefore remain stable during BATCH, and retained objects
-    // are patched with their final index type and byte offset during END.
-    //
-    // m_RenderObjects is the contiguous steady-state storage. It reserves one
-    // entry per possible Spine component before rendering starts and never grows
-    // during BATCH. Inherited slot blend modes can produce more than one render
-    // object per component, so excess objects use stable blocks of 32. On the
-    // next frame's BEGIN, after previous pointers have been consumed, the primary
-    // array grows to the previous high-water mark (rounded to 32), the overflow
-    // blocks are released, and subsequent frames are contiguous again. The
-    // primary array keeps that capacity and repeats this flow only after a new
-    // high-water mark.
-    static void FillRenderObject(SpineModelWorld*  world,
-        dmRender::HRenderContext                   render_context,
-        dmRender::RenderObject&                    ro,
-        dmGameSystem::HComponentRenderConstants    constants,
-        dmGraphics::HTexture                       texture,
-        dmRender::HMaterial                        material,
-        dmGameSystemDDF::SpineModelDesc::BlendMode blend_mode,
-        uint32_t                                   index_start,
-        uint32_t                                   index_count)
+    // Draws the static geometry of the spine scene, transformed by the bones in the vertex shader.
+    // Attachments that need CPU work (deform timelines etc) are written to the skinned vertex buffer instead,
+    // already transformed, so that the same material is used. With clipping, all of them are
+    static void RenderSkinnedComponent(SpineModelWorld* world, dmRender::HRenderContext render_context, SpineModelComponent* component, uint32_t component_index)
     {
-        ro.Init();
-        ro.m_VertexDeclaration = world->m_VertexDeclaration;
-        ro.m_VertexBuffer      = world->m_VertexBuffer;
-        ro.m_IndexBuffer       = world->m_IndexBuffer;
-        ro.m_PrimitiveType     = dmGraphics::PRIMITIVE_TRIANGLES;
-        // Keep the logical index offset until all visible geometry has been generated
-        // and the final 16/32-bit index type is known.
-        ro.m_VertexStart       = index_start;
-        ro.m_VertexCount       = index_count;
-        ro.m_Textures[0]       = texture;
-        ro.m_Material          = material;
+        const spSkeleton* skeleton = GetRenderSkeleton(component);
+        dmGameSystemDDF::SpineModelDesc::BlendMode blend_mode = component->m_Resource->m_Ddf->m_BlendMode;
+        bool use_inherit_blend = blend_mode == dmGameSystemDDF::SpineModelDesc::BLEND_MODE_INHERIT;
 
-        if (constants)
-        {
-            dmGameSystem::EnableRenderObjectConstants(&ro, constants);
+        dmArray<SpineSkinnedDrawDesc>& draw_descs = world->m_SkinnedDrawDescBuffer;
+        draw_descs.SetSize(0);
+
+        SpineSkinnedGeometry* geometry = AcquireSkinnedGeometry(GetSpineScene(component), world->m_GraphicsContext);
+        uint32_t index_start = world->m_IndexBufferData.Size();
+        uint32_t dynamic_start = world->m_SkinnedVertexBufferData.Size();
+        bool skinned = GenerateSkinnedComponentGeometry(world, component, component_index, geometry, use_inherit_blend, draw_descs);
+        if (CrossesVertexSegment(dynamic_start, world->m_SkinnedVertexBufferData.Size()))
+        {
+            // The dynamic vertices must be in one segment, so they're generated again at the start of the next one
+            world->m_IndexBufferData.SetSize(index_start);
+            world->m_SkinnedVertexBufferData.SetSize(dynamic_start);
+            draw_descs.SetSize(0);
+            dynamic_start = PadToNextVertexSegment(world->m_SkinnedVertexBufferData);
+            skinned = GenerateSkinnedComponentGeometry(world, component, component_index, geometry, use_inherit_blend, draw_descs);
+            if (CrossesVertexSegment(dynamic_start, world->m_SkinnedVertexBufferData.Size()))
+            {
+                dmLogOnceWarning("A spine model has more than %u vertices, and can't be drawn.", VERTEX_SEGMENT_SIZE);
+                world->m_IndexBufferData.SetSize(index_start);
+                world->m_SkinnedVertexBufferData.SetSize(dynamic_start);
+                return;
+            }
         }
 
-        ro.m_SetBlendFactors = 1;
+        if (draw_descs.Empty())
+        {
+            return;
+        }
 
-        switch (blend_mode)
-         {
-            case dmGameSystemDDF::SpineModelDesc::BLEND_MODE_ALPHA:
-                ro.m_SourceBlendFactor = dmGraphics::BLEND_FACTOR_ONE;
-                ro.m_DestinationBlendFactor = dmGraphics::BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
-            break;
+        if (skinned)
+        {
+            DM_PROPERTY_ADD_U32(rmtp_SpineSkinned, 1);
+        }
 
-            case dmGameSystemDDF::SpineModelDesc::BLEND_MODE_ADD:
-                ro.m_SourceBlendFactor = dmGraphics::BLEND_FACTOR_ONE;
-                ro.m_DestinationBlendFactor = dmGraphics::BLEND_FACTOR_ONE;
-            break;
+        SetSkinningConstants(world, component, skeleton);
 
-            case dmGameSystemDDF::SpineModelDesc::BLEND_MODE_MULT:
-                ro.m_SourceBlendFactor = dmGraphics::BLEND_FACTOR_DST_COLOR;
-                ro.m_DestinationBlendFactor = dmGraphics::BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
-            break;
+        dmGraphics::HTexture texture = GetSpineScene(component)->m_TextureSet->m_Texture->m_Texture;
+        dmRender::HMaterial material = GetMaterial(component);
 
-            case dmGameSystemDDF::SpineModelDesc::BLEND_MODE_SCREEN:
-                ro.m_SourceBlendFactor = dmGraphics::BLEND_FACTOR_ONE_MINUS_DST_COLOR;
-                ro.m_DestinationBlendFactor = dmGraphics::BLEND_FACTOR_ONE;
-            break;
+        for (uint32_t i = 0; i < draw_descs.Size(); ++i)
+        {
+            const SpineSkinnedDrawDesc& desc = draw_descs[i];
+            dmGameSystemDDF::SpineModelDesc::BlendMode desc_blend_mode = use_inherit_blend ? SpineBlendModeToRenderBlendMode((spBlendMode) desc.m_BlendMode) : blend_mode;
+            dmGraphics::HVertexBuffer vertex_buffer = desc.m_Dynamic ? GetSegmentVertexBuffer(world, world->m_SkinnedVertexRanges, dynamic_start) : geometry->m_VertexBuffer;
 
-            default:
-                dmLogError("Unknown blend mode: %d\n", blend_mode);
-                assert(0);
-            break;
+            dmRender::RenderObject& ro = FillRenderObject(world, render_context, component, texture, material, desc_blend_mode,
+                world->m_SkinnedVertexDeclaration, vertex_buffer, desc.m_IndexStart, desc.m_IndexCount);
+            // Read when the object is drawn, so they're fine to set after the submit
+            ro.m_WorldTransform = component->m_World;
+            ro.m_ConstantBuffer = component->m_SkinningConstants;
         }
+    }
 
-        // Submit in BATCH for correct sorting; END completes the retained object.
-        dmRender::AddToRender(render_context, &ro);
+    // Appends a range of the cached indices of the component, relative to its vertex segment
+    static void AppendIndices(SpineModelWorld* world, const SpineModelComponent* component, uint32_t index_start, uint32_t index_count)
+    {
+        uint32_t start = world->m_IndexBufferData.Size();
+        world->m_IndexBufferData.SetSize(start + index_count);
+        uint16_t* indices = world->m_IndexBufferData.Begin() + start;
+        const uint16_t* cached_indices = component->m_Indices.Begin() + index_start;
+        uint32_t vertex_offset = component->m_VertexStart & (VERTEX_SEGMENT_SIZE - 1);
+        for (uint32_t i = 0; i < index_count; ++i)
+        {
+            indices[i] = (uint16_t)(cached_indices[i] + vertex_offset);
+        }
     }
 
-    static dmRender::RenderObject& AcquireRenderObject(SpineModelWorld* world)
+    // Appends all indices of the component, and its draw descs (if any)
+    static void AppendComponentIndices(SpineModelWorld* world, const SpineModelComponent* component)
     {
-        uint32_t render_object_index = world->m_RenderObjectsInUse;
+        uint32_t index_start = world->m_IndexBufferData.Size();
+        AppendIndices(world, component, 0, component->m_Indices.Size());
 
-        // SetSize cannot relocate here because it remains within reserved capacity.
-        if (render_object_index < world->m_RenderObjects.Capacity())
+        for (uint32_t i = 0; i < component->m_DrawDescs.Size(); ++i)
         {
-            if (render_object_index == world->m_RenderObjects.Size())
-            {
-                world->m_RenderObjects.SetSize(render_object_index + 1);
-            }
-
-            ++world->m_RenderObjectsInUse;
-            return world->m_RenderObjects[render_object_index];
+            SpineIndexedDrawDesc desc = component->m_DrawDescs[i];
+            desc.m_IndexStart += index_start;
+            world->m_DrawDescBuffer.Push(desc);
         }
+    }
 
-        // Overflow blocks do not move when the block-pointer array grows.
-        uint32_t overflow_index = render_object_index - world->m_RenderObjects.Capacity();
-        uint32_t block_index = overflow_index >> RENDER_OBJECT_OVERFLOW_BLOCK_SHIFT;
-        uint32_t block_offset = overflow_index & RENDER_OBJECT_OVERFLOW_BLOCK_MASK;
-        if (block_index == world->m_RenderObjectOverflowBlocks.Size())
+    // Appends the slots of all the components grouped by blend mode, the normal slots first, with one draw desc per blend mode.
+    // Used with DRAW_ORDER_LAYERED, where the slots of the other blend modes are considered order independent
+    static void AppendLayeredIndices(SpineModelWorld* world, dmArray<SpineModelComponent*>& components, dmRender::RenderListEntry* buf, uint32_t* begin, uint32_t* end)
+    {
+        for (uint32_t blend_mode = SP_BLEND_MODE_NORMAL; blend_mode <= SP_BLEND_MODE_SCREEN; ++blend_mode)
         {
-            if (world->m_RenderObjectOverflowBlocks.Full())
+            uint32_t index_start = world->m_IndexBufferData.Size();
+            for (uint32_t *i = begin; i != end; ++i)
             {
-                uint32_t new_capacity = dmMath::Max(4U, world->m_RenderObjectOverflowBlocks.Capacity() * 2);
-                world->m_RenderObjectOverflowBlocks.SetCapacity(new_capacity);
+                const SpineModelComponent* component = components[(uint32_t)buf[*i].m_UserData];
+                for (uint32_t j = 0; j < component->m_DrawDescs.Size(); ++j)
+                {
+                    const SpineIndexedDrawDesc& desc = component->m_DrawDescs[j];
+                    if (desc.m_BlendMode == blend_mode)
+                    {
+                        AppendIndices(world, component, desc.m_IndexStart, desc.m_IndexCount);
+                    }
+                }
             }
-            world->m_RenderObjectOverflowBlocks.Push(new dmRender::RenderObject[RENDER_OBJECT_OVERFLOW_BLOCK_SIZE]);
-        }
 
-        ++world->m_RenderObjectsInUse;
-        return world->m_RenderObjectOverflowBlocks[block_index][block_offset];
+            uint32_t index_count = world->m_IndexBufferData.Size() - index_start;
+            if (index_count)
+            {
+                SpineIndexedDrawDesc desc = { index_start, index_count, blend_mode };
+                world->m_DrawDescBuffer.Push(desc);
+            }
+        }
     }
 
-    static void PrepareRenderObjectsForFrame(SpineModelWorld* world)
+    // A component with more vertices than a segment is drawn on its own, with one draw per segment (and blend mode)
+    static void RenderSegmentedComponent(SpineModelWorld* world, dmRender::HRenderContext render_context, const SpineModelComponent* component,
+                                         dmGraphics::HTexture texture, dmRender::HMaterial material, dmGameSystemDDF::SpineModelDesc::BlendMode blend_mode,
+                                         bool use_inherit_blend, dmGraphics::HVertexDeclaration vertex_declaration, SpineVertexRanges& ranges)
     {
-        // BEGIN is the safe relocation point described above. Absorb the previous
-        // high-water mark so overflow storage remains a one-frame spike path.
-        if (world->m_RenderObjectsInUse > world->m_RenderObjects.Capacity())
+        uint32_t first_segment = component->m_VertexStart >> VERTEX_SEGMENT_SHIFT;
+        uint32_t draw_desc = 0;
+        for (uint32_t i = 0; i < component->m_IndexSegments.Size(); ++i)
         {
-            uint32_t new_capacity = (world->m_RenderObjectsInUse + RENDER_OBJECT_OVERFLOW_BLOCK_MASK) & ~RENDER_OBJECT_OVERFLOW_BLOCK_MASK;
-            world->m_RenderObjects.SetCapacity(new_capacity);
+            const SpineIndexSegment& index_segment = component->m_IndexSegments[i];
+            uint32_t index_start = world->m_IndexBufferData.Size();
+            AppendIndices(world, component, index_segment.m_IndexStart, index_segment.m_IndexCount);
 
-            for (uint32_t i = 0; i < world->m_RenderObjectOverflowBlocks.Size(); ++i)
+            dmGraphics::HVertexBuffer vertex_buffer = GetSegmentVertexBuffer(world, ranges, (first_segment + index_segment.m_Segment) << VERTEX_SEGMENT_SHIFT);
+            if (!use_inherit_blend)
             {
-                delete[] world->m_RenderObjectOverflowBlocks[i];
+                FillRenderObject(world, render_context, component, texture, material, blend_mode, vertex_declaration, vertex_buffer,
+                    index_start, index_segment.m_IndexCount);
+                continue;
             }
-            world->m_RenderObjectOverflowBlocks.SetSize(0);
-        }
 
-        world->m_RenderObjectsInUse = 0;
+            // One draw desc per attachment, so they never cross a segment
+            world->m_DrawDescBuffer.SetSize(0);
+            uint32_t index_end = index_segment.m_IndexStart + index_segment.m_IndexCount;
+            for (; draw_desc < component->m_DrawDescs.Size() && component->m_DrawDescs[draw_desc].m_IndexStart < index_end; ++draw_desc)
+            {
+                SpineIndexedDrawDesc desc = component->m_DrawDescs[draw_desc];
+                desc.m_IndexStart = desc.m_IndexStart - index_segment.m_IndexStart + index_start;
+                world->m_DrawDescBuffer.Push(desc);
+            }
+            if (world->m_DrawDescBuffer.Empty())
+                continue;
+
+            MergeIndexedDrawDescs(world->m_DrawDescBuffer, world->m_MergedDrawDescBuffer);
+            for (uint32_t j = 0; j < world->m_MergedDrawDescBuffer.Size(); ++j)
+            {
+                const SpineIndexedDrawDesc& desc = world->m_MergedDrawDescBuffer[j];
+                FillRenderObject(world, render_context, component, texture, material,
+                    SpineBlendModeToRenderBlendMode((spBlendMode) desc.m_BlendMode), vertex_declaration, vertex_buffer,
+                    desc.m_IndexStart, desc.m_IndexCount);
+            }
+        }
     }
 
     static void RenderBatch(SpineModelWorld* world, dmRender::HRenderContext render_context, dmRender::RenderListEntry *buf, uint32_t* begin, uint32_t* end)
     {
-        //DM_PROFILE(SpineModel, "RenderBatch");
+        DM_PROFILE("RenderBatch");
 
         dmArray<SpineModelComponent*>& components = world->m_Components.GetRawObjects();
 
@@ -1147,70 +2422,144 @@ namespace dmSpine
         const SpineModelComponent* first   = (const SpineModelComponent*) components[component_index];
         const SpineModelResource* resource = first->m_Resource;
 
+        DM_PROPERTY_ADD_U32(rmtp_SpineBatches, 1);
+
+        if (UseGpuSkinning(first))
+        {
+            // Never batched with other components (see ReHash)
+            RenderSkinnedComponent(world, render_context, components[component_index], component_index);
+            return;
+        }
+
         dmGameSystemDDF::SpineModelDesc::BlendMode blend_mode = resource->m_Ddf->m_BlendMode;
         bool use_inherit_blend = blend_mode == dmGameSystemDDF::SpineModelDesc::BLEND_MODE_INHERIT;
+        // Part of the batch key, as is the vertex format
+        bool use_layers = use_inherit_blend && resource->m_Ddf->m_DrawOrder == dmGameSystemDDF::SpineModelDesc::DRAW_ORDER_LAYERED;
+        // Part of the batch key, so all components in the batch use the same format
+        bool compact_vertices = resource->m_Ddf->m_VertexFormat == dmGameSystemDDF::SpineModelDesc::VERTEX_FORMAT_COMPACT;
+        dmGraphics::HVertexDeclaration vertex_declaration = compact_vertices ? world->m_CompactVertexDeclaration : world->m_VertexDeclaration;
+        SpineVertexRanges& ranges = compact_vertices ? world->m_CompactVertexRanges : world->m_VertexRanges;
 
-        uint32_t index_start            = world->m_IndexBufferData.Size();
-        uint32_t draw_desc_buffer_count = 0;
-
-        // This is a temporary scratch buffer just used for this batch call, so we make sure to reset it.
-        world->m_DrawDescBuffer.SetSize(0);
+        uint32_t index_count     = 0;
+        uint32_t draw_desc_count = 0;
 
+        // Only the components that have changed since they were last drawn generate new vertices
         for (uint32_t *i = begin; i != end; ++i)
         {
             component_index = (uint32_t)buf[*i].m_UserData;
-            if (use_inherit_blend)
-            {
-                const SpineModelComponent* component = (const SpineModelComponent*) components[component_index];
-                draw_desc_buffer_count += (uint32_t)component->m_SkeletonInstance->slotsCount;
-            }
+            SpineModelComponent* component = components[component_index];
+            if (compact_vertices)
+                UpdateComponentGeometry(world, component, component_index, world->m_CompactVertexBufferData, ranges, compact_vertices, use_inherit_blend);
+            else
+                UpdateComponentGeometry(world, component, component_index, world->m_VertexBufferData, ranges, compact_vertices, use_inherit_blend);
+            index_count += component->m_Indices.Size();
+            draw_desc_count += component->m_DrawDescs.Size();
         }
 
-        if (draw_desc_buffer_count && draw_desc_buffer_count > world->m_DrawDescBuffer.Capacity())
+        if (index_count == 0)
         {
-            uint32_t new_capacity = dmMath::Max(draw_desc_buffer_count, dmMath::Max(32U, world->m_DrawDescBuffer.Capacity() * 2));
-            world->m_DrawDescBuffer.SetCapacity(new_capacity);
+            return;
         }
 
-        for (uint32_t *i = begin; i != end; ++i)
+        if (world->m_IndexBufferData.Remaining() < index_count)
         {
-            component_index = (uint32_t)buf[*i].m_UserData;
-            const SpineModelComponent* component = (const SpineModelComponent*) components[component_index];
-            dmSpine::GenerateIndexedVertexData(world->m_VertexBufferData, world->m_IndexBufferData, component->m_SkeletonInstance, world->m_SkeletonClipper, component->m_World, Vector4(1.0f), use_inherit_blend ? &world->m_DrawDescBuffer : 0, world->m_GeometryScratch);
+            uint32_t new_capacity = dmMath::Max(world->m_IndexBufferData.Size() + index_count, world->m_IndexBufferData.Capacity() * 2);
+            world->m_IndexBufferData.SetCapacity(new_capacity);
         }
 
-        uint32_t index_count = world->m_IndexBufferData.Size() - index_start;
-        if (index_count == 0)
+        if (draw_desc_count > world->m_DrawDescBuffer.Capacity())
         {
-            return;
+            uint32_t new_capacity = dmMath::Max(draw_desc_count, dmMath::Max(32U, world->m_DrawDescBuffer.Capacity() * 2));
+            world->m_DrawDescBuffer.SetCapacity(new_capacity);
         }
 
         dmGraphics::HTexture texture = GetSpineScene(first)->m_TextureSet->m_Texture->m_Texture; // spine - texture set resource - texture resource - texture
         dmRender::HMaterial material = GetMaterial(first);
 
-        if (use_inherit_blend)
+        // The components are drawn together as long as their vertices are in the same segment
+        uint32_t* run_begin = begin;
+        while (run_begin != end)
         {
-            uint32_t draw_desc_count = world->m_DrawDescBuffer.Size();
-            if (draw_desc_count > 0)
+            const SpineModelComponent* run_first = components[(uint32_t)buf[*run_begin].m_UserData];
+            if (!run_first->m_IndexSegments.Empty())
             {
-                MergeIndexedDrawDescs(world->m_DrawDescBuffer, world->m_MergedDrawDescBuffer);
+                RenderSegmentedComponent(world, render_context, run_first, texture, material, blend_mode, use_inherit_blend, vertex_declaration, ranges);
+                ++run_begin;
+                continue;
+            }
+
+            uint32_t index_start = world->m_IndexBufferData.Size();
+            uint32_t segment     = VERTEX_SEGMENT_SIZE; // none yet
+
+            // This is a temporary scratch buffer just used for this run, so we make sure to reset it.
+            world->m_DrawDescBuffer.SetSize(0);
 
-                uint32_t merged_size = world->m_MergedDrawDescBuffer.Size();
-                for (int i = 0; i < merged_size; ++i)
+            uint32_t* run_end = run_begin;
+            for (; run_end != end; ++run_end)
+            {
+                const SpineModelComponent* component = components[(uint32_t)buf[*run_end].m_UserData];
+                if (component->m_Indices.Empty())
+                    continue;
+                if (!component->m_IndexSegments.Empty())
+                    break;
+
+                uint32_t component_segment = component->m_VertexStart >> VERTEX_SEGMENT_SHIFT;
+                if (segment == VERTEX_SEGMENT_SIZE)
+                    segment = component_segment;
+                else if (component_segment != segment)
+                    break;
+            }
+
+            if (segment == VERTEX_SEGMENT_SIZE)
+            {
+                // Only components without geometry, up to the end or to a segmented component
+                run_begin = run_end;
+                continue;
+            }
+
+            if (use_layers)
+            {
+                AppendLayeredIndices(world, components, buf, run_begin, run_end);
+            }
+            else
+            {
+                for (uint32_t *i = run_begin; i != run_end; ++i)
                 {
-                    dmRender::RenderObject& ro = AcquireRenderObject(world);
-                    FillRenderObject(world, render_context, ro, first->m_RenderConstants, texture, material,
-                        SpineBlendModeToRenderBlendMode((spBlendMode) world->m_MergedDrawDescBuffer[i].m_BlendMode),
-                        world->m_MergedDrawDescBuffer[i].m_IndexStart,
-                        world->m_MergedDrawDescBuffer[i].m_IndexCount);
+                    AppendComponentIndices(world, components[(uint32_t)buf[*i].m_UserData]);
                 }
             }
+            run_begin = run_end;
+
+            dmGraphics::HVertexBuffer vertex_buffer = GetSegmentVertexBuffer(world, ranges, segment << VERTEX_SEGMENT_SHIFT);
+
+            if (use_inherit_blend)
+            {
+                if (world->m_DrawDescBuffer.Size() > 0)
+                {
+                    MergeIndexedDrawDescs(world->m_DrawDescBuffer, world->m_MergedDrawDescBuffer);
+
+                    uint32_t merged_size = world->m_MergedDrawDescBuffer.Size();
+                    for (int i = 0; i < merged_size; ++i)
+                    {
+                        FillRenderObject(world, render_context, first, texture, material,
+                            SpineBlendModeToRenderBlendMode((spBlendMode) world->m_MergedDrawDescBuffer[i].m_BlendMode), vertex_declaration, vertex_buffer,
+                            world->m_MergedDrawDescBuffer[i].m_IndexStart,
+                            world->m_MergedDrawDescBuffer[i].m_IndexCount);
+                    }
+                }
+            }
+            else
+            {
+                FillRenderObject(world, render_context, first, texture, material, blend_mode, vertex_declaration, vertex_buffer,
+                    index_start, world->m_IndexBufferData.Size() - index_start);
+            }
         }
-        else
-        {
-            dmRender::RenderObject& ro = AcquireRenderObject(world);
-            FillRenderObject(world, render_context, ro, first->m_RenderConstants, texture, material, blend_mode, index_start, index_count);
-        }
+    }
+
+    // The frustum planes point inwards, but aren't necessarily normalized
+    static inline float PlaneDistance(const dmVMath::Vector4& plane, const dmVMath::Vector4& point)
+    {
+        return Vectormath::Aos::dot(plane, point) / Vectormath::Aos::length(plane.getXYZ());
     }
 
     static void RenderListFrustumCulling(dmRender::RenderListVisibilityParams const &params)
@@ -1232,24 +2581,44 @@ namespace dmSpine
             const SpineModelBounds& bounds = world->m_BoundingBoxes[component_index];
             if (bounds.minX > bounds.maxX || bounds.minY > bounds.maxY)
             {
+                // Nothing to draw, but we can't tell if it's on screen, so it's not considered culled
                 entry->m_Visibility = dmRender::VISIBILITY_NONE;
                 continue;
             }
 
-            // get center of bounding box in local coords
-            float center_x = (bounds.maxX + bounds.minX)/2;
-            float center_y = (bounds.maxY + bounds.minY)/2;
-            dmVMath::Point3 center_local(center_x, center_y, 0);
-            dmVMath::Point3 corner_local(bounds.maxX, bounds.maxY, 0);
-
-            // transform to world coords
-            dmVMath::Vector4 center_world = component_p->m_World * center_local;
-            dmVMath::Vector4 corner_world = component_p->m_World * corner_local;
+            // The corners of the bounding box in world coords
+            dmVMath::Vector4 corners[4];
+            corners[0] = component_p->m_World * dmVMath::Point3(bounds.minX, bounds.minY, 0);
+            corners[1] = component_p->m_World * dmVMath::Point3(bounds.maxX, bounds.minY, 0);
+            corners[2] = component_p->m_World * dmVMath::Point3(bounds.maxX, bounds.maxY, 0);
+            corners[3] = component_p->m_World * dmVMath::Point3(bounds.minX, bounds.maxY, 0);
+
+            // Culled if all corners are outside the same plane. A box that is close to a frustum corner may still pass,
+            // but that's rare compared to the false positives of a bounding sphere around a long and thin box
+            bool intersect = true;
+            for (uint32_t p = 0; p < 6 && intersect; ++p)
+            {
+                const dmVMath::Vector4& plane = frustum.m_Planes[p];
+                intersect = Vectormath::Aos::dot(plane, corners[0]) >= 0.0f
+                         || Vectormath::Aos::dot(plane, corners[1]) >= 0.0f
+                         || Vectormath::Aos::dot(plane, corners[2]) >= 0.0f
+                         || Vectormath::Aos::dot(plane, corners[3]) >= 0.0f;
+            }
+            entry->m_Visibility = intersect ? dmRender::VISIBILITY_FULL : dmRender::VISIBILITY_NONE;
 
-            float radius =  Vectormath::Aos::length(corner_world - center_world);
+            // The component may be drawn with several frustums (e.g. cameras) per frame
+            component_p->m_VisibilityTested = 1;
+            component_p->m_Visible |= intersect;
 
-            bool intersect = dmIntersection::TestFrustumSphere(frustum, center_world, radius);
-            entry->m_Visibility = intersect ? dmRender::VISIBILITY_FULL : dmRender::VISIBILITY_NONE;
+            if (intersect)
+            {
+                // The size relative to the frustum width at the center of the model (for the LOD)
+                dmVMath::Vector4 center_world = (corners[0] + corners[2]) * 0.5f;
+                float diameter = Vectormath::Aos::length(corners[2] - corners[0]);
+                float width = PlaneDistance(frustum.m_Planes[0], center_world) + PlaneDistance(frustum.m_Planes[1], center_world);
+                float size = width > 0.0f ? diameter / width : 1.0f;
+                component_p->m_ScreenSize = dmMath::Max(component_p->m_ScreenSize, size);
+            }
         }
     }
 
@@ -1263,9 +2632,11 @@ namespace dmSpine
             case dmRender::RENDER_LIST_OPERATION_BEGIN:
             {
                 PrepareRenderObjectsForFrame(world);
-                world->m_VertexBufferData.SetSize(0);
+                // The vertices of the CPU skinned components are kept between frames
+                ReleaseFragmentedVertexRanges(world, world->m_VertexBufferData, world->m_VertexRanges, false);
+                ReleaseFragmentedVertexRanges(world, world->m_CompactVertexBufferData, world->m_CompactVertexRanges, true);
+                world->m_SkinnedVertexBufferData.SetSize(0);
                 world->m_IndexBufferData.SetSize(0);
-                world->m_PackedIndexBufferData.SetSize(0);
                 break;
             }
             case dmRender::RENDER_LIST_OPERATION_BATCH:
@@ -1275,43 +2646,24 @@ namespace dmSpine
             }
             case dmRender::RENDER_LIST_OPERATION_END:
             {
-                world->m_Is16BitIndex = world->m_VertexBufferData.Size() <= 65536;
-                uint32_t vertex_data_size = sizeof(dmSpine::SpineVertex) * world->m_VertexBufferData.Size();
-                uint32_t index_data_size = GetIndexTypeSize(world) * world->m_IndexBufferData.Size();
-                if (vertex_data_size && index_data_size)
+                // The indices are already 16 bit, relative to the vertex segment of their render object
+                uint32_t index_data_size = sizeof(uint16_t) * world->m_IndexBufferData.Size();
+                // GPU skinned components only add indices, their vertices are static
+                if (index_data_size)
                 {
-                    PackIndexBufferData(world);
-                    dmGraphics::SetVertexBufferData(world->m_VertexBuffer, vertex_data_size,
-                                                    world->m_VertexBufferData.Begin(), dmGraphics::BUFFER_USAGE_DYNAMIC_DRAW);
+                    // Only the ranges of the components that have changed are uploaded
+                    uint32_t vertex_data_size = UploadVertexRanges(world, world->m_VertexBufferData, world->m_VertexRanges);
+                    vertex_data_size += UploadVertexRanges(world, world->m_CompactVertexBufferData, world->m_CompactVertexRanges);
+                    MarkVerticesDirty(world->m_SkinnedVertexRanges, 0, world->m_SkinnedVertexBufferData.Size());
+                    vertex_data_size += UploadVertexRanges(world, world->m_SkinnedVertexBufferData, world->m_SkinnedVertexRanges);
                     dmGraphics::SetIndexBufferData(world->m_IndexBuffer, index_data_size,
-                                                   world->m_PackedIndexBufferData.Begin(), dmGraphics::BUFFER_USAGE_DYNAMIC_DRAW);
-
-                    uint32_t index_type_size = GetIndexTypeSize(world);
-                    dmGraphics::Type index_type = GetIndexType(world);
-                    uint32_t primary_render_object_count = dmMath::Min(world->m_RenderObjectsInUse, world->m_RenderObjects.Capacity());
-                    for (uint32_t i = 0; i < primary_render_object_count; ++i)
-                    {
-                        world->m_RenderObjects[i].m_IndexType = index_type;
-                        world->m_RenderObjects[i].m_VertexStart *= index_type_size;
-                    }
-
-                    uint32_t render_objects_left = world->m_RenderObjectsInUse - primary_render_object_count;
-                    for (uint32_t block_index = 0; render_objects_left > 0; ++block_index)
-                    {
-                        dmRender::RenderObject* block = world->m_RenderObjectOverflowBlocks[block_index];
-                        uint32_t render_objects_in_block = dmMath::Min(RENDER_OBJECT_OVERFLOW_BLOCK_SIZE, render_objects_left);
-                        for (uint32_t i = 0; i < render_objects_in_block; ++i)
-                        {
-                            block[i].m_IndexType = index_type;
-                            block[i].m_VertexStart *= index_type_size;
-                        }
-                        render_objects_left -= render_objects_in_block;
-                    }
+                                                   world->m_IndexBufferData.Begin(), dmGraphics::BUFFER_USAGE_DYNAMIC_DRAW);
 
-                    DM_PROPERTY_ADD_U32(rmtp_SpineVertexCount, world->m_VertexBufferData.Size());
+                    DM_PROPERTY_ADD_U32(rmtp_SpineVertexCount, world->m_VertexBufferData.Size() + world->m_CompactVertexBufferData.Size() + world->m_SkinnedVertexBufferData.Size());
                     DM_PROPERTY_ADD_U32(rmtp_SpineVertexSize, vertex_data_size);
                     DM_PROPERTY_ADD_U32(rmtp_SpineIndexSize, index_data_size);
                 }
+                UpdateFrameGeometryStats(world);
                 break;
             }
             default:
@@ -1331,6 +2683,9 @@ namespace dmSpine
         dmArray<SpineModelComponent*>& components = world->m_Components.GetRawObjects();
         const uint32_t count = components.Size();
 
+        // The attachment vertices are computed once here, and reused when generating the geometry of the visible components
+        world->m_WorldVertices.SetSize(0);
+        ReserveFrameGeometry(world);
         for (uint32_t i = 0; i < count; ++i)
         {
             SpineModelComponent& component = *components[i];
@@ -1338,7 +2693,40 @@ namespace dmSpine
                 continue;
 
             SpineModelBounds& bounds = world->m_BoundingBoxes[i];
-            dmSpine::GetSkeletonBounds(component.m_SkeletonInstance, bounds, world->m_GeometryScratch);
+            const spSkeleton* skeleton = GetRenderSkeleton(&component);
+
+            // The precalculated animation bounds don't need the vertices of the pose at all
+            bool animation_bounds = UseAnimationBounds(&component);
+            if (animation_bounds)
+                GetAnimationStateBounds(&component, bounds);
+
+            // The GPU skinned components don't need the vertices, unless they fall back to the CPU
+            SpineSkinnedGeometry* geometry = UseGpuSkinning(&component) ? AcquireSkinnedGeometry(GetSpineScene(&component), world->m_GraphicsContext) : 0;
+            if (geometry && (animation_bounds || GetSkinnedBounds(geometry, skeleton, bounds)))
+            {
+                world->m_WorldVertexOffsets[i] = INVALID_WORLD_VERTEX_OFFSET;
+                continue;
+            }
+
+            // An unchanged pose keeps its bounds, and its vertices are only needed again if the transform has changed
+            component.m_PoseKey = CalcPoseKey(skeleton);
+            if (animation_bounds)
+            {
+                world->m_WorldVertexOffsets[i] = INVALID_WORLD_VERTEX_OFFSET;
+                continue;
+            }
+            if (component.m_BoundsValid && component.m_BoundsKey == component.m_PoseKey)
+            {
+                bounds = component.m_Bounds;
+                world->m_WorldVertexOffsets[i] = INVALID_WORLD_VERTEX_OFFSET;
+                continue;
+            }
+
+            world->m_WorldVertexOffsets[i] = world->m_WorldVertices.Size();
+            dmSpine::GetSkeletonWorldVertices(skeleton, bounds, world->m_WorldVertices);
+            component.m_Bounds = bounds;
+            component.m_BoundsKey = component.m_PoseKey;
+            component.m_BoundsValid = 1;
         }
 
         // Prepare list submit
@@ -1352,8 +2740,19 @@ namespace dmSpine
             if (!component.m_DoRender || !component.m_Enabled)
                 continue;
 
+            // Updated by the frustum culling (if any), and used by the next update. A negative size isn't measured
+            component.m_VisibilityTested = 0;
+            component.m_Visible = 0;
+            component.m_ScreenSize = -1.0f;
+
             const Vector4 trans = component.m_World.getCol(3);
-            write_ptr->m_WorldPosition = Point3(trans.getX(), trans.getY(), trans.getZ());
+            float z = trans.getZ();
+            if (context->m_BatchDepthTolerance > 0.0f)
+            {
+                // Models at about the same depth get the same sort depth, and are then ordered (and batched) by their batch key
+                z = floorf(z / context->m_BatchDepthTolerance + 0.5f) * context->m_BatchDepthTolerance;
+            }
+            write_ptr->m_WorldPosition = Point3(trans.getX(), trans.getY(), z);
             write_ptr->m_UserData = (uintptr_t) i;
             write_ptr->m_BatchKey = component.m_MixedHash;
             write_ptr->m_TagListKey = dmRender::GetMaterialTagListKey(GetMaterial(&component));
@@ -1442,6 +2841,9 @@ namespace dmSpine
         // We need to make sure that bone GOs are created before we start the default animation.
         ScheduleBoneRebuild(component);
         component->m_ReHash = 1;
+        // The attachments may have changed without the pose key noticing
+        component->m_BoundsValid = 0;
+        component->m_GeometryValid = 0;
         return true;
     }
 
@@ -1545,6 +2947,12 @@ namespace dmSpine
         {
             return dmGameSystem::GetResourceProperty(context->m_Factory, GetMaterialResource(component), out_value);
         }
+        else if (params.m_PropertyId == PROP_LOD_THRESHOLD_1 || params.m_PropertyId == PROP_LOD_THRESHOLD_2)
+        {
+            uint32_t lod_index = params.m_PropertyId == PROP_LOD_THRESHOLD_1 ? 0 : 1;
+            out_value.m_Variant = dmGameObject::PropertyVar(component->m_LodThresholds[lod_index]);
+            return dmGameObject::PROPERTY_RESULT_OK;
+        }
         else if (params.m_PropertyId == SPINE_SCENE)
         {
             return dmGameSystem::GetResourceProperty(context->m_Factory, (void*)GetSpineScene(component), out_value);
@@ -1640,8 +3048,19 @@ namespace dmSpine
             component->m_ReHash |= res == dmGameObject::PROPERTY_RESULT_OK;
             return res;
         }
+        else if (params.m_PropertyId == PROP_LOD_THRESHOLD_1 || params.m_PropertyId == PROP_LOD_THRESHOLD_2)
+        {
+            if (params.m_Value.m_Type != dmGameObject::PROPERTY_TYPE_NUMBER)
+                return dmGameObject::PROPERTY_RESULT_TYPE_MISMATCH;
+
+            uint32_t lod_index = params.m_PropertyId == PROP_LOD_THRESHOLD_1 ? 0 : 1;
+            component->m_LodThresholds[lod_index] = params.m_Value.m_Number;
+            return dmGameObject::PROPERTY_RESULT_OK;
+        }
         else if (params.m_PropertyId == SPINE_SCENE)
         {
+            // The shared pose belongs to the current scene
+            ReleaseSharedPose(component, true);
             dmGameObject::PropertyResult res = dmGameSystem::SetResourceProperty(context->m_Factory, params.m_Value, SPINE_SCENE_EXT_HASH, (void**)&component->m_SpineScene);
             if (res == dmGameObject::PROPERTY_RESULT_OK)
             {
@@ -1697,6 +3116,25 @@ namespace dmSpine
         int32_t max_rig_instance = dmConfigFile::GetInt(ctx->m_Config, "rig.max_instance_count", 128);
         spinemodelctx->m_MaxSpineModelCount = dmMath::Max(dmConfigFile::GetInt(ctx->m_Config, "spine.max_count", 128), max_rig_instance);
 
+        // The calling thread also takes part in the update, so 1 means one extra thread
+        int32_t update_threads = dmConfigFile::GetInt(ctx->m_Config, "spine.update_threads", 0);
+        if (update_threads > 0)
+        {
+            spinemodelctx->m_UpdateJobPool = NewJobPool((uint32_t)update_threads);
+        }
+
+        spinemodelctx->m_LodUpdateIntervals[0] = (uint32_t)dmMath::Max(1, dmConfigFile::GetInt(ctx->m_Config, "spine.lod_update_interval_1", 2));
+        spinemodelctx->m_LodUpdateIntervals[1] = (uint32_t)dmMath::Max(1, dmConfigFile::GetInt(ctx->m_Config, "spine.lod_update_interval_2", 4));
+
+        // Used by the spine models with the "Reduced Rate" culled update policy
+        spinemodelctx->m_CulledUpdateInterval = (uint32_t)dmMath::Max(1, dmConfigFile::GetInt(ctx->m_Config, "spine.culled_update_interval", 4));
+
+        // The depth range within which the spine models are grouped by their batch key (0 keeps the exact depth order)
+        spinemodelctx->m_BatchDepthTolerance = dmMath::Max(0.0f, dmConfigFile::GetFloat(ctx->m_Config, "spine.batch_depth_tolerance", 0.0f));
+
+        // Only for measuring: 0 fills every render object completely each frame
+        spinemodelctx->m_ReuseRenderObjects = dmConfigFile::GetInt(ctx->m_Config, "spine.reuse_render_objects", 1) != 0;
+
         // Spine system setup
         spBone_setYDown(0); // so we'll only call it once
 
@@ -1736,6 +3174,7 @@ namespace dmSpine
     static dmGameObject::Result CompTypeSpineModelDestroy(const dmGameObject::ComponentTypeCreateCtx* ctx, dmGameObject::ComponentType* type)
     {
         SpineModelContext* spinemodelctx = (SpineModelContext*)ComponentTypeGetContext(type);
+        DeleteJobPool(spinemodelctx->m_UpdateJobPool);
         delete spinemodelctx;
         return dmGameObject::RESULT_OK;
     }
@@ -1847,6 +3286,14 @@ namespace dmSpine
         return true;
     }
 
+    // The skins are shared by all instances, so any cached pose may be out of date. The GPU skinning geometry is
+    // looked up by attachment, and the attachments that the skin functions dispose may be reallocated at the same address
+    static void ResetSkinDependentData(SpineSceneResource* spine_scene)
+    {
+        ResetPoseCache(spine_scene);
+        ResetSkinnedGeometry(spine_scene);
+    }
+
     bool CompSpineModelClearSkin(SpineModelComponent* component, dmhash_t skin_id)
     {
         SpineModelResource* spine_model = component->m_Resource;
@@ -1866,6 +3313,7 @@ namespace dmSpine
         }
 
         spSkin_clear(skin);
+        ResetSkinDependentData(spine_scene);
 
         return true;
     }
@@ -1900,7 +3348,9 @@ namespace dmSpine
             skin_b = spine_scene->m_Skeleton->skins[*index];
         }
 
+        AccountScope account_scope(&spine_scene->m_InstanceAccount);
         spSkin_addSkin(skin_a,skin_b);
+        ResetSkinDependentData(spine_scene);
 
         return true;
     }
@@ -1935,7 +3385,9 @@ namespace dmSpine
             skin_b = spine_scene->m_Skeleton->skins[*index];
         }
 
+        AccountScope account_scope(&spine_scene->m_InstanceAccount);
         spSkin_copySkin(skin_a,skin_b);
+        ResetSkinDependentData(spine_scene);
 
         return true;
     }
@@ -1952,6 +3404,7 @@ namespace dmSpine
             return false;
         }
 
+        MakePoseUnique(component);
         spSlot* slot = component->m_SkeletonInstance->slots[*index];
         spColor_setFromFloats(&slot->color, color->getX(), color->getY(), color->getZ(), color->getW());
 
@@ -1984,12 +3437,21 @@ namespace dmSpine
             attachment_name = *p_attachment_name;
         }
 
+        MakePoseUnique(component);
         spSlot* slot = component->m_SkeletonInstance->slots[*index];
 
         // it's a bit weird to use strings here, but we'd rather not use too much knowledge about the internals
         return 1 == spSkeleton_setAttachment(component->m_SkeletonInstance, slot->data->name, attachment_name);
     }
 
+    void CompSpineModelGetMemoryStats(SpineModelComponent* component, SpineSceneMemoryStats* stats)
+    {
+        SpineSceneResource* spine_scene = GetSpineScene(component);
+        stats->m_DataSize = GetSpineSceneDataSize(spine_scene);
+        stats->m_InstanceSize = (uint32_t)dmAtomicGet32(&spine_scene->m_InstanceAccount.m_Size);
+        stats->m_InstanceAllocationCount = (uint32_t)dmAtomicGet32(&spine_scene->m_InstanceAccount.m_AllocationCount);
+    }
+
     bool CompSpineModelGetBone(SpineModelComponent* component, dmhash_t bone_name, dmhash_t* instance_id)
     {
         uint32_t* index = component->m_BoneNameToNodeInstanceIndex.Get(bone_name);
@@ -2002,11 +3464,13 @@ namespace dmSpine
 
     void CompSpineModelPhysicsTranslate(SpineModelComponent* component, Point3 translation)
     {
+        MakePoseUnique(component);
         spSkeleton_physicsTranslate(component->m_SkeletonInstance, translation.getX(), translation.getY());
     }
 
     void CompSpineModelPhysicsRotate(SpineModelComponent* component, Point3 center, float degrees)
     {
+        MakePoseUnique(component);
         spSkeleton_physicsRotate(component->m_SkeletonInstance, center.getX(), center.getY(), degrees);
     }
 }
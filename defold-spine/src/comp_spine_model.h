@@ -26,10 +26,15 @@
 // The engine ddf formats aren't stored in the "dmsdk" folder (yet)
 #include <gamesys/gamesys_ddf.h>
 
+#include <common/vertices.h>
+
 #include "res_spine_model.h"
+#include "spine_pose_cache.h"
 
+struct spAnimation;
 struct spAnimationState;
 struct spBone;
+struct spEvent;
 struct spSkeleton;
 struct spTrackEntry;
 struct spIkConstraint;
@@ -38,6 +43,7 @@ struct lua_State;
 namespace dmSpine
 {
     const int32_t ALL_TRACKS = -1;
+    const uint32_t SPINE_LOD_COUNT = 3;
 
     struct SpineAnimationTrack {
         spTrackEntry*                           m_AnimationInstance;
@@ -58,6 +64,17 @@ namespace dmSpine
         dmVMath::Point3                         m_Position;
     };
 
+    // Listener events recorded while the skeleton is evaluated on a worker thread.
+    // They're dispatched (messages and Lua callbacks) later on the main thread.
+    struct SpineDeferredEvent
+    {
+        const spAnimation*                      m_Animation;
+        const spEvent*                          m_Event;
+        int32_t                                 m_Type; // spEventType
+        int32_t                                 m_TrackIndex;
+        uint32_t                                m_CallbackId;
+    };
+
     struct SpineModelComponent
     {
         dmGameObject::HInstance                 m_Instance;
@@ -68,7 +85,9 @@ namespace dmSpine
         spAnimationState*                       m_AnimationStateInstance;
         dmArray<dmSpine::SpineAnimationTrack>   m_AnimationTracks;
         dmArray<dmScript::LuaCallbackInfo*>      m_DeferredCallbacks;
+        dmArray<dmSpine::SpineDeferredEvent>    m_DeferredEvents;
         dmGameSystem::HComponentRenderConstants m_RenderConstants;
+        dmRender::HNamedConstantBuffer          m_SkinningConstants;    // The bone transforms and slot colors (GPU skinning)
         dmGameSystem::MaterialResource*         m_Material;
         SpineSceneResource*                     m_SpineScene;
         /// Node instances corresponding to the bones
@@ -78,6 +97,27 @@ namespace dmSpine
 
         dmArray<dmSpine::IKTarget>              m_IKTargets;
         dmArray<dmSpine::IKTarget>              m_IKTargetPositions;
+        /// The pose shared with other instances, if any (see pose_cache_step)
+        SpinePose*                              m_Pose;
+        SpinePoseDesc                           m_PoseDesc;
+        uint32_t                                m_PoseGeneration;
+        uint32_t                                m_CulledFrameCount;
+        float                                   m_LodThresholds[SPINE_LOD_COUNT - 1];  // Screen sizes (relative to the view width) below which the next LOD is used
+        float                                   m_ScreenSize;                           // Largest size of the last rendered frame, or negative if it wasn't measured (no frustum culling)
+        float                                   m_LodTime;                              // Time accumulated since the last update
+        float                                   m_UpdateDT;                             // The time step for this frame's update
+        uint32_t                                m_LodFrameCount;
+        /// The geometry of the last rendered pose, reused while the pose and transform are unchanged
+        dmArray<uint16_t>                       m_Indices;          // Relative to m_VertexStart
+        dmArray<SpineIndexedDrawDesc>           m_DrawDescs;        // Relative to m_Indices (inherited blend modes)
+        dmArray<SpineIndexSegment>              m_IndexSegments;    // Set if the vertices span more than one segment, see GenerateSegmentedVertexData
+        SpineModelBounds                        m_Bounds;
+        SpineGeometrySizeCache                  m_GeometrySize;     // The vertex and index counts of m_Indices
+        uint64_t                                m_PoseKey;          // Hash of the render skeleton state of this frame
+        uint64_t                                m_BoundsKey;        // The pose key of m_Bounds
+        uint64_t                                m_GeometryKey;      // The pose key, transform and format of the vertices
+        uint32_t                                m_VertexStart;      // The range owned in the world vertex buffer
+        uint32_t                                m_VertexCapacity;
         uint32_t                                m_MixedHash;
         uint32_t                                m_CallbackInvocationDepth;
         uint16_t                                m_ComponentIndex;
@@ -86,6 +126,19 @@ namespace dmSpine
         uint8_t                                 m_AddedToUpdate : 1;
         uint8_t                                 m_ReHash : 1;
         uint8_t                                 m_RebuildBonesPending : 1;
+        uint8_t                                 m_DeferEvents : 1;
+        uint8_t                                 m_PoseOverridden : 1;   // The instance has been modified and can no longer share its pose
+        uint8_t                                 m_UsePoseCache : 1;
+        uint8_t                                 m_PoseCandidate : 1;
+        uint8_t                                 m_PoseFallback : 1;
+        uint8_t                                 m_VisibilityTested : 1; // Set if frustum culling was done in the last rendered frame
+        uint8_t                                 m_Visible : 1;
+        uint8_t                                 m_SkipPose : 1;         // Culled, and only the animation state is updated this frame
+        uint8_t                                 m_SkipConstraints : 1;  // Skip the transform, path and physics constraints (LOD)
+        uint8_t                                 m_Lod : 2;
+        uint8_t                                 m_BoundsValid : 1;
+        uint8_t                                 m_GeometryValid : 1;
+        uint8_t                                 m_CompactVertexRange : 1;   // The vertex range is in the compact vertex buffer
     };
 
     // For scripting
@@ -107,6 +160,14 @@ namespace dmSpine
     bool CompSpineModelSetAttachment(SpineModelComponent* component, dmhash_t slot_id, dmhash_t attachment_id);
     bool CompSpineModelGetBone(SpineModelComponent* component, dmhash_t bone_name, dmhash_t* instance_id);
 
+    struct SpineSceneMemoryStats
+    {
+        uint32_t m_DataSize;                // The resource size of the spine scene
+        uint32_t m_InstanceSize;            // The spine allocations of all the models and gui nodes using the spine scene
+        uint32_t m_InstanceAllocationCount;
+    };
+    void CompSpineModelGetMemoryStats(SpineModelComponent* component, SpineSceneMemoryStats* stats);
+
     void RunTrackCallback(dmScript::LuaCallbackInfo* callback_data, const dmDDF::Descriptor* desc, const char* data, const dmMessage::URL* sender);
     void CompSpineModelPhysicsTranslate(SpineModelComponent* component, Vectormath::Aos::Point3 translation);
     void CompSpineModelPhysicsRotate(SpineModelComponent* component, Vectormath::Aos::Point3 center, float degrees);
@@ -3,9 +3,13 @@
 #include "script_spine.h"
 #include "script_spine_resource.h"
 #include "gui_spine.h"
+#include "spine_allocator.h"
+#include "res_spine_scene.h"
 
 static dmExtension::Result AppInitializeSpine(dmExtension::AppParams* params)
 {
+    // Before any spine data is loaded
+    dmSpine::InstallAllocator();
     return dmExtension::RESULT_OK;
 }
 
@@ -21,6 +25,7 @@ static dmExtension::Result InitializeSpine(dmExtension::Params* params)
 
 static dmExtension::Result AppFinalizeSpine(dmExtension::AppParams* params)
 {
+    dmSpine::FinalizeSceneLoader();
     return dmExtension::RESULT_OK;
 }
 
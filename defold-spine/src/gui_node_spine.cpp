@@ -70,6 +70,8 @@ struct InternalGuiNode
     dmArray<GuiIKTarget>    m_IKTargets;           // targets that follow GUI nodes
     dmArray<GuiIKTarget>    m_IKTargetPositions;   // targets with fixed positions
 
+    dmSpine::SpineGeometrySizeCache m_GeometrySize; // The vertex count of the last frame
+
     uint32_t            m_CallbackInvocationDepth;
 
     uint8_t             m_FindBones : 1;
@@ -83,6 +85,7 @@ struct InternalGuiNode
     , m_AnimationStateInstance(0)
     , m_SkinId(0)
     , m_Id(0)
+    , m_GeometrySize()
     , m_CallbackInvocationDepth(0)
     , m_FindBones(0)
     , m_FirstUpdate(1)
@@ -447,6 +450,7 @@ static bool PlayAnimation(InternalGuiNode* node, dmhash_t animation_id, dmGui::P
 
     // Set up the track
     targetTrack.m_AnimationId = animation_id;
+    AccountScope account_scope(&node->m_SpineScene->m_InstanceAccount);
     targetTrack.m_AnimationInstance = spAnimationState_setAnimation(node->m_AnimationStateInstance, trackIndex, animation, loop);
     targetTrack.m_Playback = playback;
     targetTrack.m_CallbackInfo = callback;
@@ -548,6 +552,7 @@ static void CancelTrackAnimation(InternalGuiNode* node, int32_t track_index)
     if (!track || !track->m_AnimationInstance)
         return;
 
+    AccountScope account_scope(&node->m_SpineScene->m_InstanceAccount);
     spAnimationState_clearTrack(node->m_AnimationStateInstance, track->m_AnimationInstance->trackIndex);
 
     ClearTrackCallback(node, track);
@@ -605,6 +610,7 @@ bool AddSkin(dmGui::HScene scene, dmGui::HNode hnode, dmhash_t skin_id_a, dmhash
         skin_b = node->m_SpineScene->m_Skeleton->skins[*index];
     }
 
+    AccountScope account_scope(&node->m_SpineScene->m_InstanceAccount);
     spSkin_addSkin(skin_a,skin_b);
     return true;
 }
@@ -635,6 +641,7 @@ bool CopySkin(dmGui::HScene scene, dmGui::HNode hnode, dmhash_t skin_id_a, dmhas
         skin_b = node->m_SpineScene->m_Skeleton->skins[*index];
     }
 
+    AccountScope account_scope(&node->m_SpineScene->m_InstanceAccount);
     spSkin_copySkin(skin_a,skin_b);
     return true;
 }
@@ -1032,6 +1039,8 @@ static bool SetupNode(dmhash_t path, SpineSceneResource* resource, InternalGuiNo
     node->m_SpinePath    = path;
     node->m_SpineScene   = resource;
 
+    // The instances are charged to the scene, as for the spine models
+    AccountScope account_scope(&resource->m_InstanceAccount);
     node->m_SkeletonInstance = spSkeleton_create(node->m_SpineScene->m_Skeleton);
     if (!node->m_SkeletonInstance)
     {
@@ -1120,6 +1129,8 @@ static void* GuiClone(const dmGameSystem::CompGuiNodeContext* ctx, const dmGameS
         dst->m_AnimationTracks.SetCapacity(num_tracks);
         dst->m_AnimationTracks.SetSize(num_tracks);
 
+        AccountScope account_scope(&dst->m_SpineScene->m_InstanceAccount);
+
         for (uint32_t i = 0; i < num_tracks; i++)
         {
             const GuiSpineAnimationTrack& srcTrack = src->m_AnimationTracks[i];
@@ -1211,7 +1222,7 @@ static void GuiGetVertices(const dmGameSystem::CustomNodeCtx* nodectx, uint32_t
     // We currently know it's xyz-uv-rgba
     dmArray<dmSpine::SpineVertex>* vbdata = (dmArray<dmSpine::SpineVertex>*)&vertices;
 
-    uint32_t num_vertices = dmSpine::GenerateVertexData(*vbdata, node->m_SkeletonInstance, type_context->m_SkeletonClipper, node->m_Transform, dmVMath::Vector4(1.0f), 0);
+    uint32_t num_vertices = dmSpine::GenerateVertexData(*vbdata, node->m_SkeletonInstance, type_context->m_SkeletonClipper, node->m_Transform, dmVMath::Vector4(1.0f), 0, &node->m_GeometrySize);
     (void)num_vertices;
 }
 
@@ -1285,6 +1296,7 @@ static void GuiUpdate(const dmGameSystem::CustomNodeCtx* nodectx, float dt)
 
     if (anyTrackPlaying)
     {
+        AccountScope account_scope(&node->m_SpineScene->m_InstanceAccount);
         spAnimationState_update(node->m_AnimationStateInstance, anim_dt);
         spAnimationState_apply(node->m_AnimationStateInstance, node->m_SkeletonInstance);
         spSkeleton_update(node->m_SkeletonInstance, anim_dt);
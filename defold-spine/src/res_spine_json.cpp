@@ -1,52 +1,75 @@
 #include "res_spine_json.h"
-#include <memory.h>
-#include <string.h>
 #include <stdio.h>
 
-#ifdef __MACH__
-    #include <malloc/_malloc.h>
-#else
-    #include <malloc.h>
-#endif
-
 #include <dmsdk/dlib/log.h>
+#include <dmsdk/dlib/profile.h>
+#include <dmsdk/dlib/time.h>
 #include <dmsdk/resource/resource.h>
 
+#include <common/spine_loader.h>
+
 namespace dmSpine
 {
-    static SpineJsonResource* CreateResource(const void* buffer, uint32_t buffer_size)
+    // The buffer isn't null terminated, but we can parse it in place since the parser is length aware
+    static SpineJsonResource* CreateResource(const char* path, const void* buffer, uint32_t buffer_size)
     {
-        SpineJsonResource* resource = new SpineJsonResource;
-        resource->m_Json = (char*)malloc(buffer_size + 1);
-        if (!resource->m_Json)
+        DM_PROFILE("SpineJsonParse");
+        uint64_t start = dmTime::GetTime();
+
+        // The document is freed in one go, with its arena
+        HSpineArena arena = dmSpine::NewArena();
+        struct Json* document;
         {
-            delete resource;
+            dmSpine::ArenaScope arena_scope(arena);
+            document = dmSpine::ParseSkeletonJson(path, buffer, buffer_size);
+        }
+        if (!document)
+        {
+            dmSpine::DeleteArena(arena);
             return 0;
         }
 
-        memcpy((void*)resource->m_Json, buffer, buffer_size);
-        resource->m_Json[buffer_size] = 0;
+        SpineJsonResource* resource = new SpineJsonResource;
+        resource->m_Document = document;
+        resource->m_Arena = arena;
         resource->m_Length = buffer_size;
 
+        dmLogDebug("Parsed '%s' in %.2f ms. %u bytes in %u allocations", path, (dmTime::GetTime() - start) / 1000.0,
+                    dmSpine::GetArenaSize(arena), dmSpine::GetArenaAllocationCount(arena));
         return resource;
     }
 
     static void DestroyResource(SpineJsonResource* resource)
     {
-        free((void*)resource->m_Json);
+        dmSpine::DisposeSkeletonJson(resource->m_Document);
+        dmSpine::DeleteArena(resource->m_Arena);
         delete resource;
     }
 
-    static dmResource::Result ResourceTypeJson_Create(const dmResource::ResourceCreateParams* params)
+    // While loading, the peak memory is the file buffer and the parsed document
+    static uint32_t GetResourceSize(SpineJsonResource* resource)
     {
-        SpineJsonResource* resource = CreateResource(params->m_Buffer, params->m_BufferSize);
+        return dmSpine::GetArenaSize(resource->m_Arena) + resource->m_Length;
+    }
+
+    // Parses the document on the load thread
+    static dmResource::Result ResourceTypeJson_Preload(const dmResource::ResourcePreloadParams* params)
+    {
+        SpineJsonResource* resource = CreateResource(params->m_Filename, params->m_Buffer, params->m_BufferSize);
         if (!resource)
         {
-            return dmResource::RESULT_OUT_OF_RESOURCES;
+            return dmResource::RESULT_INVALID_DATA;
         }
 
+        *params->m_PreloadData = resource;
+        return dmResource::RESULT_OK;
+    }
+
+    static dmResource::Result ResourceTypeJson_Create(const dmResource::ResourceCreateParams* params)
+    {
+        SpineJsonResource* resource = (SpineJsonResource*)params->m_PreloadData;
         dmResource::SetResource(params->m_Resource, resource);
-        dmResource::SetResourceSize(params->m_Resource, resource->m_Length);
+        dmResource::SetResourceSize(params->m_Resource, GetResourceSize(resource));
         return dmResource::RESULT_OK;
     }
 
@@ -59,24 +82,22 @@ namespace dmSpine
 
     static dmResource::Result ResourceTypeJson_Recreate(const dmResource::ResourceRecreateParams* params)
     {
-        SpineJsonResource* new_resource = CreateResource(params->m_Buffer, params->m_BufferSize);
+        SpineJsonResource* new_resource = CreateResource(params->m_Filename, params->m_Buffer, params->m_BufferSize);
         if (!new_resource)
         {
-            return dmResource::RESULT_OUT_OF_RESOURCES;
+            return dmResource::RESULT_INVALID_DATA;
         }
 
         SpineJsonResource* old_resource = (SpineJsonResource*) dmResource::GetResource(params->m_Resource);
 
         // swap the internals
         // we wish to keep the "old" resource, since that pointer might be shared in the system
-        char* tmp = old_resource->m_Json;
-        old_resource->m_Json = new_resource->m_Json;
-        old_resource->m_Length = new_resource->m_Length;
-
-        new_resource->m_Json = tmp;
+        SpineJsonResource tmp = *old_resource;
+        *old_resource = *new_resource;
+        *new_resource = tmp;
         DestroyResource(new_resource);
 
-        dmResource::SetResourceSize(params->m_Resource, old_resource->m_Length);
+        dmResource::SetResourceSize(params->m_Resource, GetResourceSize(old_resource));
         return dmResource::RESULT_OK;
     }
 
@@ -85,7 +106,7 @@ namespace dmSpine
         return (ResourceResult)dmResource::SetupType(ctx,
                                                        type,
                                                        0, // context
-                                                       0, // preload
+                                                       ResourceTypeJson_Preload,
                                                        ResourceTypeJson_Create,
                                                        0, // post create
                                                        ResourceTypeJson_Destroy,
@@ -3,12 +3,18 @@
 
 #include <stdint.h>
 
+#include "spine_allocator.h"
+
+struct Json;
+
 namespace dmSpine
 {
+    // The json is parsed straight out of the loaded file buffer, so no copy of the text is kept
     struct SpineJsonResource
     {
-        char*       m_Json;
-        uint32_t    m_Length;
+        struct Json*    m_Document;
+        HSpineArena     m_Arena;        // The parsed document is allocated here
+        uint32_t        m_Length;       // The size of the file
     };
 }
 
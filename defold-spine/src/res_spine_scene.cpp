@@ -1,17 +1,32 @@
 #include "res_spine_scene.h"
 #include "res_spine_json.h"
+#include "res_spine_skel.h"
+#include "spine_pose_cache.h"
+#include "spine_skinning.h"
 #include "spine_ddf.h" // generated from the spine_ddf.proto
 
+#include <common/spine_baked.h>
 #include <common/spine_loader.h>
 
+#include <dmsdk/dlib/array.h>
+#include <dmsdk/dlib/condition_variable.h>
 #include <dmsdk/dlib/log.h>
 #include <dmsdk/dlib/math.h>
+#include <dmsdk/dlib/mutex.h>
+#include <dmsdk/dlib/profile.h>
+#include <dmsdk/dlib/thread.h>
+#include <dmsdk/dlib/time.h>
 #include <dmsdk/resource/resource.h>
 
+#include <spine/Animation.h>
+#include <spine/Skeleton.h>
 #include <spine/SkeletonJson.h>
 #include <spine/AnimationStateData.h>
 #include <dmsdk/gamesys/resources/res_textureset.h>
 
+#include <stdlib.h> // malloc
+#include <string.h> // memcpy
+
 // Also see the guide http://esotericsoftware.com/spine-c#Loading-skeleton-data
 
 #if 0
@@ -22,40 +37,139 @@
 
 namespace dmSpine
 {
+    static SpineModelBounds ReadBounds(const float* values)
+    {
+        SpineModelBounds bounds;
+        bounds.minX = values[0];
+        bounds.minY = values[1];
+        bounds.maxX = values[2];
+        bounds.maxY = values[3];
+        return bounds;
+    }
 
-    static dmResource::Result AcquireResources(dmResource::HFactory factory, SpineSceneResource* resource, const char* filename)
+    // The bounds are calculated by the build pipeline (see SPINE_GetAnimationBounds in plugin.cpp)
+    static void LoadAnimationBounds(SpineSceneResource* resource, const char* filename)
     {
-        dmResource::Result result = dmResource::Get(factory, resource->m_Ddf->m_Atlas, (void**) &resource->m_TextureSet); // .atlas -> .texturesetc
-        if (result != dmResource::RESULT_OK)
+        uint32_t count = resource->m_Skeleton->animationsCount;
+        uint32_t value_count = resource->m_Ddf->m_AnimationBounds.m_Count;
+        if (value_count == 0)
+            return;
+        if (value_count != (count + 1) * 4)
         {
-            return result;
+            dmLogWarning("Ignoring the animation bounds in '%s', rebuild the spine scene", filename);
+            return;
         }
 
-        SpineJsonResource* spine_json_resource = 0;
-        result = dmResource::Get(factory, resource->m_Ddf->m_SpineJson, (void**) &spine_json_resource);
-        if (result != dmResource::RESULT_OK)
+        const float* values = resource->m_Ddf->m_AnimationBounds.m_Data;
+        SpineAnimationBounds* animation_bounds = new SpineAnimationBounds;
+        animation_bounds->m_SetupPose = ReadBounds(values);
+        animation_bounds->m_AnimationToBounds.SetCapacity(dmMath::Max(1U, count/3), dmMath::Max(1U, count));
+        for (uint32_t i = 0; i < count; ++i)
         {
-            return result;
+            animation_bounds->m_AnimationToBounds.Put((uintptr_t)resource->m_Skeleton->animations[i], ReadBounds(values + (i + 1) * 4));
         }
+        resource->m_AnimationBounds = animation_bounds;
+    }
+
+    static uint32_t GetAnimationBoundsSize(const SpineSceneResource* resource)
+    {
+        const SpineAnimationBounds* animation_bounds = resource->m_AnimationBounds;
+        if (!animation_bounds)
+            return 0;
+        // The hash table entries (key, value and next index), and its buckets
+        uint32_t table_size = dmMath::Max(1U, (uint32_t)resource->m_Skeleton->animationsCount/3);
+        return sizeof(SpineAnimationBounds)
+             + animation_bounds->m_AnimationToBounds.Capacity() * (sizeof(uint64_t) + sizeof(SpineModelBounds) + sizeof(uint32_t))
+             + table_size * sizeof(uint32_t);
+    }
+
+    uint32_t GetSpineSceneDataSize(const SpineSceneResource* resource)
+    {
+        return dmSpine::GetArenaSize(resource->m_Arena) + GetAnimationBoundsSize(resource);
+    }
+
+    static void ResetAnimationBounds(SpineSceneResource* scene)
+    {
+        delete scene->m_AnimationBounds;
+        scene->m_AnimationBounds = 0;
+    }
 
-        // Create a 1:1 mapping between animation frames and regions in a format that is spine friendly
-        resource->m_Regions = dmSpine::CreateRegions(resource->m_TextureSet->m_TextureSet);
-        resource->m_AttachmentLoader = dmSpine::CreateAttachmentLoader(resource->m_TextureSet->m_TextureSet, resource->m_Regions);
 
-        // Create the spine resource
-        resource->m_Skeleton = dmSpine::ReadSkeletonJsonData((spAttachmentLoader*)resource->m_AttachmentLoader, filename, spine_json_resource->m_Json);
-        if (!resource->m_Skeleton)
+    static void LoadBakedAnimations(SpineSceneResource* resource, const char* filename)
+    {
+        uint32_t data_size = resource->m_Ddf->m_BakedAnimationData.m_Count;
+        if (data_size == 0)
+            return;
+
+        // The message data isn't necessarily aligned, so we keep our own copy
+        void* data = malloc(data_size);
+        memcpy(data, resource->m_Ddf->m_BakedAnimationData.m_Data, data_size);
+
+        resource->m_BakedAnimations = dmSpine::GetBakedAnimations(data, data_size, resource->m_Skeleton);
+        if (!resource->m_BakedAnimations)
         {
-            return dmResource::RESULT_INVALID_DATA;
+            dmLogWarning("Ignoring the baked animations in '%s', rebuild the spine scene", filename);
+            free(data);
+            return;
         }
 
+        uint32_t count = resource->m_BakedAnimations->m_AnimationCount;
+        resource->m_BakedAnimationNameToData.SetCapacity(dmMath::Max(1U, count/3), count);
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            const BakedAnimation* animation = dmSpine::GetBakedAnimation(resource->m_BakedAnimations, i);
+            resource->m_BakedAnimationNameToData.Put(animation->m_NameHash, animation);
+            DEBUGLOG("baked: %s %u frames", dmHashReverseSafe64(animation->m_NameHash), animation->m_FrameCount);
+        }
+    }
+
+    // The loading of a scene is split in phases, so that the main thread doesn't stall on big skeletons:
+    //   Preload (load thread):     the scene ddf, and the .spinejson document (see res_spine_json.cpp)
+    //   Create (main thread):      gets the atlas and the skeleton data resources, and queues the scene on the load thread
+    //   Load thread:               the regions, attachments, skeleton data, animation state data, the name tables,
+    //                              and the tables of the baked animations and the animation bounds
+    //   PostCreate (main thread):  pending until the load thread is done, then releases the skeleton data resource
+    struct SpineSceneLoadTask
+    {
+        SpineSceneResource*                 m_Resource;
+        void*                               m_SkeletonDataResource; // The .spinejsonc or .spineskelc
+        char*                               m_Filename;
+        dmResource::Result                  m_Result;
+        // The time spent in each phase (microseconds)
+        uint64_t                            m_CreateTime;
+        uint64_t                            m_QueueTime;
+        uint64_t                            m_SkeletonTime;
+        uint64_t                            m_TablesTime;
+        uint64_t                            m_StartTime;
+        uint8_t                             m_Threaded;
+        uint8_t                             m_Done;                 // Protected by the mutex of the loader. Not a bit field, since m_Threaded is read without the lock
+    };
+
+    // A single thread reads the skeletons of all scenes, in the order they were created
+    struct SpineSceneLoader
+    {
+        dmThread::Thread                        m_Thread;
+        dmMutex::HMutex                         m_Mutex;
+        dmConditionVariable::HConditionVariable m_WorkCondition;
+        dmConditionVariable::HConditionVariable m_DoneCondition;
+
+        // All members below are protected by m_Mutex
+        dmArray<SpineSceneLoadTask*>            m_Queue;
+        uint32_t                                m_Next;     // The next task in m_Queue to load
+        uint8_t                                 m_Quit : 1;
+    };
+
+    static const uint32_t LOAD_THREAD_STACK_SIZE = 0x40000;
+
+    // Created with the first scene, and deleted in FinalizeSceneLoader()
+    static SpineSceneLoader* g_SceneLoader = 0;
+
+    static void CreateNameTables(SpineSceneResource* resource)
+    {
         resource->m_AnimationStateData = spAnimationStateData_create(resource->m_Skeleton);
         //spAnimationStateData_setDefaultMix(resource->m_AnimationStateData, 0.1f); // There's currently no such function!
         resource->m_AnimationStateData->defaultMix = 0.1f; // force mixing
 
-        // We can release this json data now
-        dmResource::Release(factory, spine_json_resource);
-
         {
             uint32_t count = resource->m_Skeleton->animationsCount;
             resource->m_AnimationNameToIndex.SetCapacity(dmMath::Max(1U, count/3), count);
@@ -114,17 +228,274 @@ namespace dmSpine
                 DEBUGLOG("ik: %d %s", n, resource->m_Skeleton->ikConstraints[n]->name);
             }
         }
+    }
+
+    // Everything that doesn't need the main thread. It mustn't touch the resource system.
+    static dmResource::Result ReadSkeleton(SpineSceneLoadTask* task)
+    {
+        DM_PROFILE("SpineSceneReadSkeleton");
+        SpineSceneResource* resource = task->m_Resource;
+        uint64_t start = dmTime::GetTime();
+
+        // The skeleton data is immutable, and is freed in one go in ReleaseResources()
+        resource->m_Arena = dmSpine::NewArena();
+        uint64_t skeleton_end;
+        {
+            dmSpine::ArenaScope arena_scope(resource->m_Arena);
+
+            // Create a 1:1 mapping between animation frames and regions in a format that is spine friendly
+            resource->m_Regions = dmSpine::CreateRegions(resource->m_TextureSet->m_TextureSet);
+            resource->m_AttachmentLoader = dmSpine::CreateAttachmentLoader(resource->m_TextureSet->m_TextureSet, resource->m_Regions);
+
+            // Create the spine resource
+            spAttachmentLoader* attachment_loader = (spAttachmentLoader*)resource->m_AttachmentLoader;
+            if (dmSpine::IsSkeletonBinaryPath(resource->m_Ddf->m_SpineJson))
+            {
+                SpineSkelResource* spine_skel_resource = (SpineSkelResource*)task->m_SkeletonDataResource;
+                resource->m_Skeleton = dmSpine::ReadSkeletonBinaryData(attachment_loader, task->m_Filename, spine_skel_resource->m_Data, spine_skel_resource->m_Length);
+            }
+            else
+            {
+                SpineJsonResource* spine_json_resource = (SpineJsonResource*)task->m_SkeletonDataResource;
+                resource->m_Skeleton = dmSpine::ReadSkeletonJsonData(attachment_loader, task->m_Filename, spine_json_resource->m_Document);
+            }
+
+            skeleton_end = dmTime::GetTime();
+            task->m_SkeletonTime = skeleton_end - start;
+
+            if (!resource->m_Skeleton)
+            {
+                return dmResource::RESULT_INVALID_DATA;
+            }
+
+            CreateNameTables(resource);
+            LoadBakedAnimations(resource, task->m_Filename);
+            LoadAnimationBounds(resource, task->m_Filename);
+        }
+
+        task->m_TablesTime = dmTime::GetTime() - skeleton_end;
+        return dmResource::RESULT_OK;
+    }
+
+    static void RunLoadTask(SpineSceneLoadTask* task)
+    {
+        task->m_QueueTime = dmTime::GetTime() - task->m_StartTime - task->m_CreateTime;
+        task->m_Result = ReadSkeleton(task);
+    }
+
+    static void SceneLoaderThread(void* arg)
+    {
+        SpineSceneLoader* loader = (SpineSceneLoader*)arg;
+
+        dmMutex::Lock(loader->m_Mutex);
+        while (true)
+        {
+            while (!loader->m_Quit && loader->m_Next == loader->m_Queue.Size())
+            {
+                dmConditionVariable::Wait(loader->m_WorkCondition, loader->m_Mutex);
+            }
+            if (loader->m_Quit)
+                break;
+
+            SpineSceneLoadTask* task = loader->m_Queue[loader->m_Next++];
+            if (loader->m_Next == loader->m_Queue.Size())
+            {
+                loader->m_Queue.SetSize(0);
+                loader->m_Next = 0;
+            }
+
+            dmMutex::Unlock(loader->m_Mutex);
+            RunLoadTask(task);
+            dmMutex::Lock(loader->m_Mutex);
+
+            task->m_Done = 1;
+            dmConditionVariable::Broadcast(loader->m_DoneCondition);
+        }
+        dmMutex::Unlock(loader->m_Mutex);
+
+        FlushThreadAllocatorCache();
+    }
+
+    static SpineSceneLoader* GetSceneLoader()
+    {
+        if (!g_SceneLoader)
+        {
+            SpineSceneLoader* loader = new SpineSceneLoader;
+            loader->m_Mutex = dmMutex::New();
+            loader->m_WorkCondition = dmConditionVariable::New();
+            loader->m_DoneCondition = dmConditionVariable::New();
+            loader->m_Next = 0;
+            loader->m_Quit = 0;
+            loader->m_Thread = dmThread::New(SceneLoaderThread, LOAD_THREAD_STACK_SIZE, loader, "spine_load");
+            g_SceneLoader = loader;
+        }
+        return g_SceneLoader;
+    }
+
+    void FinalizeSceneLoader()
+    {
+        SpineSceneLoader* loader = g_SceneLoader;
+        if (!loader)
+            return;
+
+        dmMutex::Lock(loader->m_Mutex);
+        loader->m_Quit = 1;
+        dmConditionVariable::Broadcast(loader->m_WorkCondition);
+        dmMutex::Unlock(loader->m_Mutex);
+        dmThread::Join(loader->m_Thread);
+
+        dmConditionVariable::Delete(loader->m_DoneCondition);
+        dmConditionVariable::Delete(loader->m_WorkCondition);
+        dmMutex::Delete(loader->m_Mutex);
+        delete loader;
+        g_SceneLoader = 0;
+    }
+
+    static void StartLoad(SpineSceneResource* resource, void* skeleton_data_resource, const char* filename, uint64_t start_time, bool threaded)
+    {
+        SpineSceneLoadTask* task = new SpineSceneLoadTask;
+        memset(task, 0, sizeof(SpineSceneLoadTask));
+        task->m_Resource = resource;
+        task->m_SkeletonDataResource = skeleton_data_resource;
+        task->m_Filename = strdup(filename);
+        task->m_StartTime = start_time;
+        resource->m_LoadTask = task;
+
+#if defined(__EMSCRIPTEN__)
+        // No threads on the web
+        threaded = false;
+#endif
+        task->m_Threaded = threaded;
+        task->m_CreateTime = dmTime::GetTime() - start_time;
+        if (!threaded)
+        {
+            RunLoadTask(task);
+            task->m_Done = 1;
+            return;
+        }
+
+        SpineSceneLoader* loader = GetSceneLoader();
+        dmMutex::Lock(loader->m_Mutex);
+        if (loader->m_Queue.Full())
+        {
+            loader->m_Queue.OffsetCapacity(dmMath::Max(16U, loader->m_Queue.Capacity()));
+        }
+        loader->m_Queue.Push(task);
+        dmConditionVariable::Signal(loader->m_WorkCondition);
+        dmMutex::Unlock(loader->m_Mutex);
+    }
+
+    static bool IsLoadDone(SpineSceneLoadTask* task)
+    {
+        if (!task->m_Threaded)
+            return true;
+        SpineSceneLoader* loader = g_SceneLoader;
+        dmMutex::Lock(loader->m_Mutex);
+        bool done = task->m_Done;
+        dmMutex::Unlock(loader->m_Mutex);
+        return done;
+    }
+
+    // Waits until the task is done. If the load thread hasn't started on it yet, it's taken off the queue and run here
+    static void WaitForLoadTask(SpineSceneLoadTask* task)
+    {
+        DM_PROFILE("SpineSceneWaitForLoad");
+        SpineSceneLoader* loader = g_SceneLoader;
+        dmMutex::Lock(loader->m_Mutex);
+        for (uint32_t i = loader->m_Next; i < loader->m_Queue.Size(); ++i)
+        {
+            if (loader->m_Queue[i] != task)
+                continue;
+            SpineSceneLoadTask** queue = loader->m_Queue.Begin();
+            memmove(queue + i, queue + i + 1, sizeof(SpineSceneLoadTask*) * (loader->m_Queue.Size() - i - 1));
+            loader->m_Queue.Pop();
+
+            dmMutex::Unlock(loader->m_Mutex);
+            RunLoadTask(task);
+            dmMutex::Lock(loader->m_Mutex);
+            task->m_Done = 1;
+            break;
+        }
+        while (!task->m_Done)
+        {
+            dmConditionVariable::Wait(loader->m_DoneCondition, loader->m_Mutex);
+        }
+        dmMutex::Unlock(loader->m_Mutex);
+    }
+
+    // Blocks until the skeleton has been read
+    static dmResource::Result FinishLoad(dmResource::HFactory factory, SpineSceneResource* resource)
+    {
+        SpineSceneLoadTask* task = resource->m_LoadTask;
+        if (!task)
+            return dmResource::RESULT_OK;
+
+        uint64_t wait_start = dmTime::GetTime();
+        if (task->m_Threaded)
+        {
+            WaitForLoadTask(task);
+        }
+        uint64_t end = dmTime::GetTime();
 
+        // We can release the json (or binary) data now
+        dmResource::Release(factory, task->m_SkeletonDataResource);
+
+        dmResource::Result result = task->m_Result;
+        if (result == dmResource::RESULT_OK)
+        {
+            dmLogDebug("Loaded '%s' in %.2f ms: create %.2f ms, queued %.2f ms, skeleton %.2f ms, tables %.2f ms (%s), waited %.2f ms. %u bytes in %u allocations", task->m_Filename,
+                        (end - task->m_StartTime) / 1000.0, task->m_CreateTime / 1000.0, task->m_QueueTime / 1000.0,
+                        task->m_SkeletonTime / 1000.0, task->m_TablesTime / 1000.0, task->m_Threaded ? "load thread" : "main thread",
+                        (end - wait_start) / 1000.0, GetSpineSceneDataSize(resource), dmSpine::GetArenaAllocationCount(resource->m_Arena));
+        }
+
+        free(task->m_Filename);
+        delete task;
+        resource->m_LoadTask = 0;
+        return result;
+    }
+
+    // Gets the atlas and the skeleton data. The rest is done in StartLoad()
+    static dmResource::Result AcquireResources(dmResource::HFactory factory, SpineSceneResource* resource, const char* filename, bool threaded)
+    {
+        DM_PROFILE("SpineSceneAcquireResources");
+        uint64_t start = dmTime::GetTime();
+
+        dmResource::Result result = dmResource::Get(factory, resource->m_Ddf->m_Atlas, (void**) &resource->m_TextureSet); // .atlas -> .texturesetc
+        if (result != dmResource::RESULT_OK)
+        {
+            return result;
+        }
+
+        // The skeleton data is either a .spinejsonc or a binary .spineskelc
+        void* skeleton_data_resource = 0;
+        result = dmResource::Get(factory, resource->m_Ddf->m_SpineJson, &skeleton_data_resource);
+        if (result != dmResource::RESULT_OK)
+        {
+            return result;
+        }
+
+        StartLoad(resource, skeleton_data_resource, filename, start, threaded);
         return dmResource::RESULT_OK;
     }
 
     static void ReleaseResources(dmResource::HFactory factory, SpineSceneResource* resource)
     {
+        // In case the scene is destroyed before its post create
+        FinishLoad(factory, resource);
+
+        // The cached poses reference the skeleton data
+        ResetPoseCache(resource);
+        ResetSkinnedGeometry(resource);
+        ResetAnimationBounds(resource);
+
         if (resource->m_Ddf)
             dmDDF::FreeMessage(resource->m_Ddf);
         if (resource->m_TextureSet)
             dmResource::Release(factory, resource->m_TextureSet);
 
+        // Most of this memory is in the arena, but the objects are still disposed,
+        // since they may have been extended at runtime (e.g. skins and mixes)
         if (resource->m_AnimationStateData)
             spAnimationStateData_dispose(resource->m_AnimationStateData);
         if (resource->m_Skeleton)
@@ -132,10 +503,21 @@ namespace dmSpine
         if (resource->m_AttachmentLoader)
             dmSpine::Dispose(resource->m_AttachmentLoader);
         delete[] resource->m_Regions;
+
+        dmSpine::DeleteArena(resource->m_Arena);
+        resource->m_Arena = 0;
+
+        if (resource->m_BakedAnimations)
+        {
+            free((void*)resource->m_BakedAnimations);
+            resource->m_BakedAnimations = 0;
+            resource->m_BakedAnimationNameToData.Clear();
+        }
     }
 
     static dmResource::Result ResourceTypeScene_Preload(const dmResource::ResourcePreloadParams* params)
     {
+        DM_PROFILE("SpineScenePreload");
         dmGameSystemDDF::SpineSceneDesc* ddf;
         dmDDF::Result e = dmDDF::LoadMessage(params->m_Buffer, params->m_BufferSize, &dmGameSystemDDF_SpineSceneDesc_DESCRIPTOR, (void**) &ddf);
         if (e != dmDDF::RESULT_OK)
@@ -154,7 +536,7 @@ namespace dmSpine
     {
         SpineSceneResource* scene_resource = new SpineSceneResource();
         scene_resource->m_Ddf = (dmGameSystemDDF::SpineSceneDesc*) params->m_PreloadData;
-        dmResource::Result r = AcquireResources(params->m_Factory, scene_resource, params->m_Filename);
+        dmResource::Result r = AcquireResources(params->m_Factory, scene_resource, params->m_Filename, true);
         if (r == dmResource::RESULT_OK)
         {
             dmResource::SetResource(params->m_Resource, scene_resource);
@@ -167,6 +549,18 @@ namespace dmSpine
         return r;
     }
 
+    static dmResource::Result ResourceTypeScene_PostCreate(const dmResource::ResourcePostCreateParams* params)
+    {
+        SpineSceneResource* scene_resource = (SpineSceneResource*)dmResource::GetResource(params->m_Resource);
+        if (scene_resource->m_LoadTask && !IsLoadDone(scene_resource->m_LoadTask))
+        {
+            return dmResource::RESULT_PENDING;
+        }
+        dmResource::Result r = FinishLoad(params->m_Factory, scene_resource);
+        dmResource::SetResourceSize(params->m_Resource, GetSpineSceneDataSize(scene_resource));
+        return r;
+    }
+
     static dmResource::Result ResourceTypeScene_Destroy(const dmResource::ResourceDestroyParams* params)
     {
         SpineSceneResource* scene_resource = (SpineSceneResource*)dmResource::GetResource(params->m_Resource);
@@ -186,7 +580,15 @@ namespace dmSpine
         SpineSceneResource* resource = (SpineSceneResource*)dmResource::GetResource(params->m_Resource);
         ReleaseResources(params->m_Factory, resource);
         resource->m_Ddf = ddf;
-        return AcquireResources(params->m_Factory, resource, params->m_Filename);
+        // There's no post create after a recreate, so it's loaded on this thread
+        dmResource::Result r = AcquireResources(params->m_Factory, resource, params->m_Filename, false);
+        if (r != dmResource::RESULT_OK)
+        {
+            return r;
+        }
+        r = FinishLoad(params->m_Factory, resource);
+        dmResource::SetResourceSize(params->m_Resource, GetSpineSceneDataSize(resource));
+        return r;
     }
 
     static ResourceResult ResourceTypeScene_Register(HResourceTypeContext ctx, HResourceType type)
@@ -196,7 +598,7 @@ namespace dmSpine
                                                    0, // context
                                                    ResourceTypeScene_Preload,
                                                    ResourceTypeScene_Create,
-                                                   0, // post create
+                                                   ResourceTypeScene_PostCreate,
                                                    ResourceTypeScene_Destroy,
                                                    ResourceTypeScene_Recreate);
 
@@ -3,6 +3,10 @@
 
 #include <dmsdk/dlib/hashtable.h>
 
+#include <common/vertices.h>
+
+#include "spine_allocator.h"
+
 struct spAtlasRegion;
 struct spSkeletonData;
 struct spAnimationStateData;
@@ -20,13 +24,25 @@ namespace dmGameSystem
 namespace dmSpine
 {
     struct spDefoldAtlasAttachmentLoader;
+    struct SpinePoseCache;
+    struct SpineSkinnedGeometry;
+    struct BakedAnimationsHeader;
+    struct BakedAnimation;
+    struct SpineSceneLoadTask;
+
+    // The bounds of each animation of the skeleton, for the models that are culled using them (see culling_bounds in the .spinemodel)
+    struct SpineAnimationBounds
+    {
+        dmHashTable64<SpineModelBounds>     m_AnimationToBounds;    // Keyed on the spAnimation
+        SpineModelBounds                    m_SetupPose;
+    };
 
     struct SpineSceneResource
     {
         dmGameSystemDDF::SpineSceneDesc*    m_Ddf;
         dmGameSystem::TextureSetResource*   m_TextureSet;   // The atlas
         spAtlasRegion*                      m_Regions;      // Maps 1:1 with the atlas animations array
-        spSkeletonData*                     m_Skeleton;     // the .spinejson file
+        spSkeletonData*                     m_Skeleton;     // the .spinejson (or .spineskel) file
         spAnimationStateData*               m_AnimationStateData;
         spDefoldAtlasAttachmentLoader*      m_AttachmentLoader;
         dmHashTable64<uint32_t>             m_AnimationNameToIndex;
@@ -34,7 +50,22 @@ namespace dmSpine
         dmHashTable64<uint32_t>             m_SlotNameToIndex;
         dmHashTable64<uint32_t>             m_IKNameToIndex;
         dmHashTable64<const char*>          m_AttachmentHashToName; // makes it easy for us to do a reverse hash for attachments
+        const BakedAnimationsHeader*        m_BakedAnimations; // Optional, see bake_animations in the .spinescene
+        dmHashTable64<const BakedAnimation*> m_BakedAnimationNameToData;
+        SpinePoseCache*                     m_PoseCache;    // Created on demand, shared by all model instances
+        uint32_t                            m_PoseCacheGeneration; // Incremented each time the cached poses are dropped
+        SpineSkinnedGeometry*               m_SkinnedGeometry; // Created on demand, for the models using GPU skinning
+        SpineAnimationBounds*               m_AnimationBounds; // Optional, for the models using the animation bounds (read from the .spinescenec)
+        HSpineArena                         m_Arena;        // The skeleton data, animation state data and attachment loader are allocated here
+        AllocationAccount                   m_InstanceAccount; // The spine allocations of the models and gui nodes using the scene (see AccountScope)
+        SpineSceneLoadTask*                 m_LoadTask;     // Set until the skeleton has been read on the load thread (see ResourceTypeScene_PostCreate)
     };
+
+    // The memory of the loaded data, i.e. the resource size
+    uint32_t GetSpineSceneDataSize(const SpineSceneResource* resource);
+
+    // Stops the thread that the scenes are loaded on. Called when the app is finalized, once all scenes are destroyed
+    void FinalizeSceneLoader();
 }
 
 #endif // DM_RES_SPINE_SCENE_H
@@ -0,0 +1,90 @@
+#include "res_spine_skel.h"
+#include <memory.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include <dmsdk/dlib/log.h>
+#include <dmsdk/resource/resource.h>
+
+namespace dmSpine
+{
+    static SpineSkelResource* CreateResource(const void* buffer, uint32_t buffer_size)
+    {
+        SpineSkelResource* resource = new SpineSkelResource;
+        resource->m_Data = (uint8_t*)malloc(buffer_size);
+        if (!resource->m_Data)
+        {
+            delete resource;
+            return 0;
+        }
+
+        memcpy((void*)resource->m_Data, buffer, buffer_size);
+        resource->m_Length = buffer_size;
+
+        return resource;
+    }
+
+    static void DestroyResource(SpineSkelResource* resource)
+    {
+        free((void*)resource->m_Data);
+        delete resource;
+    }
+
+    static dmResource::Result ResourceTypeSkel_Create(const dmResource::ResourceCreateParams* params)
+    {
+        SpineSkelResource* resource = CreateResource(params->m_Buffer, params->m_BufferSize);
+        if (!resource)
+        {
+            return dmResource::RESULT_OUT_OF_RESOURCES;
+        }
+
+        dmResource::SetResource(params->m_Resource, resource);
+        dmResource::SetResourceSize(params->m_Resource, resource->m_Length);
+        return dmResource::RESULT_OK;
+    }
+
+    static dmResource::Result ResourceTypeSkel_Destroy(const dmResource::ResourceDestroyParams* params)
+    {
+        SpineSkelResource* resource = (SpineSkelResource*)dmResource::GetResource(params->m_Resource);
+        DestroyResource(resource);
+        return dmResource::RESULT_OK;
+    }
+
+    static dmResource::Result ResourceTypeSkel_Recreate(const dmResource::ResourceRecreateParams* params)
+    {
+        SpineSkelResource* new_resource = CreateResource(params->m_Buffer, params->m_BufferSize);
+        if (!new_resource)
+        {
+            return dmResource::RESULT_OUT_OF_RESOURCES;
+        }
+
+        SpineSkelResource* old_resource = (SpineSkelResource*) dmResource::GetResource(params->m_Resource);
+
+        // swap the internals
+        // we wish to keep the "old" resource, since that pointer might be shared in the system
+        uint8_t* tmp = old_resource->m_Data;
+        old_resource->m_Data = new_resource->m_Data;
+        old_resource->m_Length = new_resource->m_Length;
+
+        new_resource->m_Data = tmp;
+        DestroyResource(new_resource);
+
+        dmResource::SetResourceSize(params->m_Resource, old_resource->m_Length);
+        return dmResource::RESULT_OK;
+    }
+
+    static ResourceResult ResourceTypeSkel_Register(HResourceTypeContext ctx, HResourceType type)
+    {
+        return (ResourceResult)dmResource::SetupType(ctx,
+                                                       type,
+                                                       0, // context
+                                                       0, // preload
+                                                       ResourceTypeSkel_Create,
+                                                       0, // post create
+                                                       ResourceTypeSkel_Destroy,
+                                                       ResourceTypeSkel_Recreate);
+
+    }
+}
+
+DM_DECLARE_RESOURCE_TYPE(ResourceTypeSpineSkelExt, "spineskelc", dmSpine::ResourceTypeSkel_Register, 0);
@@ -0,0 +1,16 @@
+#ifndef DM_RES_SPINE_SKEL_H
+#define DM_RES_SPINE_SKEL_H
+
+#include <stdint.h>
+
+namespace dmSpine
+{
+    // The binary skeleton data (.spineskel), which loads faster than the json format
+    struct SpineSkelResource
+    {
+        uint8_t*    m_Data;
+        uint32_t    m_Length;
+    };
+}
+
+#endif // DM_RES_SPINE_SKEL_H
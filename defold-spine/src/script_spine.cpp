@@ -489,6 +489,47 @@ namespace dmSpine
         return 1;
     }
 
+    /*# get the memory used by a spine scene
+     * Returns the memory used by the spine scene of a spine model.
+     * The instance memory is shared by all the spine models and gui nodes using the same spine scene.
+     *
+     * @name spine.get_memory_stats
+     * @param url [type:string|hash|url] the spine model to query
+     * @return stats [type:table] the memory of the spine scene
+     *
+     * - [type:number] `data_size` bytes used by the loaded skeleton data (the resource size of the spine scene)
+     * - [type:number] `instance_size` bytes used by the skeletons, animation states and skins of the models and gui nodes
+     * - [type:number] `instance_allocations` number of instance allocations
+     *
+     * @examples
+     *
+     * ```lua
+     * function init(self)
+     *   local stats = spine.get_memory_stats("#spinemodel")
+     *   print(stats.data_size, stats.instance_size)
+     * end
+     * ```
+     */
+    static int SpineComp_GetMemoryStats(lua_State* L)
+    {
+        DM_LUA_STACK_CHECK(L, 1);
+
+        SpineModelComponent* component = 0;
+        dmScript::GetComponentFromLua(L, 1, SPINE_MODEL_EXT, 0, (void**)&component, 0);
+
+        SpineSceneMemoryStats stats;
+        CompSpineModelGetMemoryStats(component, &stats);
+
+        lua_newtable(L);
+        lua_pushinteger(L, stats.m_DataSize);
+        lua_setfield(L, -2, "data_size");
+        lua_pushinteger(L, stats.m_InstanceSize);
+        lua_setfield(L, -2, "instance_size");
+        lua_pushinteger(L, stats.m_InstanceAllocationCount);
+        lua_setfield(L, -2, "instance_allocations");
+        return 1;
+    }
+
     /*# clears a spine skin
      * Clears the current attachments and constraints on a spine skin.
      *
@@ -1046,6 +1087,7 @@ namespace dmSpine
             {"play_anim",               SpineComp_PlayAnim},
             {"cancel",                  SpineComp_Cancel},
             {"get_go",                  SpineComp_GetGO},
+            {"get_memory_stats",        SpineComp_GetMemoryStats},
             {"set_skin",                SpineComp_SetSkin},
             {"set_attachment",          SpineComp_SetAttachment},
             {"set_ik_target_position",  SpineComp_SetIKTargetPosition},
@@ -185,6 +185,8 @@ namespace dmSpine
         // Release atlas resource - we only needed to validate it exists
         dmResource::Release(g_Factory, atlas_res);
         ddf.m_Atlas = (char*)atlas_path;
+        ddf.m_BakedAnimations = (char*)"";
+        ddf.m_BakeSampleRate = 30.0f;
 
         dmArray<uint8_t> ddf_buffer;
         dmDDF::Result ddf_res = dmDDF::SaveMessageToArray(&ddf, dmGameSystemDDF::SpineSceneDesc::m_DDFDescriptor, ddf_buffer);
@@ -0,0 +1,537 @@
+#include "spine_allocator.h"
+
+extern "C" {
+#include <spine/extension.h>
+}
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h> // memcpy
+
+#include <dmsdk/dlib/atomic.h>
+#include <dmsdk/dlib/math.h>
+#include <dmsdk/dlib/mutex.h>
+
+#if defined(_MSC_VER)
+    #define SPINE_THREAD_LOCAL __declspec(thread)
+#else
+    #define SPINE_THREAD_LOCAL __thread
+#endif
+
+namespace dmSpine
+{
+    static const uint32_t ALIGNMENT = 16;
+    static const uint32_t POOL_MAX_SIZE = 512;
+    static const uint32_t POOL_CLASS_COUNT = POOL_MAX_SIZE / ALIGNMENT;
+    static const uint32_t POOL_PAGE_SIZE = 16 * 1024;
+    static const uint32_t POOL_CACHE_MAX_COUNT = 32;    // Max free blocks per size class in the cache of a thread
+    static const uint32_t POOL_CACHE_BATCH_COUNT = 16;  // Blocks moved at a time between the cache of a thread and the shared lists
+    static const uint32_t ARENA_CHUNK_SIZE = 64 * 1024;
+
+    enum BlockKind
+    {
+        BLOCK_KIND_HEAP,
+        BLOCK_KIND_POOL,
+        BLOCK_KIND_ARENA,
+    };
+
+    struct SpineArena;
+
+    // Placed in front of each allocation. The size keeps the alignment of the allocations
+    struct BlockHeader
+    {
+        uint32_t    m_Size;         // The requested size
+        uint16_t    m_Kind;         // BlockKind
+        uint16_t    m_SizeClass;    // For the pool allocations
+        union
+        {
+            SpineArena*         m_Arena;    // For the arena allocations
+            AllocationAccount*  m_Account;  // For the other allocations, if charged to an account
+            uint64_t            m_Pad;
+        };
+    };
+
+    struct PoolBlock
+    {
+        PoolBlock*  m_Next;
+    };
+
+    struct PoolPage
+    {
+        PoolPage*   m_Next;
+        uint8_t     m_Pad[ALIGNMENT - sizeof(PoolPage*)];
+    };
+
+    struct ArenaChunk
+    {
+        ArenaChunk* m_Next;
+        uint8_t     m_Pad[ALIGNMENT - sizeof(ArenaChunk*)];
+    };
+
+    struct SpineArena
+    {
+        ArenaChunk* m_Chunks;
+        uint8_t*    m_Cursor;   // The free space of the current chunk
+        uint8_t*    m_End;
+        PoolBlock*  m_FreeLists[POOL_CLASS_COUNT]; // The small blocks freed while loading, e.g. temporaries and grown arrays
+        uint32_t    m_Size;
+        uint32_t    m_AllocationCount;
+    };
+
+    struct Allocator
+    {
+        dmMutex::HMutex m_Mutex;    // Protects the free lists and the pages
+        PoolBlock*      m_FreeLists[POOL_CLASS_COUNT];
+        PoolPage*       m_Pages;
+        int32_atomic_t  m_PoolSize;
+        int32_atomic_t  m_InstanceSize;
+        int32_atomic_t  m_InstanceAllocationCount;
+        int32_atomic_t  m_ArenaSize;
+        int32_atomic_t  m_ArenaAllocationCount;
+    };
+
+    // The free pool blocks of a thread, so that the threads only take the lock to move a batch of blocks
+    // from or to the shared free lists. Blocks freed on another thread than they were allocated on go to its cache.
+    // The spine threads return their cached blocks before they exit (see FlushThreadAllocatorCache)
+    struct PoolCache
+    {
+        PoolBlock*      m_FreeLists[POOL_CLASS_COUNT];
+        uint32_t        m_Counts[POOL_CLASS_COUNT];
+    };
+
+    static Allocator g_Allocator;
+    static SPINE_THREAD_LOCAL SpineArena* g_CurrentArena = 0;
+    static SPINE_THREAD_LOCAL AllocationAccount* g_CurrentAccount = 0;
+    static SPINE_THREAD_LOCAL PoolCache g_PoolCache;
+
+    static inline uint32_t AlignSize(size_t size)
+    {
+        return (uint32_t)((size + ALIGNMENT - 1) & ~(size_t)(ALIGNMENT - 1));
+    }
+
+    static inline BlockHeader* GetHeader(void* ptr)
+    {
+        return (BlockHeader*)ptr - 1;
+    }
+
+    static inline void* InitBlock(void* block, size_t size, BlockKind kind, uint32_t size_class)
+    {
+        BlockHeader* header = (BlockHeader*)block;
+        header->m_Size = (uint32_t)size;
+        header->m_Kind = (uint16_t)kind;
+        header->m_SizeClass = (uint16_t)size_class;
+        return header + 1;
+    }
+
+    // ********************************************************************************************************
+    // Arenas
+
+    static inline void* InitArenaBlock(void* block, size_t size, SpineArena* arena)
+    {
+        BlockHeader* header = (BlockHeader*)block;
+        header->m_Arena = arena;
+        return InitBlock(block, size, BLOCK_KIND_ARENA, 0);
+    }
+
+    static void* ArenaAlloc(SpineArena* arena, size_t size)
+    {
+        uint32_t block_size = sizeof(BlockHeader) + AlignSize(size);
+        if (size <= POOL_MAX_SIZE)
+        {
+            uint32_t size_class = (AlignSize(size) / ALIGNMENT) - 1;
+            PoolBlock* free_block = arena->m_FreeLists[size_class];
+            if (free_block)
+            {
+                arena->m_FreeLists[size_class] = free_block->m_Next;
+                arena->m_AllocationCount++;
+                return InitArenaBlock(free_block, size, arena);
+            }
+        }
+
+        if (arena->m_Cursor + block_size > arena->m_End)
+        {
+            // Large blocks get a chunk of their own, so that the current chunk can still be used
+            bool dedicated = block_size > ARENA_CHUNK_SIZE / 4;
+            uint32_t chunk_size = sizeof(ArenaChunk) + (dedicated ? block_size : ARENA_CHUNK_SIZE);
+            ArenaChunk* chunk = (ArenaChunk*)malloc(chunk_size);
+            if (!chunk)
+                return 0;
+            arena->m_Size += chunk_size;
+
+            uint8_t* begin = (uint8_t*)(chunk + 1);
+            if (dedicated && arena->m_Chunks)
+            {
+                chunk->m_Next = arena->m_Chunks->m_Next;
+                arena->m_Chunks->m_Next = chunk;
+                arena->m_AllocationCount++;
+                return InitArenaBlock(begin, size, arena);
+            }
+
+            chunk->m_Next = arena->m_Chunks;
+            arena->m_Chunks = chunk;
+            arena->m_Cursor = begin;
+            arena->m_End = (uint8_t*)chunk + chunk_size;
+        }
+
+        void* block = arena->m_Cursor;
+        arena->m_Cursor += block_size;
+        arena->m_AllocationCount++;
+        return InitArenaBlock(block, size, arena);
+    }
+
+    // Only called on the thread that is loading into the arena, so the blocks freed afterwards (e.g. when
+    // the skeleton data is disposed) are left alone. A block at the end of the current chunk is given back
+    // to the chunk, and the other small blocks are reused by the next allocations of the same size class.
+    static void ArenaFree(SpineArena* arena, BlockHeader* header)
+    {
+        uint32_t aligned_size = AlignSize(header->m_Size);
+        arena->m_AllocationCount--;
+        if ((uint8_t*)(header + 1) + aligned_size == arena->m_Cursor)
+        {
+            arena->m_Cursor = (uint8_t*)header;
+            return;
+        }
+        if (aligned_size > POOL_MAX_SIZE)
+            return;
+
+        uint32_t size_class = (aligned_size / ALIGNMENT) - 1;
+        PoolBlock* block = (PoolBlock*)header;
+        block->m_Next = arena->m_FreeLists[size_class];
+        arena->m_FreeLists[size_class] = block;
+    }
+
+    // The last arena allocation can grow in place, which is the common case when the spine runtime
+    // grows its arrays while loading. Any block can shrink within its aligned size.
+    static bool ArenaTryGrow(SpineArena* arena, void* ptr, size_t size)
+    {
+        BlockHeader* header = GetHeader(ptr);
+        if (AlignSize(size) == AlignSize(header->m_Size))
+        {
+            header->m_Size = (uint32_t)size;
+            return true;
+        }
+        uint8_t* block_end = (uint8_t*)ptr + AlignSize(header->m_Size);
+        if (block_end != arena->m_Cursor)
+            return false;
+        uint8_t* new_end = (uint8_t*)ptr + AlignSize(size);
+        if (new_end > arena->m_End)
+            return false;
+        arena->m_Cursor = new_end;
+        header->m_Size = (uint32_t)size;
+        return true;
+    }
+
+    HSpineArena NewArena()
+    {
+        SpineArena* arena = new SpineArena;
+        memset(arena, 0, sizeof(SpineArena));
+        return arena;
+    }
+
+    void DeleteArena(HSpineArena arena)
+    {
+        if (!arena)
+            return;
+        assert(g_CurrentArena != arena);
+
+        if (g_Allocator.m_Mutex)
+        {
+            dmAtomicSub32(&g_Allocator.m_ArenaSize, (int32_t)arena->m_Size);
+            dmAtomicSub32(&g_Allocator.m_ArenaAllocationCount, (int32_t)arena->m_AllocationCount);
+        }
+
+        ArenaChunk* chunk = arena->m_Chunks;
+        while (chunk)
+        {
+            ArenaChunk* next = chunk->m_Next;
+            free(chunk);
+            chunk = next;
+        }
+        delete arena;
+    }
+
+    uint32_t GetArenaSize(HSpineArena arena)
+    {
+        return arena ? arena->m_Size : 0;
+    }
+
+    uint32_t GetArenaAllocationCount(HSpineArena arena)
+    {
+        return arena ? arena->m_AllocationCount : 0;
+    }
+
+    ArenaScope::ArenaScope(HSpineArena arena)
+    : m_Arena(arena)
+    , m_Previous(g_CurrentArena)
+    , m_Size(GetArenaSize(arena))
+    , m_AllocationCount(GetArenaAllocationCount(arena))
+    {
+        g_CurrentArena = arena;
+    }
+
+    ArenaScope::~ArenaScope()
+    {
+        g_CurrentArena = m_Previous;
+        if (m_Arena && g_Allocator.m_Mutex)
+        {
+            dmAtomicAdd32(&g_Allocator.m_ArenaSize, (int32_t)(m_Arena->m_Size - m_Size));
+            dmAtomicAdd32(&g_Allocator.m_ArenaAllocationCount, (int32_t)(m_Arena->m_AllocationCount - m_AllocationCount));
+        }
+    }
+
+    AccountScope::AccountScope(AllocationAccount* account)
+    : m_Previous(g_CurrentAccount)
+    {
+        g_CurrentAccount = account;
+    }
+
+    AccountScope::~AccountScope()
+    {
+        g_CurrentAccount = m_Previous;
+    }
+
+    // ********************************************************************************************************
+    // Pools and heap
+
+    static inline void AddInstanceSize(BlockHeader* header, int32_t size, int32_t count)
+    {
+        dmAtomicAdd32(&g_Allocator.m_InstanceSize, size);
+        dmAtomicAdd32(&g_Allocator.m_InstanceAllocationCount, count);
+        AllocationAccount* account = header->m_Account;
+        if (account)
+        {
+            dmAtomicAdd32(&account->m_Size, size);
+            dmAtomicAdd32(&account->m_AllocationCount, count);
+        }
+    }
+
+    static inline void* InitInstanceBlock(void* block, size_t size, BlockKind kind, uint32_t size_class, int32_t charged_size)
+    {
+        BlockHeader* header = (BlockHeader*)block;
+        header->m_Account = g_CurrentAccount;
+        AddInstanceSize(header, charged_size, 1);
+        return InitBlock(block, size, kind, size_class);
+    }
+
+    // Moves a batch of blocks from the shared free list to the (empty) cache of this thread, with a new page if needed
+    static bool RefillPoolCache(PoolCache* cache, uint32_t size_class, uint32_t block_size)
+    {
+        dmMutex::ScopedLock lk(g_Allocator.m_Mutex);
+        PoolBlock* block = g_Allocator.m_FreeLists[size_class];
+        if (!block)
+        {
+            PoolPage* page = (PoolPage*)malloc(sizeof(PoolPage) + POOL_PAGE_SIZE);
+            if (!page)
+                return false;
+            page->m_Next = g_Allocator.m_Pages;
+            g_Allocator.m_Pages = page;
+            dmAtomicAdd32(&g_Allocator.m_PoolSize, (int32_t)(sizeof(PoolPage) + POOL_PAGE_SIZE));
+
+            uint8_t* begin = (uint8_t*)(page + 1);
+            uint32_t count = POOL_PAGE_SIZE / block_size;
+            for (uint32_t i = count; i > 0; --i)
+            {
+                PoolBlock* free_block = (PoolBlock*)(begin + (i - 1) * block_size);
+                free_block->m_Next = block;
+                block = free_block;
+            }
+        }
+
+        PoolBlock* first = block;
+        uint32_t count = 1;
+        while (count < POOL_CACHE_BATCH_COUNT && block->m_Next)
+        {
+            block = block->m_Next;
+            ++count;
+        }
+        g_Allocator.m_FreeLists[size_class] = block->m_Next;
+        block->m_Next = 0;
+
+        cache->m_FreeLists[size_class] = first;
+        cache->m_Counts[size_class] = count;
+        return true;
+    }
+
+    // Moves a batch of blocks from the (full) cache of this thread back to the shared free list
+    static void FlushPoolCache(PoolCache* cache, uint32_t size_class)
+    {
+        PoolBlock* first = cache->m_FreeLists[size_class];
+        PoolBlock* last = first;
+        for (uint32_t i = 1; i < POOL_CACHE_BATCH_COUNT; ++i)
+        {
+            last = last->m_Next;
+        }
+        cache->m_FreeLists[size_class] = last->m_Next;
+        cache->m_Counts[size_class] -= POOL_CACHE_BATCH_COUNT;
+
+        dmMutex::ScopedLock lk(g_Allocator.m_Mutex);
+        last->m_Next = g_Allocator.m_FreeLists[size_class];
+        g_Allocator.m_FreeLists[size_class] = first;
+    }
+
+    void FlushThreadAllocatorCache()
+    {
+        if (!g_Allocator.m_Mutex)
+            return;
+
+        PoolCache* cache = &g_PoolCache;
+        dmMutex::ScopedLock lk(g_Allocator.m_Mutex);
+        for (uint32_t size_class = 0; size_class < POOL_CLASS_COUNT; ++size_class)
+        {
+            PoolBlock* first = cache->m_FreeLists[size_class];
+            if (!first)
+                continue;
+            PoolBlock* last = first;
+            while (last->m_Next)
+            {
+                last = last->m_Next;
+            }
+            last->m_Next = g_Allocator.m_FreeLists[size_class];
+            g_Allocator.m_FreeLists[size_class] = first;
+            cache->m_FreeLists[size_class] = 0;
+            cache->m_Counts[size_class] = 0;
+        }
+    }
+
+    static void* PoolAlloc(size_t size)
+    {
+        uint32_t size_class = (AlignSize(size) / ALIGNMENT) - 1;
+        uint32_t block_size = sizeof(BlockHeader) + (size_class + 1) * ALIGNMENT;
+
+        PoolCache* cache = &g_PoolCache;
+        if (!cache->m_FreeLists[size_class] && !RefillPoolCache(cache, size_class, block_size))
+            return 0;
+
+        PoolBlock* block = cache->m_FreeLists[size_class];
+        cache->m_FreeLists[size_class] = block->m_Next;
+        cache->m_Counts[size_class]--;
+        return InitInstanceBlock(block, size, BLOCK_KIND_POOL, size_class, (int32_t)block_size);
+    }
+
+    static void PoolFree(BlockHeader* header)
+    {
+        uint32_t size_class = header->m_SizeClass;
+        uint32_t block_size = sizeof(BlockHeader) + (size_class + 1) * ALIGNMENT;
+        AddInstanceSize(header, -(int32_t)block_size, -1);
+
+        PoolCache* cache = &g_PoolCache;
+        PoolBlock* block = (PoolBlock*)header;
+        block->m_Next = cache->m_FreeLists[size_class];
+        cache->m_FreeLists[size_class] = block;
+        if (++cache->m_Counts[size_class] > POOL_CACHE_MAX_COUNT)
+            FlushPoolCache(cache, size_class);
+    }
+
+    static void* HeapAlloc(size_t size)
+    {
+        void* block = malloc(sizeof(BlockHeader) + size);
+        if (!block)
+            return 0;
+        return InitInstanceBlock(block, size, BLOCK_KIND_HEAP, 0, (int32_t)size);
+    }
+
+    // ********************************************************************************************************
+    // The spine runtime hooks
+
+    static void* SpineMalloc(size_t size)
+    {
+        if (size == 0)
+            size = 1;
+        SpineArena* arena = g_CurrentArena;
+        if (arena)
+            return ArenaAlloc(arena, size);
+        if (size <= POOL_MAX_SIZE)
+            return PoolAlloc(size);
+        return HeapAlloc(size);
+    }
+
+    static void SpineFree(void* ptr)
+    {
+        if (!ptr)
+            return;
+        BlockHeader* header = GetHeader(ptr);
+        switch (header->m_Kind)
+        {
+        case BLOCK_KIND_POOL:
+            PoolFree(header);
+            break;
+        case BLOCK_KIND_HEAP:
+            AddInstanceSize(header, -(int32_t)header->m_Size, -1);
+            free(header);
+            break;
+        default: // The arena memory is freed with the arena
+            if (header->m_Arena == g_CurrentArena)
+                ArenaFree(g_CurrentArena, header);
+            break;
+        }
+    }
+
+    static void* SpineRealloc(void* ptr, size_t size)
+    {
+        if (!ptr)
+            return SpineMalloc(size);
+        if (size == 0)
+            size = 1;
+
+        BlockHeader* header = GetHeader(ptr);
+        uint32_t old_size = header->m_Size;
+        switch (header->m_Kind)
+        {
+        case BLOCK_KIND_POOL:
+            if (AlignSize(size) == (header->m_SizeClass + 1) * ALIGNMENT)
+            {
+                header->m_Size = (uint32_t)size;
+                return ptr;
+            }
+            break;
+        case BLOCK_KIND_HEAP:
+            if (size > POOL_MAX_SIZE && !g_CurrentArena)
+            {
+                BlockHeader* new_header = (BlockHeader*)realloc(header, sizeof(BlockHeader) + size);
+                if (!new_header)
+                    return 0;
+                AddInstanceSize(new_header, (int32_t)((uint32_t)size - old_size), 0);
+                new_header->m_Size = (uint32_t)size;
+                return new_header + 1;
+            }
+            break;
+        default:
+            if (header->m_Arena == g_CurrentArena && ArenaTryGrow(g_CurrentArena, ptr, size))
+                return ptr;
+            break;
+        }
+
+        // A moved instance block stays charged to its account
+        AccountScope account_scope(header->m_Kind != BLOCK_KIND_ARENA ? header->m_Account : g_CurrentAccount);
+        void* new_ptr = SpineMalloc(size);
+        if (!new_ptr)
+            return 0;
+        memcpy(new_ptr, ptr, dmMath::Min(old_size, (uint32_t)size));
+        SpineFree(ptr);
+        return new_ptr;
+    }
+
+    void InstallAllocator()
+    {
+        if (g_Allocator.m_Mutex)
+            return;
+        memset(&g_Allocator, 0, sizeof(g_Allocator));
+        g_Allocator.m_Mutex = dmMutex::New();
+
+        _spSetMalloc(SpineMalloc);
+        _spSetRealloc(SpineRealloc);
+        _spSetFree(SpineFree);
+    }
+
+    void GetAllocatorStats(AllocatorStats* stats)
+    {
+        memset(stats, 0, sizeof(AllocatorStats));
+        if (!g_Allocator.m_Mutex)
+            return;
+        stats->m_ArenaSize = (uint32_t)dmAtomicGet32(&g_Allocator.m_ArenaSize);
+        stats->m_ArenaAllocationCount = (uint32_t)dmAtomicGet32(&g_Allocator.m_ArenaAllocationCount);
+        stats->m_InstanceSize = (uint32_t)dmAtomicGet32(&g_Allocator.m_InstanceSize);
+        stats->m_InstanceAllocationCount = (uint32_t)dmAtomicGet32(&g_Allocator.m_InstanceAllocationCount);
+        stats->m_PoolSize = (uint32_t)dmAtomicGet32(&g_Allocator.m_PoolSize);
+    }
+}
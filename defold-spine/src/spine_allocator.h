@@ -0,0 +1,74 @@
+#ifndef DM_SPINE_ALLOCATOR_H
+#define DM_SPINE_ALLOCATOR_H
+
+#include <stdint.h>
+#include <dmsdk/dlib/atomic.h>
+
+namespace dmSpine
+{
+    // The allocations of the spine runtime (see _spSetMalloc) are made from:
+    //   * an arena, while an ArenaScope is active on the calling thread. Used for the immutable
+    //     skeleton data, which is freed in one go with the arena. The blocks freed while loading
+    //     (e.g. the temporaries of the readers) are reused by the later allocations of the same size.
+    //   * size class pools, for the small allocations (skeleton instances, animation states, track entries...).
+    //     Each thread keeps a few free blocks per size class, so that the threads rarely share the lock
+    //   * the heap, for everything else
+    // Each allocation has a small header telling where it came from, so they can be freed or reallocated from anywhere.
+    // The pool and heap allocations are also charged to the account of an AccountScope, e.g. the one of their spine scene.
+    typedef struct SpineArena* HSpineArena;
+
+    // Installs the spine allocation hooks. Must be called once, before anything is allocated by the spine runtime
+    void InstallAllocator();
+
+    HSpineArena NewArena();
+    // Frees all the memory allocated in the arena. The spine objects in it must have been disposed (or be unreachable)
+    void     DeleteArena(HSpineArena arena);
+    uint32_t GetArenaSize(HSpineArena arena);              // Bytes reserved by the arena
+    uint32_t GetArenaAllocationCount(HSpineArena arena);
+
+    // While in scope, the spine allocations on this thread are made from the arena
+    struct ArenaScope
+    {
+        ArenaScope(HSpineArena arena);
+        ~ArenaScope();
+
+        HSpineArena m_Arena;
+        HSpineArena m_Previous;
+        uint32_t    m_Size;
+        uint32_t    m_AllocationCount;
+    };
+
+    // The instance allocations charged to e.g. a spine scene
+    struct AllocationAccount
+    {
+        int32_atomic_t m_Size;              // Bytes, counted as in AllocatorStats::m_InstanceSize
+        int32_atomic_t m_AllocationCount;
+    };
+
+    // While in scope, the pool and heap allocations on this thread are charged to the account (which may be 0).
+    // The account must outlive them
+    struct AccountScope
+    {
+        AccountScope(AllocationAccount* account);
+        ~AccountScope();
+
+        AllocationAccount* m_Previous;
+    };
+
+    // Totals for all spine scenes and instances. The data size of a single scene is its resource size
+    struct AllocatorStats
+    {
+        uint32_t m_ArenaSize;               // Bytes reserved by all arenas
+        uint32_t m_ArenaAllocationCount;
+        uint32_t m_InstanceSize;            // Bytes currently allocated outside of the arenas
+        uint32_t m_InstanceAllocationCount;
+        uint32_t m_PoolSize;                // Bytes reserved by the size class pools
+    };
+
+    void GetAllocatorStats(AllocatorStats* stats);
+
+    // Returns the free pool blocks cached by the calling thread to the shared pools. Called by the spine threads before they exit
+    void FlushThreadAllocatorCache();
+}
+
+#endif // DM_SPINE_ALLOCATOR_H
@@ -0,0 +1,168 @@
+#include "spine_jobs.h"
+#include "spine_allocator.h"
+
+#include <dmsdk/dlib/array.h>
+#include <dmsdk/dlib/condition_variable.h>
+#include <dmsdk/dlib/math.h>
+#include <dmsdk/dlib/mutex.h>
+#include <dmsdk/dlib/thread.h>
+
+namespace dmSpine
+{
+    static const uint32_t JOB_THREAD_STACK_SIZE = 0x40000;
+    static const uint32_t JOB_MAX_THREAD_COUNT = 16;
+
+    struct JobPool
+    {
+        dmArray<dmThread::Thread>               m_Threads;
+        dmMutex::HMutex                         m_Mutex;
+        dmConditionVariable::HConditionVariable m_WorkCondition;
+        dmConditionVariable::HConditionVariable m_DoneCondition;
+
+        // All members below are protected by m_Mutex
+        JobFn                                   m_Fn;
+        void*                                   m_Context;
+        uint32_t                                m_Count;
+        uint32_t                                m_ChunkSize;
+        uint32_t                                m_Next;
+        uint32_t                                m_Generation;
+        uint32_t                                m_Pending; // Number of worker threads still working on the current generation
+        uint8_t                                 m_Quit : 1;
+    };
+
+    // Expects the mutex to be locked, and returns with it locked
+    static void ProcessChunks(JobPool* pool)
+    {
+        while (pool->m_Next < pool->m_Count)
+        {
+            uint32_t begin = pool->m_Next;
+            uint32_t end = dmMath::Min(pool->m_Count, begin + pool->m_ChunkSize);
+            pool->m_Next = end;
+
+            JobFn fn = pool->m_Fn;
+            void* context = pool->m_Context;
+
+            dmMutex::Unlock(pool->m_Mutex);
+            fn(context, begin, end);
+            dmMutex::Lock(pool->m_Mutex);
+        }
+    }
+
+    static void WorkerThread(void* arg)
+    {
+        JobPool* pool = (JobPool*)arg;
+        uint32_t generation = 0;
+
+        dmMutex::Lock(pool->m_Mutex);
+        while (true)
+        {
+            while (!pool->m_Quit && generation == pool->m_Generation)
+            {
+                dmConditionVariable::Wait(pool->m_WorkCondition, pool->m_Mutex);
+            }
+            if (pool->m_Quit)
+                break;
+
+            generation = pool->m_Generation;
+            ProcessChunks(pool);
+
+            if (--pool->m_Pending == 0)
+            {
+                dmConditionVariable::Signal(pool->m_DoneCondition);
+            }
+        }
+        dmMutex::Unlock(pool->m_Mutex);
+
+        FlushThreadAllocatorCache();
+    }
+
+    HJobPool NewJobPool(uint32_t thread_count)
+    {
+#if defined(__EMSCRIPTEN__)
+        // No worker threads on the web, everything is run on the calling thread
+        thread_count = 0;
+#endif
+        thread_count = dmMath::Min(thread_count, JOB_MAX_THREAD_COUNT);
+
+        JobPool* pool = new JobPool;
+        pool->m_Mutex = dmMutex::New();
+        pool->m_WorkCondition = dmConditionVariable::New();
+        pool->m_DoneCondition = dmConditionVariable::New();
+        pool->m_Fn = 0;
+        pool->m_Context = 0;
+        pool->m_Count = 0;
+        pool->m_ChunkSize = 1;
+        pool->m_Next = 0;
+        pool->m_Generation = 0;
+        pool->m_Pending = 0;
+        pool->m_Quit = 0;
+
+        pool->m_Threads.SetCapacity(thread_count);
+        for (uint32_t i = 0; i < thread_count; ++i)
+        {
+            dmThread::Thread thread = dmThread::New(WorkerThread, JOB_THREAD_STACK_SIZE, pool, "spine_update");
+            pool->m_Threads.Push(thread);
+        }
+        return pool;
+    }
+
+    void DeleteJobPool(HJobPool pool)
+    {
+        if (!pool)
+            return;
+
+        dmMutex::Lock(pool->m_Mutex);
+        pool->m_Quit = 1;
+        dmConditionVariable::Broadcast(pool->m_WorkCondition);
+        dmMutex::Unlock(pool->m_Mutex);
+
+        for (uint32_t i = 0; i < pool->m_Threads.Size(); ++i)
+        {
+            dmThread::Join(pool->m_Threads[i]);
+        }
+
+        dmConditionVariable::Delete(pool->m_DoneCondition);
+        dmConditionVariable::Delete(pool->m_WorkCondition);
+        dmMutex::Delete(pool->m_Mutex);
+        delete pool;
+    }
+
+    uint32_t GetJobPoolThreadCount(HJobPool pool)
+    {
+        return pool ? pool->m_Threads.Size() : 0;
+    }
+
+    void RunJob(HJobPool pool, JobFn fn, void* context, uint32_t count, uint32_t chunk_size)
+    {
+        if (count == 0)
+            return;
+
+        chunk_size = dmMath::Max(chunk_size, 1U);
+        if (!pool || pool->m_Threads.Empty() || count <= chunk_size)
+        {
+            fn(context, 0, count);
+            return;
+        }
+
+        dmMutex::Lock(pool->m_Mutex);
+        pool->m_Fn = fn;
+        pool->m_Context = context;
+        pool->m_Count = count;
+        pool->m_ChunkSize = chunk_size;
+        pool->m_Next = 0;
+        pool->m_Pending = pool->m_Threads.Size();
+        ++pool->m_Generation;
+        dmConditionVariable::Broadcast(pool->m_WorkCondition);
+
+        // The calling thread helps out until there are no chunks left
+        ProcessChunks(pool);
+
+        while (pool->m_Pending > 0)
+        {
+            dmConditionVariable::Wait(pool->m_DoneCondition, pool->m_Mutex);
+        }
+        pool->m_Fn = 0;
+        pool->m_Context = 0;
+        dmMutex::Unlock(pool->m_Mutex);
+    }
+}
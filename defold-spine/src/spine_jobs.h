@@ -0,0 +1,24 @@
+#ifndef DM_SPINE_JOBS_H
+#define DM_SPINE_JOBS_H
+
+#include <stdint.h>
+
+namespace dmSpine
+{
+    // A small fixed size worker pool used to split per-component work into chunks.
+    // The calling thread always takes part in the work, so a pool with zero
+    // worker threads simply runs the job inline.
+    typedef struct JobPool* HJobPool;
+
+    // Processes the items [begin, end)
+    typedef void (*JobFn)(void* context, uint32_t begin, uint32_t end);
+
+    HJobPool NewJobPool(uint32_t thread_count);
+    void     DeleteJobPool(HJobPool pool);
+    uint32_t GetJobPoolThreadCount(HJobPool pool);
+
+    // Splits [0, count) into chunks of chunk_size items and blocks until all of them are processed
+    void     RunJob(HJobPool pool, JobFn fn, void* context, uint32_t count, uint32_t chunk_size);
+}
+
+#endif // DM_SPINE_JOBS_H
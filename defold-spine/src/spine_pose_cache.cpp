@@ -0,0 +1,226 @@
+#include "spine_pose_cache.h"
+#include "res_spine_scene.h"
+
+extern "C" {
+
+#include <spine/Animation.h>
+#include <spine/AnimationState.h>
+#include <spine/Bone.h>
+#include <spine/Skeleton.h>
+#include <spine/SkeletonData.h>
+#include <spine/Slot.h>
+#include <spine/SlotData.h>
+#include <spine/extension.h>
+
+} // extern C
+
+#include <assert.h>
+#include <string.h> // memcpy
+
+#include <dmsdk/dlib/array.h>
+#include <dmsdk/dlib/hashtable.h>
+#include <dmsdk/dlib/math.h>
+
+namespace dmSpine
+{
+    // Max number of distinct poses kept per spine scene
+    static const uint32_t POSE_CACHE_MAX_POSES = 64;
+
+    struct SpinePoseCache
+    {
+        dmArray<SpinePose*>     m_Poses;
+        dmHashTable64<uint32_t> m_KeyToIndex;
+        uint32_t                m_Tick;
+    };
+
+    bool MakePoseDesc(spAnimationState* state, spSkin* skin, float time_step, SpinePoseDesc* desc)
+    {
+        HashState64 hash_state;
+        dmHashInit64(&hash_state, false);
+        dmHashUpdateBuffer64(&hash_state, &skin, sizeof(skin));
+
+        desc->m_Skin = skin;
+        desc->m_TrackCount = 0;
+
+        for (int i = 0; i < state->tracksCount; ++i)
+        {
+            spTrackEntry* entry = state->tracks[i];
+            if (!entry || entry->delay > 0)
+                continue;
+            if (entry->mixingFrom || desc->m_TrackCount == POSE_CACHE_MAX_TRACKS)
+                return false;
+
+            // Same as spAnimationState_apply()
+            float alpha = entry->alpha;
+            if (entry->trackTime >= entry->trackEnd && entry->next == 0)
+                alpha = 0.0f;
+
+            float time = spTrackEntry_getAnimationTime(entry);
+            if (entry->reverse)
+                time = entry->animation->duration - time;
+
+            int32_t frame = (int32_t)(time / time_step + 0.5f);
+
+            SpinePoseTrack& track = desc->m_Tracks[desc->m_TrackCount++];
+            track.m_Animation = entry->animation;
+            track.m_Time = dmMath::Min(frame * time_step, entry->animation->duration);
+            track.m_Alpha = alpha;
+            track.m_Blend = i == 0 ? SP_MIX_BLEND_FIRST : entry->mixBlend;
+
+            dmHashUpdateBuffer64(&hash_state, &i, sizeof(i));
+            dmHashUpdateBuffer64(&hash_state, &track.m_Animation, sizeof(track.m_Animation));
+            dmHashUpdateBuffer64(&hash_state, &frame, sizeof(frame));
+            dmHashUpdateBuffer64(&hash_state, &track.m_Alpha, sizeof(track.m_Alpha));
+            dmHashUpdateBuffer64(&hash_state, &track.m_Blend, sizeof(track.m_Blend));
+        }
+
+        desc->m_Key = dmHashFinal64(&hash_state);
+        return true;
+    }
+
+    SpinePose* AcquirePose(SpineSceneResource* scene, const SpinePoseDesc& desc, bool* out_created)
+    {
+        SpinePoseCache* cache = scene->m_PoseCache;
+        if (!cache)
+        {
+            cache = new SpinePoseCache;
+            cache->m_Poses.SetCapacity(POSE_CACHE_MAX_POSES);
+            cache->m_KeyToIndex.SetCapacity(POSE_CACHE_MAX_POSES / 2 + 1, POSE_CACHE_MAX_POSES);
+            cache->m_Tick = 0;
+            scene->m_PoseCache = cache;
+        }
+
+        ++cache->m_Tick;
+        *out_created = false;
+
+        uint32_t* existing = cache->m_KeyToIndex.Get(desc.m_Key);
+        if (existing)
+        {
+            SpinePose* pose = cache->m_Poses[*existing];
+            pose->m_RefCount++;
+            pose->m_LastUsed = cache->m_Tick;
+            return pose;
+        }
+
+        uint32_t index = cache->m_Poses.Size();
+        if (!cache->m_Poses.Full())
+        {
+            SpinePose* pose = new SpinePose;
+            AccountScope account_scope(&scene->m_InstanceAccount);
+            pose->m_Skeleton = spSkeleton_create(scene->m_Skeleton);
+            cache->m_Poses.Push(pose);
+        }
+        else
+        {
+            // Reuse the least recently used pose that nobody is referencing
+            index = POSE_CACHE_MAX_POSES;
+            uint32_t oldest = 0xFFFFFFFF;
+            for (uint32_t i = 0; i < cache->m_Poses.Size(); ++i)
+            {
+                SpinePose* pose = cache->m_Poses[i];
+                if (pose->m_RefCount == 0 && pose->m_LastUsed < oldest)
+                {
+                    index = i;
+                    oldest = pose->m_LastUsed;
+                }
+            }
+            if (index == POSE_CACHE_MAX_POSES)
+                return 0;
+            cache->m_KeyToIndex.Erase(cache->m_Poses[index]->m_Desc.m_Key);
+        }
+
+        SpinePose* pose = cache->m_Poses[index];
+        pose->m_Desc = desc;
+        pose->m_RefCount = 1;
+        pose->m_LastUsed = cache->m_Tick;
+        cache->m_KeyToIndex.Put(desc.m_Key, index);
+
+        *out_created = true;
+        return pose;
+    }
+
+    void ReleasePose(SpineSceneResource* scene, SpinePose* pose)
+    {
+        assert(scene->m_PoseCache);
+        assert(pose->m_RefCount > 0);
+        pose->m_RefCount--;
+    }
+
+    void EvaluatePose(SpinePose* pose)
+    {
+        spSkeleton* skeleton = pose->m_Skeleton;
+        const SpinePoseDesc& desc = pose->m_Desc;
+
+        if (skeleton->skin != desc.m_Skin)
+        {
+            spSkeleton_setSkin(skeleton, desc.m_Skin);
+        }
+        spSkeleton_setToSetupPose(skeleton);
+
+        for (uint32_t i = 0; i < desc.m_TrackCount; ++i)
+        {
+            const SpinePoseTrack& track = desc.m_Tracks[i];
+            spAnimation_apply(track.m_Animation, skeleton, -1.0f, track.m_Time, 0, 0, 0, track.m_Alpha, (spMixBlend)track.m_Blend, SP_MIX_DIRECTION_IN);
+        }
+
+        spSkeleton_updateWorldTransform(skeleton, SP_PHYSICS_NONE);
+    }
+
+    void ResetPoseCache(SpineSceneResource* scene)
+    {
+        ++scene->m_PoseCacheGeneration;
+
+        SpinePoseCache* cache = scene->m_PoseCache;
+        if (!cache)
+            return;
+
+        for (uint32_t i = 0; i < cache->m_Poses.Size(); ++i)
+        {
+            spSkeleton_dispose(cache->m_Poses[i]->m_Skeleton);
+            delete cache->m_Poses[i];
+        }
+        delete cache;
+        scene->m_PoseCache = 0;
+    }
+
+    void CopyPose(const spSkeleton* src, spSkeleton* dst)
+    {
+        assert(src->data == dst->data);
+
+        for (int i = 0; i < src->bonesCount; ++i)
+        {
+            const spBone* s = src->bones[i];
+            spBone* d = dst->bones[i];
+            d->x = s->x;
+            d->y = s->y;
+            d->rotation = s->rotation;
+            d->scaleX = s->scaleX;
+            d->scaleY = s->scaleY;
+            d->shearX = s->shearX;
+            d->shearY = s->shearY;
+        }
+
+        for (int i = 0; i < src->slotsCount; ++i)
+        {
+            spSlot* s = src->slots[i];
+            spSlot* d = dst->slots[i];
+            spColor_setFromColor(&d->color, &s->color);
+            if (s->darkColor && d->darkColor)
+                spColor_setFromColor(d->darkColor, s->darkColor);
+
+            spSlot_setAttachment(d, s->attachment);
+            d->sequenceIndex = s->sequenceIndex;
+
+            if (d->deformCapacity < s->deformCount)
+            {
+                d->deform = REALLOC(d->deform, float, s->deformCount);
+                d->deformCapacity = s->deformCount;
+            }
+            if (s->deformCount)
+                memcpy(d->deform, s->deform, sizeof(float) * s->deformCount);
+            d->deformCount = s->deformCount;
+
+            dst->drawOrder[i] = dst->slots[src->drawOrder[i]->data->index];
+        }
+    }
+}
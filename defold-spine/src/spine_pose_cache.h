@@ -0,0 +1,67 @@
+#ifndef DM_SPINE_POSE_CACHE_H
+#define DM_SPINE_POSE_CACHE_H
+
+#include <stdint.h>
+#include <dmsdk/dlib/hash.h>
+
+struct spAnimation;
+struct spAnimationState;
+struct spSkeleton;
+struct spSkin;
+
+namespace dmSpine
+{
+    struct SpineSceneResource;
+    struct SpinePoseCache;
+
+    // Max number of active tracks for an animation state to be able to share its pose
+    static const uint32_t POSE_CACHE_MAX_TRACKS = 4;
+
+    struct SpinePoseTrack
+    {
+        const spAnimation*  m_Animation;
+        float               m_Time;     // The quantized animation time
+        float               m_Alpha;
+        int32_t             m_Blend;    // spMixBlend
+    };
+
+    // Describes a pose as a function of the animation state.
+    // Instances of the same spine scene with the same key will have identical poses
+    struct SpinePoseDesc
+    {
+        SpinePoseTrack      m_Tracks[POSE_CACHE_MAX_TRACKS];
+        spSkin*             m_Skin;
+        dmhash_t            m_Key;
+        uint32_t            m_TrackCount;
+    };
+
+    // A skeleton posed from a SpinePoseDesc, shared between all instances using the same key
+    struct SpinePose
+    {
+        SpinePoseDesc       m_Desc;
+        spSkeleton*         m_Skeleton;
+        uint32_t            m_RefCount;
+        uint32_t            m_LastUsed;
+    };
+
+    // Returns false if the current state cannot be shared (e.g. while mixing between animations)
+    bool MakePoseDesc(spAnimationState* state, spSkin* skin, float time_step, SpinePoseDesc* desc);
+
+    // Returns 0 if the cache is full. If out_created is set, the pose must be evaluated before use.
+    // Must be called from the main thread
+    SpinePose* AcquirePose(SpineSceneResource* scene, const SpinePoseDesc& desc, bool* out_created);
+    void       ReleasePose(SpineSceneResource* scene, SpinePose* pose);
+
+    // Applies the animations to the pose skeleton and updates its world transforms.
+    // Only touches the pose, so different poses may be evaluated in parallel
+    void       EvaluatePose(SpinePose* pose);
+
+    // Drops all cached poses, e.g. when the skeleton data or the skins have changed.
+    // Any pose acquired before this call is no longer valid
+    void       ResetPoseCache(SpineSceneResource* scene);
+
+    // Copies the local bone transforms, slot state and draw order between two skeletons of the same data
+    void       CopyPose(const spSkeleton* src, spSkeleton* dst);
+}
+
+#endif // DM_SPINE_POSE_CACHE_H
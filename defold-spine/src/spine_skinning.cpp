@@ -0,0 +1,431 @@
+#include "spine_skinning.h"
+#include "res_spine_scene.h"
+
+extern "C" {
+
+#include <spine/Attachment.h>
+#include <spine/Bone.h>
+#include <spine/BoneData.h>
+#include <spine/MeshAttachment.h>
+#include <spine/RegionAttachment.h>
+#include <spine/Skeleton.h>
+#include <spine/SkeletonData.h>
+#include <spine/Skin.h>
+#include <spine/Slot.h>
+#include <spine/SlotData.h>
+#include <spine/extension.h>
+
+} // extern C
+
+#include <float.h>  // FLT_MAX
+#include <math.h>   // sqrtf
+#include <string.h> // memset
+
+#include <dmsdk/dlib/hash.h>
+#include <dmsdk/dlib/log.h>
+#include <dmsdk/dlib/math.h>
+
+namespace dmSpine
+{
+    static const uint16_t QUAD_INDICES[]         = {0, 1, 2, 2, 3, 0};
+    static const uint32_t QUAD_INDEX_COUNT       = sizeof(QUAD_INDICES) / sizeof(QUAD_INDICES[0]);
+    static const uint32_t QUAD_VERTEX_COUNT      = 4;
+    static const float    COLOR_ALPHA_EPSILON    = 1e-6f; // Same as the CPU path
+
+    static dmhash_t GetAttachmentKey(int slot_index, const spAttachment* attachment)
+    {
+        struct
+        {
+            const spAttachment* m_Attachment;
+            int                 m_SlotIndex;
+        } key;
+        memset(&key, 0, sizeof(key));
+        key.m_Attachment = attachment;
+        key.m_SlotIndex = slot_index;
+        return dmHashBuffer64(&key, sizeof(key));
+    }
+
+    static void InitVertex(SpineSkinnedVertex* vertex, int slot_index, const spColor* color, float u, float v)
+    {
+        memset(vertex, 0, sizeof(SpineSkinnedVertex));
+        vertex->u = u;
+        vertex->v = v;
+        vertex->r = (uint8_t)(dmMath::Clamp(color->r, 0.0f, 1.0f) * 255.0f + 0.5f);
+        vertex->g = (uint8_t)(dmMath::Clamp(color->g, 0.0f, 1.0f) * 255.0f + 0.5f);
+        vertex->b = (uint8_t)(dmMath::Clamp(color->b, 0.0f, 1.0f) * 255.0f + 0.5f);
+        vertex->a = (uint8_t)(dmMath::Clamp(color->a, 0.0f, 1.0f) * 255.0f + 0.5f);
+        vertex->slot = (float)(slot_index + 1);
+    }
+
+    static void SetInfluence(SpineSkinnedGeometry* geometry, SpineSkinnedVertex* vertex, uint32_t influence, int bone_index, float x, float y, float weight)
+    {
+        vertex->positions[influence * 2 + 0] = x;
+        vertex->positions[influence * 2 + 1] = y;
+        vertex->weights[influence] = weight;
+        vertex->bones[influence] = (uint8_t)(bone_index + 1);
+
+        float& radius = geometry->m_BoneRadius[bone_index];
+        radius = dmMath::Max(radius, sqrtf(x * x + y * y));
+    }
+
+    // Returns false if the attachment can't be skinned on the GPU
+    static bool AddAttachment(SpineSkinnedGeometry* geometry, const spSkeletonData* skeleton_data, int slot_index, const spAttachment* attachment, dmArray<SpineSkinnedVertex>& vertices)
+    {
+        int slot_bone_index = skeleton_data->slots[slot_index]->boneData->index;
+
+        if (attachment->type == SP_ATTACHMENT_REGION)
+        {
+            const spRegionAttachment* region = (const spRegionAttachment*)attachment;
+            if (region->sequence)
+                return false;
+
+            if (vertices.Remaining() < QUAD_VERTEX_COUNT)
+                vertices.OffsetCapacity(dmMath::Max(QUAD_VERTEX_COUNT, vertices.Capacity()));
+
+            for (uint32_t i = 0; i < QUAD_VERTEX_COUNT; ++i)
+            {
+                // Same order as spRegionAttachment_computeWorldVertices(), which starts with the last corner of the offsets
+                uint32_t offset = ((i + 3) % QUAD_VERTEX_COUNT) * 2;
+                SpineSkinnedVertex vertex;
+                InitVertex(&vertex, slot_index, &region->color, region->uvs[i * 2], region->uvs[i * 2 + 1]);
+                SetInfluence(geometry, &vertex, 0, slot_bone_index, region->offset[offset], region->offset[offset + 1], 1.0f);
+                vertices.Push(vertex);
+            }
+            return true;
+        }
+
+        if (attachment->type == SP_ATTACHMENT_MESH)
+        {
+            const spMeshAttachment* mesh = (const spMeshAttachment*)attachment;
+            const spVertexAttachment* vertex_attachment = &mesh->super;
+            if (mesh->sequence)
+                return false;
+
+            uint32_t vertex_count = vertex_attachment->worldVerticesLength / 2;
+            uint32_t vertex_start = vertices.Size();
+            if (vertices.Remaining() < vertex_count)
+                vertices.OffsetCapacity(dmMath::Max(vertex_count, vertices.Capacity()));
+
+            const float* local = vertex_attachment->vertices;
+            const int* bones = vertex_attachment->bones;
+            for (uint32_t i = 0, b = 0, f = 0; i < vertex_count; ++i)
+            {
+                SpineSkinnedVertex vertex;
+                InitVertex(&vertex, slot_index, &mesh->color, mesh->uvs[i * 2], mesh->uvs[i * 2 + 1]);
+
+                if (!bones)
+                {
+                    // Relative to the slot bone
+                    SetInfluence(geometry, &vertex, 0, slot_bone_index, local[i * 2], local[i * 2 + 1], 1.0f);
+                }
+                else
+                {
+                    // The bone count, followed by the bone indices. The vertices are x, y and weight per bone
+                    uint32_t influence_count = (uint32_t)bones[b++];
+                    if (influence_count > SKINNING_MAX_INFLUENCES)
+                    {
+                        vertices.SetSize(vertex_start);
+                        return false;
+                    }
+                    for (uint32_t j = 0; j < influence_count; ++j, f += 3)
+                    {
+                        SetInfluence(geometry, &vertex, j, bones[b++], local[f], local[f + 1], local[f + 2]);
+                    }
+                }
+                vertices.Push(vertex);
+            }
+            return true;
+        }
+
+        return false;
+    }
+
+    static SpineSkinnedGeometry* CreateSkinnedGeometry(const spSkeletonData* skeleton_data, dmGraphics::HContext graphics_context)
+    {
+        SpineSkinnedGeometry* geometry = new SpineSkinnedGeometry;
+        geometry->m_VertexBuffer = 0;
+        geometry->m_VertexCount = 0;
+        geometry->m_Supported = (uint32_t)skeleton_data->bonesCount < SKINNING_MAX_BONES && (uint32_t)skeleton_data->slotsCount < SKINNING_MAX_SLOTS;
+        if (!geometry->m_Supported)
+        {
+            dmLogWarning("The skeleton has too many bones (%d) or slots (%d) for GPU skinning (max %u and %u). Using the CPU instead.",
+                skeleton_data->bonesCount, skeleton_data->slotsCount, SKINNING_MAX_BONES - 1, SKINNING_MAX_SLOTS - 1);
+            return geometry;
+        }
+
+        // The shader has no dark color (tint black), so skeletons that use it stay on the CPU path
+        for (int i = 0; i < skeleton_data->slotsCount; ++i)
+        {
+            if (skeleton_data->slots[i]->darkColor)
+            {
+                dmLogWarning("The skeleton has a slot with a dark color (%s), which isn't supported by GPU skinning. Using the CPU instead.", skeleton_data->slots[i]->name);
+                geometry->m_Supported = 0;
+                return geometry;
+            }
+        }
+
+        geometry->m_BoneRadius.SetCapacity(skeleton_data->bonesCount);
+        geometry->m_BoneRadius.SetSize(skeleton_data->bonesCount);
+        memset(geometry->m_BoneRadius.Begin(), 0, sizeof(float) * skeleton_data->bonesCount);
+
+        dmArray<SpineSkinnedVertex> vertices;
+        for (int s = 0; s < skeleton_data->skinsCount; ++s)
+        {
+            for (const spSkinEntry* entry = spSkin_getAttachments(skeleton_data->skins[s]); entry; entry = entry->next)
+            {
+                dmhash_t key = GetAttachmentKey(entry->slotIndex, entry->attachment);
+                if (geometry->m_AttachmentToVertexStart.Get(key))
+                    continue;
+
+                uint32_t vertex_start = vertices.Size();
+                if (!AddAttachment(geometry, skeleton_data, entry->slotIndex, entry->attachment, vertices))
+                    continue;
+
+                if (geometry->m_AttachmentToVertexStart.Full())
+                {
+                    uint32_t capacity = dmMath::Max(16U, geometry->m_AttachmentToVertexStart.Capacity() * 2);
+                    geometry->m_AttachmentToVertexStart.SetCapacity(capacity / 2 + 1, capacity);
+                }
+                geometry->m_AttachmentToVertexStart.Put(key, vertex_start);
+            }
+        }
+
+        // Drawn with 16 bit indices
+        if (vertices.Size() > SKINNING_MAX_VERTICES)
+        {
+            dmLogWarning("The skeleton has too many vertices (%u) for GPU skinning (max %u). Using the CPU instead.", vertices.Size(), SKINNING_MAX_VERTICES);
+            geometry->m_Supported = 0;
+            return geometry;
+        }
+
+        geometry->m_VertexCount = vertices.Size();
+        geometry->m_VertexBuffer = dmGraphics::NewVertexBuffer(graphics_context, sizeof(SpineSkinnedVertex) * vertices.Size(), vertices.Begin(), dmGraphics::BUFFER_USAGE_STATIC_DRAW);
+        return geometry;
+    }
+
+    SpineSkinnedGeometry* AcquireSkinnedGeometry(SpineSceneResource* scene, dmGraphics::HContext graphics_context)
+    {
+        if (!scene->m_SkinnedGeometry)
+        {
+            scene->m_SkinnedGeometry = CreateSkinnedGeometry(scene->m_Skeleton, graphics_context);
+        }
+        return scene->m_SkinnedGeometry->m_Supported ? scene->m_SkinnedGeometry : 0;
+    }
+
+    void ResetSkinnedGeometry(SpineSceneResource* scene)
+    {
+        SpineSkinnedGeometry* geometry = scene->m_SkinnedGeometry;
+        if (!geometry)
+            return;
+
+        if (geometry->m_VertexBuffer)
+            dmGraphics::DeleteVertexBuffer(geometry->m_VertexBuffer);
+        delete geometry;
+        scene->m_SkinnedGeometry = 0;
+    }
+
+    template <typename T>
+    static uint32_t AddArraySize(dmArray<T>& array, uint32_t count)
+    {
+        if (array.Remaining() < count)
+            array.OffsetCapacity(dmMath::Max(count, array.Capacity()));
+        uint32_t start = array.Size();
+        array.SetSize(start + count);
+        return start;
+    }
+
+    static void AddDrawDesc(dmArray<SpineSkinnedDrawDesc>& draw_descs, uint32_t index_start, uint32_t index_count, uint32_t blend_mode, uint32_t dynamic)
+    {
+        if (!draw_descs.Empty())
+        {
+            SpineSkinnedDrawDesc& last = draw_descs.Back();
+            if (last.m_BlendMode == blend_mode && last.m_Dynamic == dynamic && last.m_IndexStart + last.m_IndexCount == index_start)
+            {
+                last.m_IndexCount += index_count;
+                return;
+            }
+        }
+        if (draw_descs.Full())
+            draw_descs.OffsetCapacity(dmMath::Max(16U, draw_descs.Capacity()));
+
+        SpineSkinnedDrawDesc desc;
+        desc.m_IndexStart = index_start;
+        desc.m_IndexCount = index_count;
+        desc.m_BlendMode = blend_mode;
+        desc.m_Dynamic = dynamic;
+        draw_descs.Push(desc);
+    }
+
+    // Returns false as soon as a clipping attachment is found
+    static bool AddSkinnedIndices(const SpineSkinnedGeometry* geometry, const spSkeleton* skeleton, bool use_slot_blend_modes,
+                                  dmArray<uint16_t>& index_buffer, dmArray<SpineSkinnedVertex>& dynamic_vertex_buffer,
+                                  dmArray<float>& scratch, dmArray<SpineSkinnedDrawDesc>& draw_descs)
+    {
+        for (int s = 0; s < skeleton->slotsCount; ++s)
+        {
+            spSlot* slot = skeleton->drawOrder[s];
+            spAttachment* attachment = slot->attachment;
+            if (!attachment)
+                continue;
+
+            const uint16_t* indices = 0;
+            const float* uvs = 0;
+            const spColor* color = 0;
+            uint32_t indices_count = 0;
+            uint32_t vertex_count = 0;
+            bool dynamic = false;
+
+            if (attachment->type == SP_ATTACHMENT_REGION)
+            {
+                spRegionAttachment* region = (spRegionAttachment*)attachment;
+                indices = QUAD_INDICES;
+                indices_count = QUAD_INDEX_COUNT;
+                vertex_count = QUAD_VERTEX_COUNT;
+                uvs = region->uvs;
+                color = &region->color;
+            }
+            else if (attachment->type == SP_ATTACHMENT_MESH)
+            {
+                spMeshAttachment* mesh = (spMeshAttachment*)attachment;
+                indices = mesh->triangles;
+                indices_count = mesh->trianglesCount;
+                vertex_count = mesh->super.worldVerticesLength / 2;
+                uvs = mesh->uvs;
+                color = &mesh->color;
+                dynamic = slot->deformCount > 0;
+            }
+            else if (attachment->type == SP_ATTACHMENT_CLIPPING)
+            {
+                return false;
+            }
+            else
+            {
+                continue;
+            }
+
+            if (slot->color.a <= COLOR_ALPHA_EPSILON || color->a <= COLOR_ALPHA_EPSILON || !slot->bone->active)
+                continue;
+
+            const uint32_t* vertex_start = dynamic ? 0 : geometry->m_AttachmentToVertexStart.Get(GetAttachmentKey(slot->data->index, attachment));
+            uint32_t vertex_base;
+            if (vertex_start)
+            {
+                vertex_base = *vertex_start;
+            }
+            else
+            {
+                dynamic = true;
+
+                // The same as the CPU path, but the model transform is applied by the shader
+                if (scratch.Capacity() < vertex_count * 2)
+                    scratch.SetCapacity(vertex_count * 2);
+                scratch.SetSize(vertex_count * 2);
+                if (attachment->type == SP_ATTACHMENT_REGION)
+                {
+                    spRegionAttachment_computeWorldVertices((spRegionAttachment*)attachment, slot, scratch.Begin(), 0, 2);
+                }
+                else
+                {
+                    spMeshAttachment* mesh = (spMeshAttachment*)attachment;
+                    spVertexAttachment_computeWorldVertices(SUPER(mesh), slot, 0, vertex_count * 2, scratch.Begin(), 0, 2);
+                }
+
+                const spColor& skeleton_color = skeleton->color;
+                const float vertex_color[4] = {
+                    skeleton_color.r * slot->color.r * color->r,
+                    skeleton_color.g * slot->color.g * color->g,
+                    skeleton_color.b * slot->color.b * color->b,
+                    skeleton_color.a * slot->color.a * color->a
+                };
+
+                vertex_base = AddArraySize(dynamic_vertex_buffer, vertex_count);
+                TransformVertices(dynamic_vertex_buffer.Begin() + vertex_base, scratch.Begin(), uvs, vertex_count, dmVMath::Matrix4::identity(), vertex_color, 0.0f);
+            }
+
+            uint32_t index_start = AddArraySize(index_buffer, indices_count);
+            uint16_t* out = index_buffer.Begin() + index_start;
+            for (uint32_t i = 0; i < indices_count; ++i)
+            {
+                out[i] = (uint16_t)(vertex_base + indices[i]);
+            }
+
+            uint32_t blend_mode = use_slot_blend_modes ? (uint32_t)slot->data->blendMode : 0;
+            AddDrawDesc(draw_descs, index_start, indices_count, blend_mode, dynamic ? 1 : 0);
+        }
+        return true;
+    }
+
+    bool GenerateSkinnedIndices(const SpineSkinnedGeometry* geometry, const spSkeleton* skeleton, bool use_slot_blend_modes,
+                                dmArray<uint16_t>& index_buffer, dmArray<SpineSkinnedVertex>& dynamic_vertex_buffer,
+                                dmArray<float>& scratch, dmArray<SpineSkinnedDrawDesc>& draw_descs)
+    {
+        uint32_t index_buffer_start = index_buffer.Size();
+        uint32_t dynamic_vertex_buffer_start = dynamic_vertex_buffer.Size();
+        uint32_t draw_descs_start = draw_descs.Size();
+        if (AddSkinnedIndices(geometry, skeleton, use_slot_blend_modes, index_buffer, dynamic_vertex_buffer, scratch, draw_descs))
+            return true;
+
+        index_buffer.SetSize(index_buffer_start);
+        dynamic_vertex_buffer.SetSize(dynamic_vertex_buffer_start);
+        draw_descs.SetSize(draw_descs_start);
+        return false;
+    }
+
+    bool GetSkinnedBounds(const SpineSkinnedGeometry* geometry, const spSkeleton* skeleton, SpineModelBounds& bounds)
+    {
+        for (int s = 0; s < skeleton->slotsCount; ++s)
+        {
+            if (skeleton->slots[s]->deformCount > 0)
+                return false;
+        }
+
+        bounds.minX = FLT_MAX;
+        bounds.minY = FLT_MAX;
+        bounds.maxX = -FLT_MAX;
+        bounds.maxY = -FLT_MAX;
+
+        for (int i = 0; i < skeleton->bonesCount; ++i)
+        {
+            const spBone* bone = skeleton->bones[i];
+            float radius = geometry->m_BoneRadius[i];
+            if (radius == 0.0f || !bone->active)
+                continue;
+
+            // The Frobenius norm is an upper bound of how much the bone can stretch a vector
+            radius *= sqrtf(bone->a * bone->a + bone->b * bone->b + bone->c * bone->c + bone->d * bone->d);
+            bounds.minX = dmMath::Min(bounds.minX, bone->worldX - radius);
+            bounds.minY = dmMath::Min(bounds.minY, bone->worldY - radius);
+            bounds.maxX = dmMath::Max(bounds.maxX, bone->worldX + radius);
+            bounds.maxY = dmMath::Max(bounds.maxY, bone->worldY + radius);
+        }
+        return true;
+    }
+
+    void GetSkinningConstants(const spSkeleton* skeleton, dmVMath::Vector4* bone_transforms, dmVMath::Vector4* slot_colors)
+    {
+        uint32_t vector_count = GetBoneTransformVectorCount((uint32_t)skeleton->bonesCount + 1);
+        float* out = (float*)bone_transforms;
+        out[0] = 1.0f; out[1] = 0.0f; out[2] = 0.0f;
+        out[3] = 0.0f; out[4] = 1.0f; out[5] = 0.0f;
+        out += 6;
+        for (int i = 0; i < skeleton->bonesCount; ++i, out += 6)
+        {
+            const spBone* bone = skeleton->bones[i];
+            out[0] = bone->a; out[1] = bone->b; out[2] = bone->worldX;
+            out[3] = bone->c; out[4] = bone->d; out[5] = bone->worldY;
+        }
+        // The padding of the last vector, if the bone count is odd
+        for (float* end = (float*)(bone_transforms + vector_count); out < end; ++out)
+        {
+            *out = 0.0f;
+        }
+
+        const spColor& skeleton_color = skeleton->color;
+        slot_colors[0] = dmVMath::Vector4(1.0f);
+        for (int i = 0; i < skeleton->slotsCount; ++i)
+        {
+            const spColor& color = skeleton->slots[i]->color;
+            slot_colors[i + 1] = dmVMath::Vector4(skeleton_color.r * color.r, skeleton_color.g * color.g, skeleton_color.b * color.b, skeleton_color.a * color.a);
+        }
+    }
+}
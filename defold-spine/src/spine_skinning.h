@@ -0,0 +1,77 @@
+#ifndef DM_SPINE_SKINNING_H
+#define DM_SPINE_SKINNING_H
+
+#include <stdint.h>
+#include <dmsdk/dlib/array.h>
+#include <dmsdk/dlib/hashtable.h>
+#include <dmsdk/dlib/vmath.h>
+#include <dmsdk/graphics/graphics.h>
+
+#include <common/vertices.h>
+
+struct spSkeleton;
+
+namespace dmSpine
+{
+    struct SpineSceneResource;
+
+    // Must match the array sizes in spine_skinned.vp.
+    // Index 0 of both arrays is reserved for the identity transform and a white color (used by the CPU fallback).
+    // The constants must fit the 128 vertex uniform vectors that GLES2 and WebGL 1 guarantee: 4 for the
+    // world_view_proj matrix, 78 for the packed bone transforms and 40 for the slot colors
+    static const uint32_t SKINNING_MAX_BONES = 52;
+    static const uint32_t SKINNING_MAX_SLOTS = 40;
+    static const uint32_t SKINNING_MAX_INFLUENCES = 4;
+    static const uint32_t SKINNING_MAX_VERTICES = 65536;
+
+    // The vertices of all region and mesh attachments of all skins in a spine scene, in bone local space.
+    // Uploaded once, and shared by all model instances of the scene that use GPU skinning
+    struct SpineSkinnedGeometry
+    {
+        dmGraphics::HVertexBuffer   m_VertexBuffer;
+        dmHashTable64<uint32_t>     m_AttachmentToVertexStart;  // Keyed on the slot index and the attachment
+        dmArray<float>              m_BoneRadius;               // Max distance from each bone to the vertices that use it
+        uint32_t                    m_VertexCount;
+        uint8_t                     m_Supported : 1;            // Set if the skeleton fits in the shader constants
+    };
+
+    // The 2x3 bone transforms are packed without padding, so two bones use three vectors
+    static inline uint32_t GetBoneTransformVectorCount(uint32_t bone_count)
+    {
+        return (bone_count * 6 + 3) / 4;
+    }
+
+    // Creates the geometry on first use. Returns 0 if the skeleton has too many bones or slots, or uses dark colors.
+    // Must be called from the main thread
+    SpineSkinnedGeometry* AcquireSkinnedGeometry(SpineSceneResource* scene, dmGraphics::HContext graphics_context);
+
+    // Deletes the geometry, e.g. when the skeleton data is reloaded
+    void ResetSkinnedGeometry(SpineSceneResource* scene);
+
+    // A range of indices drawn with the same vertex buffer and blend mode
+    struct SpineSkinnedDrawDesc
+    {
+        uint32_t m_IndexStart;
+        uint32_t m_IndexCount;
+        uint32_t m_BlendMode;   // spBlendMode, if the slot blend modes are used
+        uint32_t m_Dynamic;     // Set if the indices refer to the CPU transformed vertices
+    };
+
+    // Appends the indices of the visible attachments, in draw order. Attachments that are deformed, use sequences
+    // or aren't part of the geometry are transformed on the CPU instead, and appended to the dynamic vertices.
+    // The dynamic indices wrap around like those of GenerateIndexedVertexData().
+    // Returns false if the skeleton uses clipping, which needs the CPU path for all attachments. Nothing is added in that case
+    bool GenerateSkinnedIndices(const SpineSkinnedGeometry* geometry, const spSkeleton* skeleton, bool use_slot_blend_modes,
+                                dmArray<uint16_t>& index_buffer, dmArray<SpineSkinnedVertex>& dynamic_vertex_buffer,
+                                dmArray<float>& scratch, dmArray<SpineSkinnedDrawDesc>& draw_descs);
+
+    // Conservative bounds, from the bone positions and the extent of their attachments.
+    // Returns false if a slot has deformed vertices, which aren't accounted for
+    bool GetSkinnedBounds(const SpineSkinnedGeometry* geometry, const spSkeleton* skeleton, SpineModelBounds& bounds);
+
+    // Writes the two rows of the 2D transform of each bone as six consecutive floats, and one color per slot, each after the reserved entry.
+    // The arrays must fit GetBoneTransformVectorCount(bonesCount + 1) and slotsCount + 1 values
+    void GetSkinningConstants(const spSkeleton* skeleton, dmVMath::Vector4* bone_transforms, dmVMath::Vector4* slot_colors);
+}
+
+#endif // DM_SPINE_SKINNING_H
@@ -0,0 +1,17 @@
+#!/usr/bin/env bash
+
+# Compares the scalar and the SIMD vertex transform on the sample rigs,
+# the generic and the fast path for the region attachments,
+# and counts the allocations made while switching animations (should be 0).
+# Run from the project folder (containing the game.project), after building the project with bob
+# (the atlases are read from the build folder), and with the plugin built for the host platform.
+#   ./utils/benchmark_vertices.sh [iterations]
+
+set -e
+
+ITERATIONS=${1:-100}
+BUILD_DIR=./build/default
+
+for RIG in spineboy owl squirrel; do
+    ./utils/test_plugin.sh ./assets/${RIG}/${RIG}.spinejson ${BUILD_DIR}/assets/${RIG}/${RIG}.a.texturesetc --benchmark ${ITERATIONS}
+done
@@ -1,9 +1,31 @@
 #!/usr/bin/env bash
 
+# Runs the plugin on a rig:
+#   ./utils/test_plugin.sh <.spinejson|.spineskel> <.texturesetc> [--benchmark [iterations] | --check-segments]
+# Without arguments, runs the checks on the sample rigs. Run from the project folder (containing the game.project),
+# after building the project with bob (the atlases are read from the build folder)
+
 set -e
 
 CLASS=com.dynamo.bob.pipeline.Spine
 JAR=./defold-spine/plugins/share/pluginSpineExt.jar
 BOB=${DYNAMO_HOME}/share/java/bob.jar
+BUILD_DIR=./build/default
+
+function run_plugin() {
+    java -cp $JAR:$BOB:./defold-spine/plugins/lib/x86_64-osx $CLASS $*
+}
+
+if [ $# -gt 0 ]; then
+    run_plugin $*
+    exit 0
+fi
+
+# Skeletons with more than 65536 vertices are split in segments
+for RIG in spineboy owl squirrel; do
+    run_plugin ./assets/${RIG}/${RIG}.spinejson ${BUILD_DIR}/assets/${RIG}/${RIG}.a.texturesetc --check-segments
+done
 
-java -cp $JAR:$BOB:./defold-spine/plugins/lib/x86_64-osx $CLASS $*
+# The binary skeleton format
+run_plugin ./assets/squirrel/squirrel.spineskel ${BUILD_DIR}/assets/squirrel/squirrel.a.texturesetc
+run_plugin ./assets/squirrel/squirrel.spineskel ${BUILD_DIR}/assets/squirrel/squirrel.a.texturesetc --check-segments